@@ -1,24 +1,47 @@
 #version 410
 
+#ifdef ALPHA_MASK
+#include "common/alpha_mask.glsl"
+#endif
+#include "common/lighting.glsl"
+#ifdef CLUSTERED_LIGHTING
+#include "common/clustered_lighting.glsl"
+#endif
+#ifdef SHADOWS
+#include "common/shadows.glsl"
+#endif
+
 uniform sampler2D U_SAMPLER_0;
 uniform vec3 U_LIGHT_DIR_0;
 
 in vec3 V_NORMAL_0;
 in vec2 V_TEX_COORD_0;
+#ifdef ALPHA_MASK
+flat in float V_MATERIAL_0;
+#endif
+#if defined(CLUSTERED_LIGHTING) || defined(SHADOWS)
+in vec3 V_VIEW_POSITION;
+#endif
 
 out vec4 _FragColor;
 
 void main()
 {
 	vec3 normal = normalize(V_NORMAL_0);
-	vec2 pos = (V_TEX_COORD_0.xy - vec2(0.5)) * 2.0;
-	float len = length(pos);
-	float mask = step(1.0, len);
-	
 	vec4 albedo = texture(U_SAMPLER_0, V_TEX_COORD_0);
-	albedo.a *= mask;
 
-	_FragColor
-		= vec4(max(0.2, abs(dot(normal, U_LIGHT_DIR_0)))
-		* albedo.rgb, albedo.a);
+#ifdef ALPHA_MASK
+	albedo.a = alphaMask(V_TEX_COORD_0, albedo.a, V_MATERIAL_0);
+#endif
+
+#ifdef SHADOWS
+	vec3 color = twoSidedDiffuse(normal, U_LIGHT_DIR_0, 0.2, directionalShadow(V_VIEW_POSITION)) * albedo.rgb;
+#else
+	vec3 color = twoSidedDiffuse(normal, U_LIGHT_DIR_0, 0.2) * albedo.rgb;
+#endif
+#ifdef CLUSTERED_LIGHTING
+	color += clusteredPointLights(V_VIEW_POSITION, normal) * albedo.rgb;
+#endif
+
+	_FragColor = vec4(color, albedo.a);
 }
@@ -1,18 +1,34 @@
 #version 410
 
-uniform mat4 U_PROJECTION_TRANSFORM;
-uniform mat4 U_VIEW_TRANSFORM;
+#include "common/instancing.glsl"
 
-in vec3 A_POSITION_0;
 in vec3 A_NORMAL_0;
 in vec2 A_TEX_COORD_0;
 
 out vec3 V_NORMAL_0;
 out vec2 V_TEX_COORD_0;
+#ifdef ALPHA_MASK
+flat out float V_MATERIAL_0;
+#endif
+#if defined(CLUSTERED_LIGHTING) || defined(SHADOWS)
+out vec3 V_VIEW_POSITION;
+#endif
+
+// invariant, so the GL_EQUAL depth test matches the positions written by depth_prepass.vs
+out gl_PerVertex
+{
+	invariant vec4 gl_Position;
+};
 
 void main()
 {
 	V_NORMAL_0 = (U_VIEW_TRANSFORM * vec4(A_NORMAL_0, 0.0)).xyz;
 	V_TEX_COORD_0 = A_TEX_COORD_0;
-	gl_Position = U_PROJECTION_TRANSFORM * U_VIEW_TRANSFORM * vec4(A_POSITION_0, 1.0);
+#ifdef ALPHA_MASK
+	V_MATERIAL_0 = A_MATERIAL_0;
+#endif
+#if defined(CLUSTERED_LIGHTING) || defined(SHADOWS)
+	V_VIEW_POSITION = (U_VIEW_TRANSFORM * vec4(instanceWorldPosition(), 1.0)).xyz;
+#endif
+	gl_Position = instanceClipPosition();
 }
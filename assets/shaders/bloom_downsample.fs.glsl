@@ -0,0 +1,63 @@
+#version 410
+
+// one level of the bloom pyramid from the twice larger one with 13 bilinear taps
+// (Jimenez, "Next Generation Post Processing in Call of Duty: Advanced Warfare"),
+// PREFILTER keeps only the bright part of the scene while building the first level
+
+uniform sampler2D U_SOURCE;
+uniform vec2 U_SOURCE_TEXEL;
+
+#ifdef PREFILTER
+uniform float U_THRESHOLD;
+uniform float U_KNEE;
+#endif
+
+in vec2 V_TEX_COORD_0;
+
+out vec4 _FragColor;
+
+vec3 tap(float x, float y)
+{
+	return texture(U_SOURCE, V_TEX_COORD_0 + vec2(x, y) * U_SOURCE_TEXEL).rgb;
+}
+
+#ifdef PREFILTER
+// quadratic soft knee below the threshold
+vec3 prefilter(vec3 color)
+{
+	float brightness = max(color.r, max(color.g, color.b));
+	float soft = clamp(brightness - U_THRESHOLD + U_KNEE, 0.0, 2.0 * U_KNEE);
+	soft = soft * soft / (4.0 * U_KNEE + 1e-4);
+	return color * max(soft, brightness - U_THRESHOLD) / max(brightness, 1e-4);
+}
+#endif
+
+void main()
+{
+	vec3 a = tap(-2.0, -2.0);
+	vec3 b = tap(0.0, -2.0);
+	vec3 c = tap(2.0, -2.0);
+	vec3 d = tap(-1.0, -1.0);
+	vec3 e = tap(1.0, -1.0);
+	vec3 f = tap(-2.0, 0.0);
+	vec3 g = tap(0.0, 0.0);
+	vec3 h = tap(2.0, 0.0);
+	vec3 i = tap(-1.0, 1.0);
+	vec3 j = tap(1.0, 1.0);
+	vec3 k = tap(-2.0, 2.0);
+	vec3 l = tap(0.0, 2.0);
+	vec3 m = tap(2.0, 2.0);
+
+	// the inner box weighs 0.5, the four overlapping outer boxes 0.125 each
+	vec3 color = (d + e + i + j) * 0.125;
+	color += (a + b + f + g) * 0.03125;
+	color += (b + c + g + h) * 0.03125;
+	color += (f + g + k + l) * 0.03125;
+	color += (g + h + l + m) * 0.03125;
+
+#ifdef PREFILTER
+	color = prefilter(color);
+#endif
+
+	_FragColor = vec4(color, 1.0);
+}
@@ -0,0 +1,25 @@
+#version 410
+
+// 3x3 tent filter of the smaller pyramid level, blended additively into the larger one
+
+uniform sampler2D U_SOURCE;
+uniform vec2 U_SOURCE_TEXEL;
+uniform float U_RADIUS;
+
+in vec2 V_TEX_COORD_0;
+
+out vec4 _FragColor;
+
+vec3 tap(float x, float y)
+{
+	return texture(U_SOURCE, V_TEX_COORD_0 + vec2(x, y) * U_SOURCE_TEXEL * U_RADIUS).rgb;
+}
+
+void main()
+{
+	vec3 color = tap(0.0, 0.0) * 4.0;
+	color += (tap(0.0, -1.0) + tap(-1.0, 0.0) + tap(1.0, 0.0) + tap(0.0, 1.0)) * 2.0;
+	color += tap(-1.0, -1.0) + tap(1.0, -1.0) + tap(-1.0, 1.0) + tap(1.0, 1.0);
+
+	_FragColor = vec4(color / 16.0, 1.0);
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+// hole patterns of every material packed into one array, shared by the shading and the depth prepass programs
+uniform sampler2DArray U_MASKS;
+
+float alphaMask(vec2 texCoord, float alpha, float material)
+{
+	return alpha * texture(U_MASKS, vec3(texCoord, material)).r;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+// Point lights binned by ClusteredLighting, everything in view space.
+
+uniform samplerBuffer U_LIGHTS;
+uniform usamplerBuffer U_CLUSTERS;
+uniform usamplerBuffer U_LIGHT_INDICES;
+
+uniform ivec3 U_CLUSTER_GRID;
+uniform vec2 U_CLUSTER_VIEWPORT;
+// the depth slice is log(distance) * x + y
+uniform vec2 U_CLUSTER_DEPTH;
+
+// reaches zero at the radius, so a light never shows outside the clusters it was binned into
+float pointLightFalloff(float distance, float radius)
+{
+	float ratio = distance / radius;
+	float window = clamp(1.0 - ratio * ratio * ratio * ratio, 0.0, 1.0);
+	return window * window / (distance * distance + 1.0);
+}
+
+// two-sided diffuse of the lights in the cluster of the current fragment
+vec3 clusteredPointLights(vec3 viewPosition, vec3 normal)
+{
+	ivec3 cluster;
+	cluster.xy = ivec2(gl_FragCoord.xy / U_CLUSTER_VIEWPORT * vec2(U_CLUSTER_GRID.xy));
+	cluster.z = int(floor(log(-viewPosition.z) * U_CLUSTER_DEPTH.x + U_CLUSTER_DEPTH.y));
+	cluster = clamp(cluster, ivec3(0), U_CLUSTER_GRID - 1);
+
+	uvec2 list = texelFetch(U_CLUSTERS, (cluster.z * U_CLUSTER_GRID.y + cluster.y) * U_CLUSTER_GRID.x + cluster.x).xy;
+
+	vec3 result = vec3(0.0);
+	for (uint i = 0u; i < list.y; ++i)
+	{
+		int light = int(texelFetch(U_LIGHT_INDICES, int(list.x + i)).r);
+		vec4 positionRadius = texelFetch(U_LIGHTS, light * 2);
+		vec3 color = texelFetch(U_LIGHTS, light * 2 + 1).rgb;
+
+		vec3 toLight = positionRadius.xyz - viewPosition;
+		float distance = max(length(toLight), 1e-4);
+		result += color * abs(dot(normal, toLight / distance)) * pointLightFalloff(distance, positionRadius.w);
+	}
+	return result;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+// std430 layouts shared by the culling passes, CullObject matches libgl::CullObject
+
+struct CullObject
+{
+	vec4 boundingSphere;
+	uint indexCount;
+	uint firstIndex;
+	int baseVertex;
+	uint baseInstance;
+};
+
+struct DrawCommand
+{
+	uint count;
+	uint instanceCount;
+	uint firstIndex;
+	int baseVertex;
+	uint baseInstance;
+};
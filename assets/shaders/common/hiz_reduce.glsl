@@ -0,0 +1,21 @@
+#pragma once
+
+// Farthest depth of every source texel overlapping the destination texel in UV space.
+// Odd sizes make a destination texel straddle up to three source texels per axis, all of them count,
+// so a texel of any level never reports a depth nearer than what it covers.
+// The includer defines float loadSource(ivec2 coord) first.
+float farthestDepth(ivec2 destination, ivec2 destinationSize, ivec2 sourceSize)
+{
+	ivec2 first = (destination * sourceSize) / destinationSize;
+	ivec2 last = ((destination + 1) * sourceSize + destinationSize - 1) / destinationSize - 1;
+
+	float result = 0.0;
+	for (int y = first.y; y <= last.y; ++y)
+	{
+		for (int x = first.x; x <= last.x; ++x)
+		{
+			result = max(result, loadSource(ivec2(x, y)));
+		}
+	}
+	return result;
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+uniform mat4 U_PROJECTION_TRANSFORM;
+uniform mat4 U_VIEW_TRANSFORM;
+
+in vec3 A_POSITION_0;
+// xyz offset and w scale of an instance, (0, 0, 0, 1) is the default value when no stream is bound
+in vec4 A_INSTANCE_0;
+// layer of the material in the mask array, 0 when no stream is bound
+in float A_MATERIAL_0;
+
+vec3 instanceWorldPosition()
+{
+	return A_POSITION_0 * A_INSTANCE_0.w + A_INSTANCE_0.xyz;
+}
+
+// the depth prepass and the shading pass must agree on depth bit for bit:
+// both call this with gl_Position declared invariant
+vec4 instanceClipPosition()
+{
+	return U_PROJECTION_TRANSFORM * U_VIEW_TRANSFORM * vec4(instanceWorldPosition(), 1.0);
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+// lambert term for surfaces lit from both sides, never darker than the ambient term
+float twoSidedDiffuse(vec3 normal, vec3 lightDir, float ambient)
+{
+	return max(ambient, abs(dot(normal, lightDir)));
+}
+
+// the same with the direct term attenuated by a shadow factor in [0, 1]
+float twoSidedDiffuse(vec3 normal, vec3 lightDir, float ambient, float shadow)
+{
+	return max(ambient, abs(dot(normal, lightDir)) * shadow);
+}
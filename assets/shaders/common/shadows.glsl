@@ -0,0 +1,36 @@
+#pragma once
+
+// Cascaded shadow maps of CascadedShadowMaps, positions in view space.
+
+uniform sampler2DArrayShadow U_SHADOW_MAP;
+uniform mat4 U_SHADOW_MATRICES[4];
+// view distance where each cascade ends
+uniform vec4 U_SHADOW_SPLITS;
+uniform int U_SHADOW_CASCADES;
+
+// 1 where the light arrives, 0 in shadow; everything past the last cascade is lit
+float directionalShadow(vec3 viewPosition)
+{
+	float distance = -viewPosition.z;
+	int cascade = 0;
+	while (cascade < U_SHADOW_CASCADES && distance > U_SHADOW_SPLITS[cascade])
+	{
+		++cascade;
+	}
+	if (cascade == U_SHADOW_CASCADES)
+	{
+		return 1.0;
+	}
+
+	vec3 coord = (U_SHADOW_MATRICES[cascade] * vec4(viewPosition, 1.0)).xyz;
+
+	// four bilinear comparisons half a texel apart cover a 3x3 texel footprint
+	vec2 texel = 1.0 / vec2(textureSize(U_SHADOW_MAP, 0).xy);
+	float lit = 0.0;
+	for (int i = 0; i < 4; ++i)
+	{
+		vec2 offset = (vec2(i & 1, i >> 1) - 0.5) * texel;
+		lit += texture(U_SHADOW_MAP, vec4(coord.xy + offset, float(cascade), coord.z));
+	}
+	return lit * 0.25;
+}
@@ -0,0 +1,99 @@
+#version 430
+
+// Frustum and Hi-Z occlusion test of bounding spheres, one visibility flag per object.
+// The flags stay in object order, cull_compact.cs packs the survivors into the indirect draw buffer.
+
+layout(local_size_x = 64) in;
+
+#include "common/cull_objects.glsl"
+
+layout(std430, binding = 0) readonly buffer Objects
+{
+	CullObject objects[];
+};
+
+layout(std430, binding = 1) writeonly buffer Visible
+{
+	uint visible[];
+};
+
+uniform int U_OBJECTS_COUNT;
+uniform vec4 U_FRUSTUM_PLANES[6];
+
+uniform bool U_OCCLUSION;
+uniform mat4 U_HIZ_VIEW_PROJECTION;
+uniform sampler2D U_HIZ;
+
+bool insideFrustum(vec4 sphere)
+{
+	for (int i = 0; i < 6; ++i)
+	{
+		if (dot(U_FRUSTUM_PLANES[i].xyz, sphere.xyz) + U_FRUSTUM_PLANES[i].w < -sphere.w)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+float farthestInRect(ivec2 texelMin, ivec2 texelMax, int level)
+{
+	return max(
+		max(texelFetch(U_HIZ, texelMin, level).r, texelFetch(U_HIZ, ivec2(texelMax.x, texelMin.y), level).r),
+		max(texelFetch(U_HIZ, ivec2(texelMin.x, texelMax.y), level).r, texelFetch(U_HIZ, texelMax, level).r));
+}
+
+bool occluded(vec4 sphere)
+{
+	// screen rectangle and nearest depth of the box around the sphere
+	vec3 ndcMin = vec3(1e30);
+	vec3 ndcMax = vec3(-1e30);
+	for (int i = 0; i < 8; ++i)
+	{
+		vec3 corner = vec3((i & 1) != 0 ? 1.0 : -1.0, (i & 2) != 0 ? 1.0 : -1.0, (i & 4) != 0 ? 1.0 : -1.0);
+		vec4 clip = U_HIZ_VIEW_PROJECTION * vec4(sphere.xyz + corner * sphere.w, 1.0);
+		if (clip.w <= 0.0)
+		{
+			// crosses the camera plane of the frame the pyramid was built from
+			return false;
+		}
+
+		vec3 ndc = clip.xyz / clip.w;
+		ndcMin = min(ndcMin, ndc);
+		ndcMax = max(ndcMax, ndc);
+	}
+
+	vec2 uvMin = clamp(ndcMin.xy * 0.5 + 0.5, 0.0, 1.0);
+	vec2 uvMax = clamp(ndcMax.xy * 0.5 + 0.5, 0.0, 1.0);
+	float nearestDepth = ndcMin.z * 0.5 + 0.5;
+
+	// the coarsest level where the rectangle still touches at most 2x2 texels
+	vec2 extent = (uvMax - uvMin) * vec2(textureSize(U_HIZ, 0));
+	int lastLevel = textureQueryLevels(U_HIZ) - 1;
+	int level = clamp(int(ceil(log2(max(max(extent.x, extent.y), 1.0)))), 0, lastLevel);
+
+	ivec2 size = textureSize(U_HIZ, level);
+	ivec2 texelMin = clamp(ivec2(uvMin * vec2(size)), ivec2(0), size - 1);
+	ivec2 texelMax = clamp(ivec2(uvMax * vec2(size)), ivec2(0), size - 1);
+	while (any(greaterThan(texelMax - texelMin, ivec2(1))) && level < lastLevel)
+	{
+		++level;
+		size = textureSize(U_HIZ, level);
+		texelMin = clamp(ivec2(uvMin * vec2(size)), ivec2(0), size - 1);
+		texelMax = clamp(ivec2(uvMax * vec2(size)), ivec2(0), size - 1);
+	}
+
+	return nearestDepth > farthestInRect(texelMin, texelMax, level);
+}
+
+void main()
+{
+	uint index = gl_GlobalInvocationID.x;
+	if (index >= uint(U_OBJECTS_COUNT))
+	{
+		return;
+	}
+
+	vec4 sphere = objects[index].boundingSphere;
+	visible[index] = insideFrustum(sphere) && !(U_OCCLUSION && occluded(sphere)) ? 1u : 0u;
+}
@@ -0,0 +1,72 @@
+#version 430
+
+// Packs the objects that passed cull.cs into the indirect draw buffer in object order,
+// so an object list sorted front to back is also drawn front to back.
+// A single workgroup walks the objects in chunks and carries the survivors count from one chunk to the next.
+
+layout(local_size_x = 1024) in;
+
+#include "common/cull_objects.glsl"
+
+layout(std430, binding = 0) readonly buffer Objects
+{
+	CullObject objects[];
+};
+
+layout(std430, binding = 1) readonly buffer Visible
+{
+	uint visible[];
+};
+
+layout(std430, binding = 2) writeonly buffer Commands
+{
+	DrawCommand commands[];
+};
+
+layout(std430, binding = 3) writeonly buffer DrawCount
+{
+	uint drawCount;
+};
+
+uniform int U_OBJECTS_COUNT;
+
+shared uint s_survivors[gl_WorkGroupSize.x];
+
+void main()
+{
+	uint local = gl_LocalInvocationID.x;
+	uint objectsCount = uint(U_OBJECTS_COUNT);
+
+	uint base = 0u;
+	for (uint first = 0u; first < objectsCount; first += gl_WorkGroupSize.x)
+	{
+		uint index = first + local;
+		uint survived = index < objectsCount ? visible[index] : 0u;
+
+		// inclusive scan, s_survivors[i] counts the survivors among the first i + 1 objects of the chunk
+		s_survivors[local] = survived;
+		barrier();
+		for (uint stride = 1u; stride < gl_WorkGroupSize.x; stride *= 2u)
+		{
+			uint previous = local >= stride ? s_survivors[local - stride] : 0u;
+			barrier();
+			s_survivors[local] += previous;
+			barrier();
+		}
+
+		if (survived != 0u)
+		{
+			CullObject object = objects[index];
+			commands[base + s_survivors[local] - 1u] = DrawCommand(object.indexCount, 1u, object.firstIndex, object.baseVertex, object.baseInstance);
+		}
+
+		base += s_survivors[gl_WorkGroupSize.x - 1u];
+		// the chunk total is read before the next chunk overwrites it
+		barrier();
+	}
+
+	if (local == 0u)
+	{
+		drawCount = base;
+	}
+}
@@ -0,0 +1,23 @@
+#version 410
+
+// Writes depth only. Masked materials are alpha tested here, the shading pass
+// then runs with GL_EQUAL and shades exactly the samples that survived.
+
+#ifdef ALPHA_MASK
+#include "common/alpha_mask.glsl"
+
+uniform sampler2D U_SAMPLER_0;
+
+in vec2 V_TEX_COORD_0;
+flat in float V_MATERIAL_0;
+#endif
+
+void main()
+{
+#ifdef ALPHA_MASK
+	if (alphaMask(V_TEX_COORD_0, texture(U_SAMPLER_0, V_TEX_COORD_0).a, V_MATERIAL_0) < 0.5)
+	{
+		discard;
+	}
+#endif
+}
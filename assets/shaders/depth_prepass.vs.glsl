@@ -0,0 +1,25 @@
+#version 410
+
+// Positions only, plus texture coordinates when the material is alpha tested.
+
+#include "common/instancing.glsl"
+
+#ifdef ALPHA_MASK
+in vec2 A_TEX_COORD_0;
+out vec2 V_TEX_COORD_0;
+flat out float V_MATERIAL_0;
+#endif
+
+out gl_PerVertex
+{
+	invariant vec4 gl_Position;
+};
+
+void main()
+{
+#ifdef ALPHA_MASK
+	V_TEX_COORD_0 = A_TEX_COORD_0;
+	V_MATERIAL_0 = A_MATERIAL_0;
+#endif
+	gl_Position = instanceClipPosition();
+}
@@ -0,0 +1,18 @@
+#version 410
+
+// a single triangle covering the viewport, drawn with glDrawArrays(GL_TRIANGLES, 0, 3) and no vertex streams;
+// unlike a quad it has no diagonal seam where both halves shade the same 2x2 pixel quads
+
+out vec2 V_TEX_COORD_0;
+
+out gl_PerVertex
+{
+	vec4 gl_Position;
+};
+
+void main()
+{
+	vec2 position = vec2(gl_VertexID & 1, gl_VertexID >> 1) * 4.0 - 1.0;
+	V_TEX_COORD_0 = position * 0.5 + 0.5;
+	gl_Position = vec4(position, 0.0, 1.0);
+}
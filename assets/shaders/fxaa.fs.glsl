@@ -0,0 +1,47 @@
+#version 410
+
+// FXAA 3.11 console variant (Lottes), luma comes in alpha from post_composite.fs.glsl
+
+uniform sampler2D U_SOURCE;
+uniform vec2 U_SOURCE_TEXEL;
+
+in vec2 V_TEX_COORD_0;
+
+out vec4 _FragColor;
+
+const float kEdgeSharpness = 8.0;
+const float kEdgeThreshold = 0.125;
+const float kEdgeThresholdMin = 0.05;
+
+void main()
+{
+	vec2 position = V_TEX_COORD_0;
+	vec4 center = texture(U_SOURCE, position);
+
+	// bilinear taps between texels average 2x2 neighbourhoods
+	float lumaNw = texture(U_SOURCE, position + vec2(-0.5, -0.5) * U_SOURCE_TEXEL).a;
+	float lumaSw = texture(U_SOURCE, position + vec2(-0.5, 0.5) * U_SOURCE_TEXEL).a;
+	float lumaNe = texture(U_SOURCE, position + vec2(0.5, -0.5) * U_SOURCE_TEXEL).a + 1.0 / 384.0;
+	float lumaSe = texture(U_SOURCE, position + vec2(0.5, 0.5) * U_SOURCE_TEXEL).a;
+
+	float lumaMax = max(max(lumaNw, lumaSw), max(lumaNe, lumaSe));
+	float lumaMin = min(min(lumaNw, lumaSw), min(lumaNe, lumaSe));
+	float lumaRange = max(lumaMax, center.a) - min(lumaMin, center.a);
+	if (lumaRange < max(kEdgeThresholdMin, lumaMax * kEdgeThreshold))
+	{
+		_FragColor = center;
+		return;
+	}
+
+	float southWestMinusNorthEast = lumaSw - lumaNe;
+	float southEastMinusNorthWest = lumaSe - lumaNw;
+	vec2 direction1 = normalize(vec2(southWestMinusNorthEast + southEastMinusNorthWest, southWestMinusNorthEast - southEastMinusNorthWest));
+	vec2 direction2 = clamp(direction1 / (min(abs(direction1.x), abs(direction1.y)) * kEdgeSharpness), -2.0, 2.0);
+
+	vec4 near = texture(U_SOURCE, position - direction1 * U_SOURCE_TEXEL * 0.5) + texture(U_SOURCE, position + direction1 * U_SOURCE_TEXEL * 0.5);
+	vec4 far = texture(U_SOURCE, position - direction2 * U_SOURCE_TEXEL * 2.0) + texture(U_SOURCE, position + direction2 * U_SOURCE_TEXEL * 2.0);
+	vec4 wide = far * 0.25 + near * 0.25;
+
+	// the wide filter crossed another edge, fall back to the two near taps
+	_FragColor = (wide.a < lumaMin || wide.a > lumaMax) ? vec4(near.rgb * 0.5, center.a) : wide;
+}
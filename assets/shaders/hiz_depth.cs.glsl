@@ -0,0 +1,55 @@
+#version 430
+
+// first level of the depth pyramid, half the resolution of the scene depth;
+// MULTISAMPLE reads a multisampled depth and keeps the farthest sample of every pixel
+
+layout(local_size_x = 8, local_size_y = 8) in;
+
+layout(r32f, binding = 0) writeonly uniform image2D U_DESTINATION;
+
+#ifdef MULTISAMPLE
+uniform sampler2DMS U_SOURCE;
+uniform int U_SAMPLES;
+
+ivec2 sourceSize()
+{
+	return textureSize(U_SOURCE);
+}
+
+float loadSource(ivec2 coord)
+{
+	float result = 0.0;
+	for (int i = 0; i < U_SAMPLES; ++i)
+	{
+		result = max(result, texelFetch(U_SOURCE, coord, i).r);
+	}
+	return result;
+}
+#else
+uniform sampler2D U_SOURCE;
+
+ivec2 sourceSize()
+{
+	return textureSize(U_SOURCE, 0);
+}
+
+float loadSource(ivec2 coord)
+{
+	return texelFetch(U_SOURCE, coord, 0).r;
+}
+#endif
+
+#include "common/hiz_reduce.glsl"
+
+void main()
+{
+	ivec2 destination = ivec2(gl_GlobalInvocationID.xy);
+	ivec2 destinationSize = imageSize(U_DESTINATION);
+	if (any(greaterThanEqual(destination, destinationSize)))
+	{
+		return;
+	}
+
+	float depth = farthestDepth(destination, destinationSize, sourceSize());
+	imageStore(U_DESTINATION, destination, vec4(depth));
+}
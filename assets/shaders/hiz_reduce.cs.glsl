@@ -0,0 +1,28 @@
+#version 430
+
+// one more level of the depth pyramid from the previous one
+
+layout(local_size_x = 8, local_size_y = 8) in;
+
+layout(r32f, binding = 0) writeonly uniform image2D U_DESTINATION;
+layout(r32f, binding = 1) readonly uniform image2D U_SOURCE;
+
+float loadSource(ivec2 coord)
+{
+	return imageLoad(U_SOURCE, coord).r;
+}
+
+#include "common/hiz_reduce.glsl"
+
+void main()
+{
+	ivec2 destination = ivec2(gl_GlobalInvocationID.xy);
+	ivec2 destinationSize = imageSize(U_DESTINATION);
+	if (any(greaterThanEqual(destination, destinationSize)))
+	{
+		return;
+	}
+
+	float depth = farthestDepth(destination, destinationSize, imageSize(U_SOURCE));
+	imageStore(U_DESTINATION, destination, vec4(depth));
+}
@@ -0,0 +1,41 @@
+#version 410
+
+// every per-pixel post effect in one pass: bloom composite, exposure and tone mapping,
+// FXAA_LUMA stores the luma FXAA detects edges on, so FXAA doesn't compute it for each of its taps
+
+uniform sampler2D U_SOURCE;
+uniform float U_EXPOSURE;
+
+#ifdef BLOOM
+uniform sampler2D U_BLOOM;
+uniform float U_BLOOM_INTENSITY;
+#endif
+
+in vec2 V_TEX_COORD_0;
+
+out vec4 _FragColor;
+
+// Narkowicz, "ACES Filmic Tone Mapping Curve"
+vec3 tonemapAces(vec3 color)
+{
+	return clamp((color * (2.51 * color + 0.03)) / (color * (2.43 * color + 0.59) + 0.14), 0.0, 1.0);
+}
+
+void main()
+{
+	vec3 color = texture(U_SOURCE, V_TEX_COORD_0).rgb;
+
+#ifdef BLOOM
+	color += texture(U_BLOOM, V_TEX_COORD_0).rgb * U_BLOOM_INTENSITY;
+#endif
+
+	color = tonemapAces(color * U_EXPOSURE);
+
+	float alpha = 1.0;
+#ifdef FXAA_LUMA
+	// alpha isn't sRGB encoded, the square root brings the luma close to perceptual
+	alpha = sqrt(dot(color, vec3(0.299, 0.587, 0.114)));
+#endif
+
+	_FragColor = vec4(color, alpha);
+}
@@ -0,0 +1,36 @@
+#version 410
+
+// bilinear upscaling of the tone mapped image to the back buffer, SHARPEN restores some of the lost detail
+// with a negative lobe that fades out where local contrast is already high (after AMD FidelityFX CAS)
+
+uniform sampler2D U_SOURCE;
+
+#ifdef SHARPEN
+uniform vec2 U_SOURCE_TEXEL;
+uniform float U_SHARPNESS;
+#endif
+
+in vec2 V_TEX_COORD_0;
+
+out vec4 _FragColor;
+
+void main()
+{
+	vec3 color = texture(U_SOURCE, V_TEX_COORD_0).rgb;
+
+#ifdef SHARPEN
+	vec3 north = texture(U_SOURCE, V_TEX_COORD_0 + vec2(0.0, -1.0) * U_SOURCE_TEXEL).rgb;
+	vec3 south = texture(U_SOURCE, V_TEX_COORD_0 + vec2(0.0, 1.0) * U_SOURCE_TEXEL).rgb;
+	vec3 west = texture(U_SOURCE, V_TEX_COORD_0 + vec2(-1.0, 0.0) * U_SOURCE_TEXEL).rgb;
+	vec3 east = texture(U_SOURCE, V_TEX_COORD_0 + vec2(1.0, 0.0) * U_SOURCE_TEXEL).rgb;
+
+	vec3 minColor = min(color, min(min(north, south), min(west, east)));
+	vec3 maxColor = max(color, max(max(north, south), max(west, east)));
+
+	vec3 amount = sqrt(clamp(min(minColor, 1.0 - maxColor) / max(maxColor, vec3(1e-4)), 0.0, 1.0));
+	vec3 lobe = amount * (-1.0 / mix(8.0, 5.0, U_SHARPNESS));
+	color = clamp((color + (north + south + west + east) * lobe) / (1.0 + 4.0 * lobe), 0.0, 1.0);
+#endif
+
+	_FragColor = vec4(color, 1.0);
+}
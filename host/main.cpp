@@ -1,6 +1,7 @@
 #include <Application.hpp>
 
 #include <iostream>
+#include <string_view>
 
 static std::filesystem::path projectDir()
 {
@@ -16,12 +17,50 @@ static std::filesystem::path projectDir()
 	throw std::runtime_error("cannot find project root location");
 }
 
-int main()
+int main(int argc, char** argv)
 {
 	try
 	{
 		libgl::Application app(projectDir());
 
+		// --shader-report <file.json> writes shader reflection and build stats instead of running
+		// --msaa <samples> and --sample-shading <0..1> pick the scene multisampling,
+		// --frame-budget <milliseconds> scales the scene resolution to the GPU time, 0 turns scaling off,
+		// --depth-prepass <0|1> toggles the depth-only pass before shading,
+		// --lights <count> sets the number of point lights
+		GLsizei samples = libgl::Application::kDefaultSamples;
+		float minSampleShading = 0.0f;
+		for (int i = 1; i + 1 < argc; ++i)
+		{
+			const std::string_view option = argv[i];
+			if (option == "--shader-report")
+			{
+				app.writeShaderReport(argv[i + 1]);
+				return 0;
+			}
+			else if (option == "--msaa")
+			{
+				samples = std::stoi(argv[++i]);
+			}
+			else if (option == "--sample-shading")
+			{
+				minSampleShading = std::stof(argv[++i]);
+			}
+			else if (option == "--frame-budget")
+			{
+				app.setFrameBudget(std::stof(argv[++i]));
+			}
+			else if (option == "--depth-prepass")
+			{
+				app.setDepthPrepass(std::stoi(argv[++i]) != 0);
+			}
+			else if (option == "--lights")
+			{
+				app.setPointLightsCount(std::stoul(argv[++i]));
+			}
+		}
+		app.setMultisampling(samples, minSampleShading);
+
 		app.run();
 	}
 	catch (const std::exception& ex)
@@ -1,9 +1,21 @@
 #pragma once
 
 #include <BufferObject.hpp>
+#include <CascadedShadowMaps.hpp>
+#include <ClusteredLighting.hpp>
+#include <DynamicResolution.hpp>
+#include <GpuCulling.hpp>
+#include <GpuTimer.hpp>
 #include <Mesh.hpp>
 #include <MutableTexture.hpp>
+#include <PostProcessStack.hpp>
+#include <RenderGraph.hpp>
+#include <Sampler.hpp>
+#include <ShaderHotReload.hpp>
 #include <ShaderProgram.hpp>
+#include <ShaderVariants.hpp>
+#include <TextureArrayPacker.hpp>
+#include <TextureManager.hpp>
 #include <VertexArrayObject.hpp>
 
 #include <filesystem>
@@ -16,10 +28,27 @@ namespace libgl
 class Application
 {
 public:
+	static constexpr inline GLsizei kDefaultSamples = 4;
+	static constexpr inline std::size_t kDefaultPointLights = 4096;
+
 	Application(const std::filesystem::path& projectDir);
+	~Application();
 
 	void run();
 	void resize(int x, int y);
+	// `samples` = 0 renders the scene single-sampled, `minSampleShading` in [0, 1] is the fraction of samples
+	// shaded separately (GL_SAMPLE_SHADING), 0 shades once per pixel
+	void setMultisampling(GLsizei samples, float minSampleShading);
+	// GPU milliseconds per frame the scene resolution is scaled to meet, 0 renders at the window resolution
+	void setFrameBudget(float milliseconds);
+	// lays down the scene depth before shading, so heavy fragment shaders run once per visible sample
+	void setDepthPrepass(bool enabled) noexcept { m_depthPrepass = enabled; }
+	// scatters point lights of random colors over the scene, the same count always gives the same lights
+	void setPointLightsCount(std::size_t count);
+	void setStaticUniforms();
+
+	// reflection and build stats of every program in use as JSON, see ProgramReflection
+	void writeShaderReport(const std::filesystem::path& path) const;
 
 	static std::vector<std::uint8_t> fetchContent(const std::filesystem::path& path);
 private:
@@ -32,14 +61,44 @@ private:
 		BufferObject<glm::vec3> normals{ BufferTarget::ARRAY_BUFFER };
 		BufferObject<glm::vec2> texCoords0{ BufferTarget::ARRAY_BUFFER };
 		BufferObject<glm::u16vec3> indices{ BufferTarget::ELEMENT_ARRAY_BUFFER };
+		BufferObject<glm::vec4> instances{ BufferTarget::ARRAY_BUFFER };
+		BufferObject<glm::vec1> materials{ BufferTarget::ARRAY_BUFFER };
 		size_t indicesCount;
 	};
 
+	std::shared_ptr<ShaderVariants> m_blitVariants;
 	std::shared_ptr<ShaderProgram> m_program;
+	std::shared_ptr<ShaderVariants> m_depthVariants;
+	std::shared_ptr<ShaderProgram> m_depthProgram;
+	std::shared_ptr<ShaderHotReload> m_shaderHotReload;
 	std::shared_ptr<VertexArrayObject> m_vao;
+	// the streams the depth prepass reads, normals stay out of the vertex fetch
+	std::shared_ptr<VertexArrayObject> m_depthVao;
 	std::shared_ptr<BufferData> m_meshData;
-	std::shared_ptr<MutableTexture> m_texture;
+	std::shared_ptr<TextureManager> m_textures;
+	TextureManager::TextureId m_gridTexture;
+	// alpha masks of every material in the layers of one array, a single bind serves the whole field
+	std::shared_ptr<MutableTexture> m_masks;
+	std::shared_ptr<SamplerCache> m_samplers;
+	// a field of instanced cubes drawn through GPU culling where compute shaders are available
+	std::shared_ptr<GpuCulling> m_culling;
+	// kept sorted front to back from m_sortEye, the culling output follows the object order
+	std::vector<CullObject> m_cullObjects;
+	glm::vec3 m_sortEye{ 0.0f };
+	std::shared_ptr<ClusteredLighting> m_lighting;
+	std::shared_ptr<CascadedShadowMaps> m_shadows;
+	std::shared_ptr<RenderTargetPool> m_renderTargets;
+	std::shared_ptr<RenderGraph> m_renderGraph;
+	std::shared_ptr<PostProcessStack> m_postProcess;
+	std::shared_ptr<GpuTimer> m_gpuTimer;
+	// null when the scene always renders at the window resolution
+	std::shared_ptr<DynamicResolution> m_dynamicResolution;
+
+	GLsizei m_samples;
+	float m_minSampleShading{ 0.0f };
+	bool m_depthPrepass{ true };
 
+	glm::ivec2 m_windowSize;
 	glm::mat4 m_projMatrix;
 };
 
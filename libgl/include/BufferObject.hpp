@@ -3,6 +3,9 @@
 #include <opengl.hpp>
 #include <glm.hpp>
 
+#include <type_traits>
+#include <vector>
+
 namespace libgl
 {
 
@@ -12,7 +15,18 @@ enum class BufferTarget
 	ARRAY_BUFFER = GL_ARRAY_BUFFER,
 	ELEMENT_ARRAY_BUFFER = GL_ELEMENT_ARRAY_BUFFER,
 	PIXEL_PACK_BUFFER = GL_PIXEL_PACK_BUFFER,
-	PIXEL_UNPACK_BUFFER = GL_PIXEL_UNPACK_BUFFER
+	PIXEL_UNPACK_BUFFER = GL_PIXEL_UNPACK_BUFFER,
+	UNIFORM_BUFFER = GL_UNIFORM_BUFFER,
+	TEXTURE_BUFFER = GL_TEXTURE_BUFFER,
+
+	DRAW_INDIRECT_BUFFER = GL_DRAW_INDIRECT_BUFFER,
+
+	// OpenGL 4.3
+	SHADER_STORAGE_BUFFER = GL_SHADER_STORAGE_BUFFER,
+	DISPATCH_INDIRECT_BUFFER = GL_DISPATCH_INDIRECT_BUFFER,
+
+	// ARB_indirect_parameters, the draw count of glMultiDrawElementsIndirectCountARB
+	PARAMETER_BUFFER = GL_PARAMETER_BUFFER_ARB,
 };
 
 // https://registry.khronos.org/OpenGL-Refpages/es3.0/html/glBufferData.xhtml
@@ -46,6 +60,19 @@ public:
 
 	void bind();
 	void unbind();
+	// the same buffer often serves several targets, e.g. written as an SSBO and consumed as DRAW_INDIRECT_BUFFER
+	void bind(BufferTarget target);
+
+	// indexed binding points exist for UNIFORM_BUFFER and SHADER_STORAGE_BUFFER only
+	void bindBase(GLuint index);
+	void bindBase(BufferTarget target, GLuint index);
+	void bindRange(GLuint index, GLintptr byteOffset, GLsizeiptr bytesCount);
+
+	// OpenGL 4.3, fills the allocated storage with zeros without a CPU round trip; the size must be a multiple of 4
+	void clear();
+
+	GLuint nativeHandle() const noexcept { return m_buffer; }
+	BufferTarget target() const noexcept { return m_target; }
 protected:
 	GLuint m_buffer = kEmptyHandle;
 	BufferTarget m_target;
@@ -56,11 +83,14 @@ protected:
 template <typename...>
 class BufferObject;
 
-template <glm::length_t N, typename T>
-class BufferObject <glm::vec<N, T>> : public BufferObjectBase
+// any trivially copyable element: glm vectors for vertex data, plain structs for SSBOs laid out with std430
+template <typename T>
+class BufferObject <T> : public BufferObjectBase
 {
 public:
-	using underlying_type = glm::vec<N, T>;
+	static_assert(std::is_trivially_copyable_v<T>);
+
+	using underlying_type = T;
 	using BufferObjectBase::BufferObjectBase;
 
 	void reserve(BufferUsage usage, std::size_t elementsCount)
@@ -68,6 +98,8 @@ public:
 		bind();
 		glBufferData(static_cast<GLenum>(m_target), elementsCount * sizeof(underlying_type), nullptr, static_cast<GLenum>(usage));
 		checkGl();
+
+		m_size = elementsCount;
 	}
 
 	void setData(BufferUsage usage, const underlying_type* begin, const underlying_type *end)
@@ -77,6 +109,8 @@ public:
 		bind();
 		glBufferData(static_cast<GLenum>(m_target), elementsCount * sizeof(underlying_type), begin, static_cast<GLenum>(usage));
 		checkGl();
+
+		m_size = static_cast<std::size_t>(elementsCount);
 	}
 
 	void setData(BufferUsage usage, const std::vector<underlying_type>& vec)
@@ -84,6 +118,40 @@ public:
 		setData(usage, vec.data(), vec.data() + vec.size());
 	}
 
+	void setSubData(std::size_t firstElement, const underlying_type* begin, const underlying_type* end)
+	{
+		assert(firstElement + (end - begin) <= m_size);
+
+		bind();
+		glBufferSubData(static_cast<GLenum>(m_target), firstElement * sizeof(underlying_type), (end - begin) * sizeof(underlying_type), begin);
+		checkGl();
+	}
+
+	// blocks until the GPU is done with the buffer, meant for tools and debugging
+	std::vector<underlying_type> getData() const
+	{
+		std::vector<underlying_type> result(m_size);
+
+		glBindBuffer(static_cast<GLenum>(m_target), m_buffer);
+		checkGl();
+
+		glGetBufferSubData(static_cast<GLenum>(m_target), 0, m_size * sizeof(underlying_type), result.data());
+		checkGl();
+
+		return result;
+	}
+
+	std::size_t size() const noexcept { return m_size; }
+
+	void bindRange(GLuint index, std::size_t firstElement, std::size_t elementsCount)
+	{
+		BufferObjectBase::bindRange(index,
+			static_cast<GLintptr>(firstElement * sizeof(underlying_type)),
+			static_cast<GLsizeiptr>(elementsCount * sizeof(underlying_type)));
+	}
+
+private:
+	std::size_t m_size{ 0 };
 };
 
 }
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <BufferObject.hpp>
+#include <TextureBase.hpp>
+
+namespace libgl
+{
+
+//
+// A texture viewing the storage of a buffer object as a 1D array of texels, read with texelFetch from a samplerBuffer.
+// Unlike shader storage blocks it works in every stage since OpenGL 3.1, macOS included.
+// The texture doesn't own the buffer: attach() again after the buffer is reallocated, so width() follows its size.
+//
+class BufferTexture : public TextureBase
+{
+public:
+	BufferTexture(const BufferTexture&) = delete;
+	BufferTexture(BufferTexture&&) noexcept = default;
+	BufferTexture& operator=(const BufferTexture&) = delete;
+	BufferTexture& operator=(BufferTexture&&) noexcept = default;
+
+	template <typename T>
+	void attach(const BufferObject<T>& buffer)
+	{
+		attach(buffer.nativeHandle(), buffer.size() * sizeof(T));
+	}
+
+	// 1, 2 and 4 channel formats only, buffer textures have no 3 channel layouts before OpenGL 4.0
+	static BufferTexture make(TextureDeviceFormat format);
+	// GL_MAX_TEXTURE_BUFFER_SIZE, at least 65536 texels
+	static GLsizei maxTexels();
+
+private:
+	using TextureBase::TextureBase;
+
+	void attach(GLuint buffer, std::size_t bytes);
+};
+
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <FrameBuffer.hpp>
+#include <MutableTexture.hpp>
+#include <Sampler.hpp>
+#include <ShaderProgram.hpp>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace libgl
+{
+
+struct ShadowSettings
+{
+	// at most CascadedShadowMaps::kMaxCascades
+	GLsizei cascades{ 4 };
+	GLsizei resolution{ 2048 };
+	// shadows end here or at the far plane, whichever is closer
+	float maxDistance{ 60.0f };
+	// 0 splits the distance uniformly, 1 logarithmically
+	float splitLambda{ 0.75f };
+	// how far toward the light beyond a cascade casters are still drawn
+	float casterDistance{ 150.0f };
+	// a cascade covers this fraction of its radius more than the view slice needs and is refitted only after
+	// the camera travels that far, so most frames reuse it; larger values re-render less and resolve coarser
+	float cacheSlack{ 0.125f };
+	// glPolygonOffset of the caster pass
+	float slopeBias{ 2.0f };
+	float constantBias{ 2.0f };
+};
+
+//
+// Cascaded shadow maps of a directional light in the layers of a DEPTH_COMPONENT32F texture array,
+// each layer drawn through its own depth-only FrameBuffer.
+// Cascades split the view distance between the uniform and the logarithmic scheme and bound their slice of
+// the frustum with a sphere, so their size doesn't change as the camera turns. The sphere centers are snapped
+// in light space to a grid of whole texels, which keeps edges from shimmering, and the grid is coarser than
+// a texel by the cache slack: a cascade whose snapped fit, light direction and casters are unchanged keeps
+// the depth it already holds. invalidate() after casters move. common/shadows.glsl is the shader side.
+//
+class CascadedShadowMaps
+{
+public:
+	static constexpr inline GLuint kTextureUnit = 7;
+	static constexpr inline GLsizei kMaxCascades = 4;
+
+	// draws the casters into the bound depth-only target with the light view projection of a cascade
+	using DrawFunc = std::function<void(const glm::mat4& lightViewProjection)>;
+
+	explicit CascadedShadowMaps(const ShadowSettings& settings = {});
+	CascadedShadowMaps(const CascadedShadowMaps&) = delete;
+	CascadedShadowMaps& operator=(const CascadedShadowMaps&) = delete;
+
+	const ShadowSettings& settings() const noexcept { return m_settings; }
+
+	// fits the cascades to a symmetric perspective `projection`, `lightDirection` points toward the light in world space
+	void update(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& lightDirection);
+	// casters moved, every cascade is drawn again by the next render()
+	void invalidate() noexcept;
+	// draws the cascades whose fit changed since they were last drawn, returns how many
+	GLsizei render(const DrawFunc& drawCasters);
+	// binds the array and sets the uniforms of common/shadows.glsl for fragments in the space of `view`
+	void bind(ShaderProgram& program, const glm::mat4& view);
+
+	// for render graphs: written by render(), read by the shading passes
+	std::shared_ptr<TextureBase> texture() const { return m_depth; }
+	const glm::mat4& cascadeViewProjection(GLsizei cascade) const { return m_cascades.at(cascade).renderedViewProjection; }
+
+private:
+	struct Cascade
+	{
+		std::unique_ptr<FrameBuffer> frameBuffer;
+		glm::mat4 viewProjection{ 1.0f };
+		// the fit the layer was drawn with, shading samples it with this one
+		glm::mat4 renderedViewProjection{ 1.0f };
+		// view distance where the next cascade takes over
+		float split{ 0.0f };
+		bool valid{ false };
+	};
+
+	ShadowSettings m_settings;
+	std::shared_ptr<MutableTexture> m_depth;
+	Sampler m_compareSampler;
+	std::vector<Cascade> m_cascades;
+};
+
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <BufferObject.hpp>
+#include <BufferTexture.hpp>
+#include <ShaderProgram.hpp>
+
+#include <vector>
+
+namespace libgl
+{
+
+struct PointLight
+{
+	glm::vec3 position; // world space
+	float radius; // the contribution fades to zero here
+	glm::vec3 color; // linear, premultiplied by the intensity
+};
+
+//
+// Clustered forward shading: the view frustum is split into a grid of froxels, screen tiles times depth slices
+// spaced exponentially between the near and the far plane, and every froxel lists the point lights whose bounding
+// sphere touches it. Fragments loop over the list of their own froxel only, so the cost follows the local light
+// density rather than the total light count.
+// Binning runs on the CPU against the tile planes, the lists go to the GPU as buffer textures (see BufferTexture),
+// which fragment shaders of every supported version can read. common/clustered_lighting.glsl is the shader side.
+//
+class ClusteredLighting
+{
+public:
+	static constexpr inline GLuint kLightsUnit = 4;
+	static constexpr inline GLuint kClustersUnit = 5;
+	static constexpr inline GLuint kIndicesUnit = 6;
+
+	// tiles across, tiles down and depth slices, 16 x 9 x 24 suits 16:9 screens
+	explicit ClusteredLighting(const glm::ivec3& gridSize = glm::ivec3(16, 9, 24));
+	ClusteredLighting(const ClusteredLighting&) = delete;
+	ClusteredLighting& operator=(const ClusteredLighting&) = delete;
+
+	void setLights(std::vector<PointLight> lights);
+	const std::vector<PointLight>& lights() const noexcept { return m_lights; }
+
+	// bins the lights for a symmetric perspective `projection` and uploads the lists
+	void update(const glm::mat4& view, const glm::mat4& projection);
+	// binds the buffer textures and sets the uniforms of common/clustered_lighting.glsl,
+	// `viewportSize` is the size in pixels of the target the program draws into
+	void bind(ShaderProgram& program, const glm::ivec2& viewportSize);
+
+	const glm::ivec3& gridSize() const noexcept { return m_gridSize; }
+	// light references stored by the last update(), a light counts once per froxel it touches
+	std::size_t indicesCount() const noexcept { return m_indices.size(); }
+
+private:
+	struct LightBounds
+	{
+		glm::ivec3 min;
+		glm::ivec3 max;
+	};
+
+	glm::ivec3 m_gridSize;
+	std::vector<PointLight> m_lights;
+	float m_depthScale{ 0.0f };
+	float m_depthBias{ 0.0f };
+	GLuint m_maxIndices{ 0 };
+
+	// scratch storage kept between frames
+	std::vector<glm::vec4> m_viewLights;
+	std::vector<LightBounds> m_bounds;
+	std::vector<glm::uvec2> m_clusters;
+	std::vector<GLuint> m_indices;
+
+	// view space position and radius, then color, two texels per light
+	BufferObject<glm::vec4> m_lightsBuffer{ BufferTarget::TEXTURE_BUFFER };
+	// first index and count per cluster, x fastest, then y, then the depth slice
+	BufferObject<glm::uvec2> m_clustersBuffer{ BufferTarget::TEXTURE_BUFFER };
+	BufferObject<GLuint> m_indicesBuffer{ BufferTarget::TEXTURE_BUFFER };
+	BufferTexture m_lightsTexture;
+	BufferTexture m_clustersTexture;
+	BufferTexture m_indicesTexture;
+};
+
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <BufferObject.hpp>
+#include <ShaderProgram.hpp>
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace libgl
+{
+
+//
+// A program with a single compute stage and the dispatch API around it.
+// Needs OpenGL 4.3 or ARB_compute_shader, so it is unavailable on the macOS 4.1 context.
+// Buffers are bound with BufferObjectBase::bindBase(), images with TextureBase::bindImage();
+// results become visible to later commands only after memoryBarrier() with the matching bits.
+//
+class ComputeProgram
+{
+public:
+	explicit ComputeProgram(std::shared_ptr<ShaderProgram> program);
+	ComputeProgram(const ComputeProgram&) = delete;
+	ComputeProgram& operator=(const ComputeProgram&) = delete;
+
+	ShaderProgram& program() noexcept { return *m_program; }
+	const ShaderProgram& program() const noexcept { return *m_program; }
+	// local_size_x/y/z declared by the shader
+	const glm::ivec3& workGroupSize() const noexcept { return m_workGroupSize; }
+
+	void bind() noexcept;
+
+	// the program must be bound
+	void dispatch(GLuint groupsX, GLuint groupsY = 1, GLuint groupsZ = 1);
+	// enough groups to cover the given number of invocations in each dimension
+	void dispatchThreads(GLuint threadsX, GLuint threadsY = 1, GLuint threadsZ = 1);
+	// the buffer holds DispatchIndirectCommand, typically written by an earlier dispatch
+	void dispatchIndirect(BufferObjectBase& buffer, GLintptr byteOffset = 0);
+
+	// GL_SHADER_STORAGE_BARRIER_BIT, GL_COMMAND_BARRIER_BIT, GL_SHADER_IMAGE_ACCESS_BARRIER_BIT, ...
+	static void memoryBarrier(GLbitfield barriers);
+	static bool isSupported() noexcept;
+
+	// binaries are reused through ShaderCache::instance(), `defines` are injected as in ShaderVariants
+	static std::shared_ptr<ComputeProgram> make(const std::filesystem::path& path, const std::vector<std::string>& defines = {});
+
+private:
+	std::shared_ptr<ShaderProgram> m_program;
+	glm::ivec3 m_workGroupSize;
+	glm::ivec3 m_maxGroupsCount;
+};
+
+}
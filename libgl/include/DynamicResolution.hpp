@@ -0,0 +1,54 @@
+#pragma once
+
+#include <glm.hpp>
+
+#include <cstdint>
+
+namespace libgl
+{
+
+struct DynamicResolutionSettings
+{
+	// GPU time of a frame the controller aims for
+	float targetMilliseconds{ 1000.0f / 60.0f };
+	// the scale goes up again once frames are this fraction of the target
+	float headroom{ 0.8f };
+	float minScale{ 0.5f };
+	float maxScale{ 1.0f };
+	// scales are multiples of the step, so render targets come in a handful of sizes;
+	// RenderTargetPool only reuses them when its maxUnusedFrames is longer than cooldownFrames
+	float scaleStep{ 0.0625f };
+	// frames between two changes, the timer reports a few frames late and the average needs time to settle
+	std::uint32_t cooldownFrames{ 30 };
+};
+
+//
+// Picks the scene resolution scale from measured GPU frame times, see GpuTimer.
+// An averaged frame time over the target shrinks the scale right away by the square root of the ratio
+// (cost follows the pixel count), headroom below the target grows it back one step at a time.
+//
+class DynamicResolution
+{
+public:
+	explicit DynamicResolution(const DynamicResolutionSettings& settings = {});
+
+	const DynamicResolutionSettings& settings() const noexcept { return m_settings; }
+	void setSettings(const DynamicResolutionSettings& settings);
+
+	// returns true when the scale changed
+	bool update(float gpuMilliseconds);
+
+	float scale() const noexcept { return m_scale; }
+	float averageMilliseconds() const noexcept { return m_averageMilliseconds; }
+	glm::ivec2 renderSize(const glm::ivec2& outputSize) const noexcept;
+
+private:
+	float quantize(float scale) const noexcept;
+
+	DynamicResolutionSettings m_settings;
+	float m_scale;
+	float m_averageMilliseconds{ 0.0f };
+	std::uint32_t m_cooldown{ 0 };
+};
+
+}
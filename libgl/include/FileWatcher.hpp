@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace libgl
+{
+
+//
+// Reports files modified under a directory tree.
+// Linux uses inotify, other platforms compare modification times every kPollInterval.
+// Changes are collected on a background thread until takeChanges() is called.
+//
+class FileWatcher
+{
+public:
+	static constexpr inline auto kPollInterval = std::chrono::milliseconds(250);
+
+	explicit FileWatcher(std::filesystem::path root);
+	FileWatcher(const FileWatcher&) = delete;
+	FileWatcher& operator=(const FileWatcher&) = delete;
+	~FileWatcher();
+
+	const std::filesystem::path& root() const noexcept { return m_root; }
+
+	// canonical paths of the files changed since the previous call
+	std::vector<std::filesystem::path> takeChanges();
+
+private:
+	void run();
+	void push(const std::filesystem::path& path);
+
+#ifdef __linux__
+	void addWatch(const std::filesystem::path& directory);
+
+	int m_inotify{ -1 };
+	std::map<int, std::filesystem::path> m_watches;
+#else
+	std::map<std::filesystem::path, std::filesystem::file_time_type> scan() const;
+#endif
+
+	std::filesystem::path m_root;
+	std::mutex m_mutex;
+	std::set<std::filesystem::path> m_changes;
+	std::atomic_bool m_stop{ false };
+	std::thread m_thread;
+};
+
+}
@@ -1,10 +1,48 @@
 #pragma once
 
+#include <RenderBuffer.hpp>
 #include <TextureBase.hpp>
 
+#include <memory>
+#include <vector>
+
 namespace libgl
 {
 
+// either a texture level (one layer of it or all of them) or a renderbuffer
+struct FrameBufferAttachment
+{
+	std::shared_ptr<TextureBase> texture;
+	std::shared_ptr<RenderBuffer> renderBuffer;
+	GLint level{ 0 };
+	// -1 attaches every layer of an array or a 3D texture for layered rendering
+	GLint layer{ -1 };
+
+	bool empty() const noexcept { return !texture && !renderBuffer; }
+	GLsizei width() const noexcept;
+	GLsizei height() const noexcept;
+	TextureDeviceFormat format() const noexcept;
+
+	static FrameBufferAttachment make(std::shared_ptr<TextureBase> texture, GLint level = 0, GLint layer = -1);
+	static FrameBufferAttachment make(std::shared_ptr<RenderBuffer> renderBuffer);
+};
+
+struct FrameBufferDesc
+{
+	// GL_COLOR_ATTACHMENT0 + index, all of them are enabled as draw buffers in this order
+	std::vector<FrameBufferAttachment> colors;
+	// a depth or a packed depth/stencil format, the attachment point follows the format
+	FrameBufferAttachment depth;
+	// stencil-only storage, leave empty with a packed depth/stencil format
+	FrameBufferAttachment stencil;
+};
+
+//
+// https://www.khronos.org/opengl/wiki/Framebuffer_Object
+// Attachments, draw buffers and completeness are settled once in the constructor,
+// bind() is a single glBindFramebuffer. The attached textures and renderbuffers are kept alive,
+// unless the framebuffer is owned by a FrameBufferCache.
+//
 class FrameBuffer
 {
 public:
@@ -17,7 +55,8 @@ public:
 		READ_FRAMEBUFFER = GL_READ_FRAMEBUFFER,
 	};
 
-	FrameBuffer(BindingMode mode);
+	// throws std::runtime_error naming the status when the attachments don't form a complete framebuffer
+	explicit FrameBuffer(FrameBufferDesc desc);
 	FrameBuffer(const FrameBuffer&) = delete;
 	FrameBuffer(FrameBuffer&&) noexcept = delete;
 	~FrameBuffer() noexcept;
@@ -25,10 +64,38 @@ public:
 	FrameBuffer& operator=(const FrameBuffer&) = delete;
 	FrameBuffer& operator=(FrameBuffer&&) noexcept = delete;
 
-	void bind(const TextureBase& texture);
-	void unbind();
+	void bind(BindingMode mode = BindingMode::FRAMEBUFFER);
+	static void bindDefault(BindingMode mode = BindingMode::FRAMEBUFFER);
+
+	// viewport covering the attachments
+	void setViewport() const;
+
+	// copies the color attachment 0 and/or depth/stencil into `target`, resolving multisampled attachments on the way;
+	// a multisampled source requires equal sizes, otherwise the image is scaled with `filter`
+	void blitTo(const FrameBuffer& target, GLbitfield mask, GLenum filter = GL_NEAREST) const;
+	void blitToDefault(GLsizei width, GLsizei height, GLbitfield mask, GLenum filter = GL_NEAREST) const;
+
+	// the content of the attachments is not needed anymore, e.g. multisampled and depth targets after a resolve,
+	// so tiled and compressing drivers can skip storing it; leaves the framebuffer bound,
+	// a no-op without OpenGL 4.3 or ARB_invalidate_subdata
+	void invalidate();
+	void invalidate(const std::vector<GLenum>& attachmentPoints);
+
+	const FrameBufferDesc& desc() const noexcept { return m_desc; }
+	GLsizei width() const noexcept { return m_width; }
+	GLsizei height() const noexcept { return m_height; }
+	GLuint nativeHandle() const noexcept { return m_framebuffer; }
+
 private:
-	BindingMode m_bindngMode;
+	friend class FrameBufferCache;
+
+	// drops the references to the attachments, desc() keeps levels and layers only
+	void releaseAttachments() noexcept;
+
+	FrameBufferDesc m_desc;
+	std::vector<GLenum> m_attachmentPoints;
+	GLsizei m_width{ 0 };
+	GLsizei m_height{ 0 };
 	GLuint m_framebuffer = kEmptyHandle;
 };
 
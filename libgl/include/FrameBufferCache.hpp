@@ -0,0 +1,61 @@
+#pragma once
+
+#include <FrameBuffer.hpp>
+
+#include <map>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+namespace libgl
+{
+
+//
+// Maps an attachment set to a framebuffer object that was validated once, when it was created.
+// Cached framebuffers don't own their attachments: destroying a TextureBase or a RenderBuffer deletes
+// every framebuffer it was attached to first, so a recycled GL name never hits a stale entry
+// and drivers don't keep the storage of deleted textures alive through orphaned attachments.
+// Like the rest of the GL objects, caches are used from the thread owning the context.
+//
+class FrameBufferCache
+{
+public:
+	FrameBufferCache();
+	FrameBufferCache(const FrameBufferCache&) = delete;
+	FrameBufferCache& operator=(const FrameBufferCache&) = delete;
+	~FrameBufferCache();
+
+	// the reference stays valid until an attachment is destroyed or clear() is called
+	FrameBuffer& get(const FrameBufferDesc& desc);
+
+	std::size_t size() const noexcept { return m_frameBuffers.size(); }
+	void clear() noexcept;
+
+	// called by TextureBase and RenderBuffer right before their GL object is deleted
+	static void notifyDestroyed(GLenum kind, GLuint name) noexcept;
+
+private:
+	struct AttachmentKey
+	{
+		GLenum point;
+		GLenum kind; // GL_TEXTURE or GL_RENDERBUFFER
+		GLuint name;
+		GLint level;
+		GLint layer;
+
+		bool operator<(const AttachmentKey& other) const noexcept
+		{
+			return std::tie(point, kind, name, level, layer) < std::tie(other.point, other.kind, other.name, other.level, other.layer);
+		}
+	};
+
+	using Key = std::vector<AttachmentKey>;
+
+	static Key makeKey(const FrameBufferDesc& desc);
+	static void appendKey(Key& key, GLenum point, const FrameBufferAttachment& attachment);
+	void erase(GLenum kind, GLuint name) noexcept;
+
+	std::map<Key, std::unique_ptr<FrameBuffer>> m_frameBuffers;
+};
+
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <BufferObject.hpp>
+#include <ComputeProgram.hpp>
+#include <MutableTexture.hpp>
+#include <Sampler.hpp>
+
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+namespace libgl
+{
+
+// layout consumed by glMultiDrawElementsIndirect
+struct DrawElementsIndirectCommand
+{
+	GLuint count;
+	GLuint instanceCount;
+	GLuint firstIndex;
+	GLint baseVertex;
+	GLuint baseInstance;
+};
+
+// std430 layout of cull.cs.glsl
+struct CullObject
+{
+	glm::vec4 boundingSphere; // world space center and radius
+	GLuint indexCount;
+	GLuint firstIndex;
+	GLint baseVertex;
+	GLuint baseInstance; // selects per-object attributes through a divisor 1 vertex stream
+};
+
+//
+// Tests object bounding spheres against the view frustum and a hierarchical depth buffer on the GPU
+// and compacts the survivors into an indirect draw buffer, so the CPU never touches individual objects.
+// The compaction keeps the object order, objects sorted front to back are drawn front to back.
+// The pyramid is built from the depth of the previous frame: objects uncovered by camera motion appear one frame late.
+// The draw count stays on the GPU with ARB_indirect_parameters, otherwise the command buffer is cleared before
+// every cull and the tail of zero-instance commands is drawn as no-ops.
+//
+class GpuCulling
+{
+public:
+	static constexpr inline GLuint kTextureUnit = 1;
+
+	// loads cull.cs.glsl, cull_compact.cs.glsl, hiz_depth.cs.glsl (plain and MULTISAMPLE) and hiz_reduce.cs.glsl from the directory
+	explicit GpuCulling(const std::filesystem::path& shadersDirectory);
+	GpuCulling(const GpuCulling&) = delete;
+	GpuCulling& operator=(const GpuCulling&) = delete;
+
+	// the same count only uploads the objects again, the visibility and command buffers are kept
+	void setObjects(const std::vector<CullObject>& objects);
+	std::size_t objectsCount() const noexcept { return m_objectsCount; }
+
+	// `depth` is a depth texture, multisampled or not, of a frame rendered with `viewProjection`, the next cull() tests against it
+	void buildHiZ(const TextureBase& depth, const glm::mat4& viewProjection);
+	// occlusion is skipped until the next buildHiZ(), e.g. after a camera cut
+	void resetHiZ() noexcept { m_hiZValid = false; }
+
+	// leaves the compaction program bound; the pyramid holds the camera depth, views like shadow cascades cull without `occlusion`
+	void cull(const glm::mat4& viewProjection, bool occlusion = true);
+	// the vertex array and the element buffer of the objects must be bound
+	void draw(GLenum indexType);
+
+	std::vector<const ShaderProgram*> programs() const;
+
+	static bool isSupported() noexcept;
+
+private:
+	void allocateHiZ(GLsizei width, GLsizei height);
+
+	std::shared_ptr<ComputeProgram> m_cullProgram;
+	std::shared_ptr<ComputeProgram> m_compactProgram;
+	std::shared_ptr<ComputeProgram> m_hiZDepthProgram;
+	std::shared_ptr<ComputeProgram> m_hiZDepthMultisampleProgram;
+	std::shared_ptr<ComputeProgram> m_hiZReduceProgram;
+
+	BufferObject<CullObject> m_objects{ BufferTarget::SHADER_STORAGE_BUFFER };
+	BufferObject<GLuint> m_visible{ BufferTarget::SHADER_STORAGE_BUFFER };
+	BufferObject<DrawElementsIndirectCommand> m_commands{ BufferTarget::DRAW_INDIRECT_BUFFER };
+	BufferObject<GLuint> m_drawCount{ BufferTarget::SHADER_STORAGE_BUFFER };
+	std::size_t m_objectsCount{ 0 };
+
+	Sampler m_depthSampler;
+	Sampler m_hiZSampler;
+	std::unique_ptr<MutableTexture> m_hiZ;
+	glm::mat4 m_hiZViewProjection;
+	bool m_hiZValid{ false };
+};
+
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <opengl.hpp>
+
+#include <array>
+#include <optional>
+
+namespace libgl
+{
+
+//
+// GPU time between begin() and end() through GL_TIME_ELAPSED queries.
+// Results arrive a few frames late: queries rotate through a ring and are only read once available,
+// so measuring never stalls the pipeline. A frame is skipped when every query is still in flight.
+// Elapsed-time queries can't nest, only one timer may be active at a time.
+//
+class GpuTimer
+{
+public:
+	static constexpr inline std::size_t kQueriesCount = 4;
+
+	GpuTimer();
+	GpuTimer(const GpuTimer&) = delete;
+	GpuTimer& operator=(const GpuTimer&) = delete;
+	~GpuTimer() noexcept;
+
+	void begin();
+	void end();
+
+	// the oldest finished measurement, never waits for the GPU
+	std::optional<float> takeMilliseconds();
+
+private:
+	std::array<GLuint, kQueriesCount> m_queries{};
+	std::size_t m_first{ 0 };
+	std::size_t m_pending{ 0 };
+	bool m_active{ false };
+};
+
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace libgl
+{
+
+//
+// CPU pixel kernels used to preprocess images before upload.
+// Every function picks the widest instruction set supported by the CPU (AVX2+F16C, SSE4.1 or scalar),
+// the results do not depend on the chosen path (NaN payloads aside).
+//
+enum class SimdLevel
+{
+	SCALAR,
+	SSE41,
+	AVX2,
+};
+
+SimdLevel imageKernelsSimdLevel() noexcept;
+
+// RGBA8 <-> RGBA32F, color channels are converted from/to sRGB when `srgb` is set, alpha is always linear
+void unpackRGBA8(const std::uint8_t* src, float* dst, std::size_t pixelsCount, bool srgb);
+void packRGBA8(const float* src, std::uint8_t* dst, std::size_t pixelsCount, bool srgb);
+// RGBA16F <-> RGBA32F, halves are rounded to nearest even like F16C does
+void unpackRGBA16F(const std::uint16_t* src, float* dst, std::size_t pixelsCount);
+void packRGBA16F(const float* src, std::uint16_t* dst, std::size_t pixelsCount);
+
+// 2x2 box filter, dst is max(1, width / 2) x max(1, height / 2), odd edges are clamped
+void downsampleRGBA32F(const float* src, std::uint32_t width, std::uint32_t height, float* dst);
+// filtered in float, each destination pixel is rounded to half once
+void downsampleRGBA16F(const std::uint16_t* src, std::uint32_t width, std::uint32_t height, std::uint16_t* dst);
+// dst += src * weight over whole rows, the building block of separable filters
+void accumulateRGBA32F(const float* src, float weight, float* dst, std::size_t pixelsCount);
+
+// premultiplication happens in linear space, so sRGB data is decoded and encoded back
+void premultiplyAlphaRGBA8(std::uint8_t* pixels, std::size_t pixelsCount, bool srgb);
+void premultiplyAlphaRGBA16F(std::uint16_t* pixels, std::size_t pixelsCount);
+void premultiplyAlphaRGBA32F(float* pixels, std::size_t pixelsCount);
+
+}
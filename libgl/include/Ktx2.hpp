@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace libgl
+{
+
+// VkFormat values used by the KTX2 container
+// https://registry.khronos.org/KTX/specs/2.0/ktxspec.v2.html
+enum class Ktx2Format : std::uint32_t
+{
+	R8G8B8A8_UNORM = 37,
+	R8G8B8A8_SRGB = 43,
+	BC1_RGBA_UNORM = 133,
+	BC1_RGBA_SRGB = 134,
+	BC7_UNORM = 145,
+	BC7_SRGB = 146,
+};
+
+//
+// A single 2D image with a full or partial mip chain, levels[0] is the largest one.
+// Supercompression, arrays and cube maps are not supported.
+//
+class Ktx2Container
+{
+public:
+	Ktx2Container(Ktx2Format format, std::uint32_t width, std::uint32_t height);
+
+	Ktx2Format format() const noexcept { return m_format; }
+	std::uint32_t width() const noexcept { return m_width; }
+	std::uint32_t height() const noexcept { return m_height; }
+	std::size_t levelsCount() const noexcept { return m_levels.size(); }
+	const std::vector<std::uint8_t>& level(std::size_t index) const { return m_levels.at(index); }
+
+	void addLevel(std::vector<std::uint8_t> data);
+
+	std::vector<std::uint8_t> serialize() const;
+
+	static Ktx2Container parse(const std::vector<std::uint8_t>& bytes);
+
+	static bool isCompressed(Ktx2Format format) noexcept;
+	static bool isSrgb(Ktx2Format format) noexcept;
+	static std::uint32_t blockBytes(Ktx2Format format) noexcept;
+	static std::size_t levelBytes(Ktx2Format format, std::uint32_t width, std::uint32_t height) noexcept;
+
+private:
+	Ktx2Format m_format;
+	std::uint32_t m_width;
+	std::uint32_t m_height;
+	std::vector<std::vector<std::uint8_t>> m_levels;
+};
+
+}
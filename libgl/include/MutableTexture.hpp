@@ -17,11 +17,23 @@ public:
 	MutableTexture& operator=(const MutableTexture&) = delete;
 	MutableTexture& operator=(MutableTexture&&) noexcept = default;
 	
-	void load(const TextureData& data);
+	// for arrays and 3D textures `data` covers all layers/slices of the level, nullptr only allocates storage
+	void load(const TextureData& data, GLint level = 0);
+	void loadCompressed(const CompressedTextureData& data, GLint level);
+
+	// storage of one level without data, with a host layout the device format accepts (depth formats included);
+	// multisample textures have the only level
+	void allocate(GLint level = 0);
 
 	static MutableTexture make2D(GLsizei width, GLsizei height, TextureDeviceFormat format);
+	static MutableTexture make2DArray(GLsizei width, GLsizei height, GLsizei layers, TextureDeviceFormat format);
+	static MutableTexture make3D(GLsizei width, GLsizei height, GLsizei depth, TextureDeviceFormat format);
+	// `samples` must not exceed GL_MAX_COLOR_TEXTURE_SAMPLES or GL_MAX_DEPTH_TEXTURE_SAMPLES, sampled with texelFetch only
+	static MutableTexture make2DMultisample(GLsizei width, GLsizei height, GLsizei samples, TextureDeviceFormat format);
 private:
 	using TextureBase::TextureBase;
+
+	GLsizei levelDepth(GLint level) const noexcept;
 };
 
-}
\ No newline at end of file
+}
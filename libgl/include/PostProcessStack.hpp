@@ -0,0 +1,84 @@
+#pragma once
+
+#include <ProgramPipeline.hpp>
+#include <RenderGraph.hpp>
+#include <Sampler.hpp>
+#include <VertexArrayObject.hpp>
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace libgl
+{
+
+struct PostProcessSettings
+{
+	float exposure{ 1.0f };
+
+	bool bloom{ true };
+	// pyramid levels below the source resolution, the smallest level is at least 1x1
+	GLsizei bloomLevels{ 6 };
+	float bloomThreshold{ 1.0f };
+	float bloomKnee{ 0.5f };
+	float bloomIntensity{ 0.05f };
+	// upsampling tent radius in texels of the smaller level
+	float bloomRadius{ 1.0f };
+
+	bool fxaa{ true };
+
+	// upscaling of a scene rendered below the back buffer resolution:
+	// 0 is plain bilinear, up to 1 adds contrast adaptive sharpening
+	float upscaleSharpness{ 0.5f };
+};
+
+//
+// Bloom, tone mapping and FXAA as render graph passes drawing a single fullscreen triangle without vertex streams.
+// Every pass is a program pipeline sharing one separable fullscreen.vs.glsl stage, so each fragment variant links alone.
+// Passes are merged where nothing needs the intermediate image: the bright-pass filter runs inside the first downsample,
+// bloom composite, exposure, tone mapping and the FXAA luma run in one pass with the combination picked by defines.
+// The pyramid is R11F_G11F_B10F and the tone mapped image SRGB8_ALPHA8, all of them transient pooled targets.
+// A source smaller than the back buffer (dynamic resolution) is processed at its own size and upscaled last.
+//
+class PostProcessStack
+{
+public:
+	static constexpr inline GLuint kSourceUnit = 2;
+	static constexpr inline GLuint kBloomUnit = 3;
+
+	// loads fullscreen.vs.glsl, bloom_downsample.fs.glsl, bloom_upsample.fs.glsl, post_composite.fs.glsl, fxaa.fs.glsl and upscale.fs.glsl
+	explicit PostProcessStack(const std::filesystem::path& shadersDirectory);
+	PostProcessStack(const PostProcessStack&) = delete;
+	PostProcessStack& operator=(const PostProcessStack&) = delete;
+
+	const PostProcessSettings& settings() const noexcept { return m_settings; }
+	void setSettings(const PostProcessSettings& settings);
+
+	// `source` is a single-sampled linear HDR target of the graph of `width` x `height`, the last pass writes the back buffer
+	void addPasses(RenderGraph& graph, const std::string& source, GLsizei width, GLsizei height);
+
+	std::vector<const ShaderProgram*> programs() const;
+
+private:
+	// binds the pipeline and returns its fragment stage, uniforms of the pass are set there
+	static ShaderProgram& bindPipeline(ProgramPipeline& pipeline);
+	void drawFullscreenTriangle();
+	void bindSource(const TextureBase& texture, GLuint unit);
+
+	PostProcessSettings m_settings;
+
+	std::filesystem::path m_fullscreenPath;
+	std::filesystem::path m_compositePath;
+	std::filesystem::path m_upscalePath;
+	ProgramPipelineLibrary m_pipelines;
+	std::shared_ptr<ProgramPipeline> m_prefilterPipeline;
+	std::shared_ptr<ProgramPipeline> m_downsamplePipeline;
+	std::shared_ptr<ProgramPipeline> m_upsamplePipeline;
+	std::shared_ptr<ProgramPipeline> m_fxaaPipeline;
+
+	VertexArrayObject m_emptyVao;
+	Sampler m_linearClamp;
+};
+
+}
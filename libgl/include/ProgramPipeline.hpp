@@ -0,0 +1,73 @@
+#pragma once
+
+#include <ShaderProgram.hpp>
+
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace libgl
+{
+
+//
+// Combines separable programs (ShaderProgram::makeStage) into a pipeline, so one linked vertex stage
+// serves any number of fragment stages. Uniforms are set on the stage programs themselves.
+//
+class ProgramPipeline
+{
+public:
+	static constexpr inline auto kEmptyHandle = (std::numeric_limits<GLuint>::max)();
+
+	ProgramPipeline();
+	ProgramPipeline(const ProgramPipeline&) = delete;
+	ProgramPipeline& operator=(const ProgramPipeline&) = delete;
+	~ProgramPipeline() noexcept;
+
+	// `stages` is a mask of GL_*_SHADER_BIT, the program must be separable and contain those stages
+	void useStages(GLbitfield stages, std::shared_ptr<ShaderProgram> program);
+	std::shared_ptr<ShaderProgram> stageProgram(GLbitfield stage) const;
+
+	// glUseProgram takes precedence over a bound pipeline, so bind() resets it
+	void bind();
+	static void unbind();
+
+	void validate();
+
+	GLuint nativeHandle() const noexcept { return m_pipeline; }
+
+	static GLbitfield stageBit(GLenum stage);
+
+private:
+	GLuint m_pipeline = kEmptyHandle;
+	std::vector<std::pair<GLbitfield, std::shared_ptr<ShaderProgram>>> m_programs;
+};
+
+//
+// Builds every stage source once and one pipeline per distinct stage combination.
+// Many materials over a few vertex formats cost a few vertex links instead of one full link per material.
+//
+class ProgramPipelineLibrary
+{
+public:
+	ProgramPipelineLibrary() = default;
+	ProgramPipelineLibrary(const ProgramPipelineLibrary&) = delete;
+	ProgramPipelineLibrary& operator=(const ProgramPipelineLibrary&) = delete;
+
+	// `defines` are injected like ShaderVariants keywords, every combination is a stage of its own
+	std::shared_ptr<ShaderProgram> stage(GLenum stage, const std::filesystem::path& path, const std::vector<std::string>& defines = {});
+	std::shared_ptr<ProgramPipeline> get(const std::filesystem::path& vertexPath, const std::filesystem::path& fragmentPath, const std::vector<std::string>& fragmentDefines = {});
+
+	std::vector<const ShaderProgram*> stages() const;
+	std::size_t stagesCount() const noexcept { return m_stages.size(); }
+	std::size_t pipelinesCount() const noexcept { return m_pipelines.size(); }
+
+private:
+	std::map<std::tuple<GLenum, std::filesystem::path, std::vector<std::string>>, std::shared_ptr<ShaderProgram>> m_stages;
+	std::map<std::pair<const ShaderProgram*, const ShaderProgram*>, std::shared_ptr<ProgramPipeline>> m_pipelines;
+};
+
+}
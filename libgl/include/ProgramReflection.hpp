@@ -0,0 +1,57 @@
+#pragma once
+
+#include <ShaderProgram.hpp>
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace libgl
+{
+
+struct ReflectedVariable
+{
+	std::string name;
+	GLenum type;
+	GLint arraySize;
+	GLint location; // -1 for members of blocks
+	GLint blockIndex{ -1 };
+	GLint blockOffset{ -1 };
+	GLint textureUnit{ -1 }; // samplers and images only
+};
+
+struct ReflectedBlock
+{
+	std::string name;
+	GLint binding;
+	GLint dataSize;
+	GLint activeVariables;
+};
+
+//
+// Active interface of a linked program as reported by the driver: attributes, default block uniforms,
+// samplers and images, uniform blocks and (OpenGL 4.3) shader storage blocks, plus the binary size and build stats.
+// Inactive declarations are optimized away by the driver and never show up.
+//
+struct ProgramReflection
+{
+	std::string label;
+	ProgramStats stats;
+	GLint binaryBytes{ 0 };
+
+	std::vector<ReflectedVariable> attributes;
+	std::vector<ReflectedVariable> uniforms;
+	std::vector<ReflectedVariable> samplers;
+	std::vector<ReflectedBlock> uniformBlocks;
+	std::vector<ReflectedBlock> storageBlocks;
+
+	static ProgramReflection query(const ShaderProgram& program);
+
+	// GLSL spelling of the common types, hexadecimal enum values for the rest
+	static std::string typeName(GLenum type);
+
+	// one JSON document with the driver strings and every program, meant for tracking shader cost across releases
+	static void writeJson(std::ostream& stream, const std::vector<const ShaderProgram*>& programs);
+};
+
+}
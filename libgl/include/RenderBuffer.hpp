@@ -0,0 +1,40 @@
+#pragma once
+
+#include <TextureBase.hpp>
+
+namespace libgl
+{
+
+//
+// https://www.khronos.org/opengl/wiki/Renderbuffer_Object
+// Render target storage that is never sampled, e.g. a depth buffer used for testing only.
+//
+class RenderBuffer
+{
+public:
+	static constexpr inline auto kEmptyHandle = (std::numeric_limits<GLuint>::max)();
+
+	// `samples` = 0 makes a single-sampled buffer, greater values must not exceed GL_MAX_SAMPLES
+	RenderBuffer(TextureDeviceFormat format, GLsizei width, GLsizei height, GLsizei samples = 0);
+	RenderBuffer(const RenderBuffer&) = delete;
+	RenderBuffer(RenderBuffer&&) noexcept;
+	~RenderBuffer() noexcept;
+
+	RenderBuffer& operator=(const RenderBuffer&) = delete;
+	RenderBuffer& operator=(RenderBuffer&&) noexcept;
+
+	TextureDeviceFormat format() const noexcept { return m_format; }
+	GLsizei width() const noexcept { return m_width; }
+	GLsizei height() const noexcept { return m_height; }
+	GLsizei samples() const noexcept { return m_samples; }
+	GLuint nativeHandle() const noexcept { return m_renderBuffer; }
+
+private:
+	TextureDeviceFormat m_format;
+	GLsizei m_width;
+	GLsizei m_height;
+	GLsizei m_samples;
+	GLuint m_renderBuffer = kEmptyHandle;
+};
+
+}
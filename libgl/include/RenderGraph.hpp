@@ -0,0 +1,153 @@
+#pragma once
+
+#include <FrameBufferCache.hpp>
+#include <RenderTargetPool.hpp>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace libgl
+{
+
+//
+// Passes declare the render targets they read and write, compile() derives the execution order from that:
+// a read sees the latest write declared before the pass (or the first write, when the reader is declared ahead of it),
+// a write waits for the passes still reading the previous content. Independent passes keep their declaration order.
+// compile() also drops passes whose results reach neither the back buffer, an imported texture nor a pass marked with side effects,
+// and lets transient targets with non-overlapping lifetimes and equal descriptions share a texture from the RenderTargetPool.
+// A transient target's content is undefined until its first writer draws it: aliased textures keep whatever
+// the previous owner left, so the first writer clears or covers every pixel.
+// Transient targets are invalidated right after the last pass using them, a multisampled target resolved by
+// PassContext::resolve() and its depth are never stored back to memory.
+// The graph is rebuilt every frame: reset(), declare resources and passes, compile(), execute().
+// Textures are held until reset(), so they count as used by the pool until the next frame is recorded.
+//
+class RenderGraph
+{
+public:
+	class PassBuilder
+	{
+	public:
+		PassBuilder& read(const std::string& resource);
+		PassBuilder& write(const std::string& resource);
+		PassBuilder& writeBackBuffer();
+		// keeps the pass even when nothing consumes its results, e.g. a readback or a buffer update
+		PassBuilder& setSideEffects();
+
+	private:
+		friend class RenderGraph;
+		PassBuilder(RenderGraph& graph, std::size_t pass) : m_graph(graph), m_pass(pass) {}
+
+		RenderGraph& m_graph;
+		std::size_t m_pass;
+	};
+
+	class PassContext
+	{
+	public:
+		const std::string& passName() const noexcept;
+		// a texture the pass reads or writes
+		TextureBase& texture(const std::string& resource) const;
+		// binds the targets written by the pass, or the back buffer, and sets a viewport covering them
+		void bindFrameBuffer() const;
+		// blits a target the pass reads into the targets it writes, or the back buffer, resolving multisamples
+		void resolve(const std::string& source, GLbitfield mask = GL_COLOR_BUFFER_BIT) const;
+
+	private:
+		friend class RenderGraph;
+		PassContext(RenderGraph& graph, std::size_t pass) : m_graph(graph), m_pass(pass) {}
+
+		RenderGraph& m_graph;
+		std::size_t m_pass;
+	};
+
+	using ExecuteFunc = std::function<void(const PassContext&)>;
+
+	explicit RenderGraph(std::shared_ptr<RenderTargetPool> pool);
+	RenderGraph(const RenderGraph&) = delete;
+	RenderGraph& operator=(const RenderGraph&) = delete;
+
+	void createTarget(std::string name, RenderTargetDesc desc);
+	// an imported texture outlives the frame, passes writing it are never culled
+	void importTexture(std::string name, std::shared_ptr<TextureBase> texture);
+	PassBuilder addPass(std::string name, ExecuteFunc execute);
+	void setBackBufferSize(GLsizei width, GLsizei height) noexcept;
+	GLsizei backBufferWidth() const noexcept { return m_backBufferWidth; }
+	GLsizei backBufferHeight() const noexcept { return m_backBufferHeight; }
+
+	// throws std::invalid_argument for unknown resources, std::runtime_error for dependency cycles
+	void compile();
+	void execute();
+	void reset() noexcept;
+
+	// names of the passes compile() kept, in execution order
+	std::vector<std::string> executionOrder() const;
+	std::size_t culledPassesCount() const noexcept { return m_passes.size() - m_order.size(); }
+	// textures backing the transient targets after aliasing
+	std::size_t physicalTargetsCount() const noexcept { return m_physicalTargets.size(); }
+
+private:
+	struct Resource
+	{
+		std::string name;
+		RenderTargetDesc desc;
+		std::shared_ptr<TextureBase> texture;
+		bool imported{ false };
+		std::vector<std::size_t> writers;
+		std::vector<std::size_t> readers;
+		// positions in m_order
+		std::size_t firstUse{ 0 };
+		std::size_t lastUse{ 0 };
+	};
+
+	struct Pass
+	{
+		std::string name;
+		ExecuteFunc execute;
+		std::vector<std::string> readNames;
+		std::vector<std::string> writeNames;
+		std::vector<std::size_t> reads;
+		std::vector<std::size_t> writes;
+		// passes whose output this one consumes
+		std::vector<std::size_t> producers;
+		bool backBuffer{ false };
+		bool sideEffects{ false };
+		bool alive{ false };
+	};
+
+	struct PhysicalTarget
+	{
+		RenderTargetDesc desc;
+		std::shared_ptr<TextureBase> texture;
+		// position in m_order of the last pass using the texture
+		std::size_t busyUntil{ 0 };
+	};
+
+	std::size_t resourceIndex(const std::string& name) const;
+	FrameBuffer& passFrameBuffer(std::size_t pass);
+	// a framebuffer with the only attachment, for resolves and invalidation
+	FrameBuffer& resourceFrameBuffer(std::size_t resource);
+	void invalidateExpired(std::size_t position);
+	void resolveResources();
+	void sortPasses();
+	void cullPasses();
+	void assignTextures();
+
+	std::vector<Resource> m_resources;
+	std::unordered_map<std::string, std::size_t> m_resourceIndices;
+	std::vector<Pass> m_passes;
+	std::vector<std::size_t> m_order;
+	bool m_compiled{ false };
+
+	GLsizei m_backBufferWidth{ 0 };
+	GLsizei m_backBufferHeight{ 0 };
+
+	std::shared_ptr<RenderTargetPool> m_pool;
+	std::vector<PhysicalTarget> m_physicalTargets;
+	FrameBufferCache m_frameBuffers;
+};
+
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <MutableTexture.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace libgl
+{
+
+// a 2D render target, multisampled when `samples` isn't 0
+struct RenderTargetDesc
+{
+	TextureDeviceFormat format{ TextureDeviceFormat::RGBA8 };
+	GLsizei width{ 0 };
+	GLsizei height{ 0 };
+	GLsizei samples{ 0 };
+
+	bool operator==(const RenderTargetDesc& other) const noexcept
+	{
+		return format == other.format && width == other.width && height == other.height && samples == other.samples;
+	}
+	bool operator!=(const RenderTargetDesc& other) const noexcept { return !(*this == other); }
+};
+
+//
+// Recycles render target textures across frames instead of allocating and deleting them per effect or per resize.
+// A texture handed out by acquire() returns to the pool when the last reference outside of it is dropped,
+// textures nobody acquired for maxUnusedFrames are deleted by nextFrame(), so a resize frees the old sizes a few frames later.
+// Framebuffers of the recycled textures stay in FrameBufferCache as long as the textures live.
+//
+class RenderTargetPool
+{
+public:
+	static constexpr inline GLuint kAllocationUnit = 15;
+	// enough for a window resize, sizes picked by DynamicResolution need to be kept longer than its cooldown
+	static constexpr inline std::uint32_t kDefaultMaxUnusedFrames = 4;
+
+	explicit RenderTargetPool(std::uint32_t maxUnusedFrames = kDefaultMaxUnusedFrames);
+	RenderTargetPool(const RenderTargetPool&) = delete;
+	RenderTargetPool& operator=(const RenderTargetPool&) = delete;
+
+	// a texture nobody else holds, its content is whatever the previous user left
+	std::shared_ptr<TextureBase> acquire(const RenderTargetDesc& desc);
+	// once per frame, releases the textures unused for too long
+	void nextFrame();
+	void clear() noexcept;
+
+	std::size_t size() const noexcept { return m_entries.size(); }
+	std::size_t memoryUsage() const noexcept;
+
+private:
+	struct Entry
+	{
+		RenderTargetDesc desc;
+		std::shared_ptr<TextureBase> texture;
+		std::uint64_t lastUsedFrame{ 0 };
+	};
+
+	std::uint32_t m_maxUnusedFrames;
+	std::uint64_t m_frame{ 0 };
+	std::vector<Entry> m_entries;
+};
+
+}
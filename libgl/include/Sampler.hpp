@@ -0,0 +1,107 @@
+#pragma once
+
+#include <opengl.hpp>
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace libgl
+{
+
+enum class TextureFilter
+{
+	NEAREST = GL_NEAREST,
+	LINEAR = GL_LINEAR,
+};
+
+enum class MipmapMode
+{
+	NONE,
+	NEAREST,
+	LINEAR,
+};
+
+enum class TextureWrap
+{
+	REPEAT = GL_REPEAT,
+	MIRRORED_REPEAT = GL_MIRRORED_REPEAT,
+	CLAMP_TO_EDGE = GL_CLAMP_TO_EDGE,
+	CLAMP_TO_BORDER = GL_CLAMP_TO_BORDER,
+};
+
+struct SamplerDesc
+{
+	TextureFilter magFilter{ TextureFilter::LINEAR };
+	TextureFilter minFilter{ TextureFilter::LINEAR };
+	MipmapMode mipmapMode{ MipmapMode::LINEAR };
+	TextureWrap wrapS{ TextureWrap::REPEAT };
+	TextureWrap wrapT{ TextureWrap::REPEAT };
+	TextureWrap wrapR{ TextureWrap::REPEAT };
+	float maxAnisotropy{ 1.0f };
+	float lodBias{ 0.0f };
+	// depth textures return the GL_LEQUAL comparison against the reference coordinate, read through sampler*Shadow
+	bool depthCompare{ false };
+
+	bool operator==(const SamplerDesc& other) const noexcept;
+	bool operator!=(const SamplerDesc& other) const noexcept { return !(*this == other); }
+};
+
+struct SamplerDescHash
+{
+	std::size_t operator()(const SamplerDesc& desc) const noexcept;
+};
+
+//
+// https://www.khronos.org/opengl/wiki/Sampler_Object
+// A sampler bound to a unit overrides the sampling state of any texture bound to the same unit.
+//
+class Sampler
+{
+public:
+	static constexpr inline auto kEmptyHandle = (std::numeric_limits<GLuint>::max)();
+
+	explicit Sampler(const SamplerDesc& desc);
+	Sampler(const Sampler&) = delete;
+	Sampler(Sampler&&) noexcept;
+	~Sampler() noexcept;
+
+	Sampler& operator=(const Sampler&) = delete;
+	Sampler& operator=(Sampler&&) noexcept;
+
+	void bind(GLuint unit) const;
+	static void unbind(GLuint unit);
+
+	const SamplerDesc& desc() const noexcept { return m_desc; }
+	GLuint nativeHandle() const noexcept { return m_sampler; }
+
+private:
+	SamplerDesc m_desc;
+	GLuint m_sampler = kEmptyHandle;
+};
+
+//
+// Creates a single sampler per unique description and skips redundant glBindSampler calls.
+// The cache assumes it is the only code binding samplers while it is alive.
+//
+class SamplerCache
+{
+public:
+	SamplerCache() = default;
+	SamplerCache(const SamplerCache&) = delete;
+	SamplerCache& operator=(const SamplerCache&) = delete;
+
+	std::shared_ptr<Sampler> get(const SamplerDesc& desc);
+
+	void bind(GLuint unit, const SamplerDesc& desc);
+	void bind(GLuint unit, const Sampler& sampler);
+	void unbind(GLuint unit);
+
+	std::size_t size() const noexcept { return m_samplers.size(); }
+
+private:
+	std::unordered_map<SamplerDesc, std::shared_ptr<Sampler>, SamplerDescHash> m_samplers;
+	std::vector<GLuint> m_boundSamplers;
+};
+
+}
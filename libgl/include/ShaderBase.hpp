@@ -21,6 +21,14 @@ public:
 	const std::string& compilationLog() const noexcept { return m_log; }
 	GLuint nativeHandle() const noexcept { return m_shaderId; }
 
+	// compile() split in two halves: with KHR_parallel_shader_compile the driver compiles in the background
+	// between submitCompile() and finishCompile(), isCompileComplete() tells whether finishCompile() would block
+	void submitCompile(const std::string& src);
+	bool isCompileComplete() const;
+	[[nodiscard]] bool finishCompile();
+
+	static bool parallelCompileSupported() noexcept;
+
 protected:
 	[[nodiscard]] bool compile(const std::string& src);
 private:
@@ -53,5 +61,7 @@ ShaderImpl<kType>::ShaderImpl(const std::string& code) : ShaderBase(kType)
 
 using VertexShader = ShaderImpl<GL_VERTEX_SHADER>;
 using FragmentShader = ShaderImpl<GL_FRAGMENT_SHADER>;
+// OpenGL 4.3, see ComputeProgram::isSupported()
+using ComputeShader = ShaderImpl<GL_COMPUTE_SHADER>;
 
 }
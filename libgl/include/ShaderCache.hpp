@@ -0,0 +1,112 @@
+#pragma once
+
+#include <opengl.hpp>
+
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace libgl
+{
+
+class ShaderProgram;
+
+struct ShaderCacheKey
+{
+	std::uint64_t high;
+	std::uint64_t low;
+
+	bool operator==(const ShaderCacheKey& other) const noexcept { return high == other.high && low == other.low; }
+	bool operator!=(const ShaderCacheKey& other) const noexcept { return !(*this == other); }
+
+	std::string toString() const;
+};
+
+struct ShaderCacheStats
+{
+	std::size_t hits{ 0 };
+	std::size_t misses{ 0 };
+	std::size_t rejected{ 0 }; // binary found but refused by the driver
+	std::size_t stores{ 0 };
+	std::size_t evictions{ 0 };
+	std::uintmax_t totalBytes{ 0 };
+};
+
+//
+// Content-addressed storage for program binaries.
+// A key is a 128-bit hash of every program input (sources, defines) and the GL vendor/renderer/version strings,
+// so a driver update or a GPU swap never feeds a stale binary to glProgramBinary.
+// Files are written to a temporary name and renamed, the index keeps sizes and last use for LRU eviction.
+// All methods are thread safe, load() and store() need a current GL context.
+//
+class ShaderCache
+{
+public:
+	static constexpr inline std::uintmax_t kDefaultMaxBytes = 64 * 1024 * 1024;
+
+	explicit ShaderCache(std::filesystem::path directory, std::uintmax_t maxBytes = kDefaultMaxBytes);
+	ShaderCache(const ShaderCache&) = delete;
+	ShaderCache& operator=(const ShaderCache&) = delete;
+	~ShaderCache();
+
+	// parts are length-prefixed, so {"ab", "c"} and {"a", "bc"} or swapped sources never collide
+	ShaderCacheKey makeKey(const std::vector<std::string_view>& parts) const;
+
+	// returns an empty pointer on a miss or when the driver refuses the stored binary
+	std::shared_ptr<ShaderProgram> load(const ShaderCacheKey& key);
+	void store(const ShaderCacheKey& key, const ShaderProgram& program);
+
+	// Turns every cached binary into a program object ahead of the first frame: files are read in parallel
+	// and glProgramBinary runs on a worker thread with a hidden context sharing objects with `mainWindow`.
+	// Both calls belong to the main thread, load() hands out the prewarmed programs after finishPrewarm().
+	void beginPrewarm(GLFWwindow* mainWindow);
+	std::size_t finishPrewarm();
+	// unused prewarmed programs must be deleted while the GL context is alive
+	void releasePrewarmed();
+
+	void flush();
+	ShaderCacheStats stats() const;
+
+	// shared cache in "shader_cache" under the current working directory
+	static ShaderCache& instance();
+
+private:
+	struct IndexEntry
+	{
+		std::uintmax_t bytes;
+		std::uint64_t lastUsed;
+	};
+
+	std::filesystem::path entryPath(const std::string& name) const;
+	void loadIndex();
+	void saveIndex();
+	void evict();
+	void remove(const std::string& name);
+	void prewarm(const std::vector<std::filesystem::path>& paths);
+
+	static std::vector<char> readEntry(const std::filesystem::path& path);
+	static bool setBinary(ShaderProgram& program, const std::vector<char>& binary);
+
+	std::filesystem::path m_directory;
+	std::uintmax_t m_maxBytes;
+	mutable std::mutex m_mutex;
+	mutable std::string m_driverFingerprint;
+	std::unordered_map<std::string, IndexEntry> m_index;
+	std::uint64_t m_tick{ 0 };
+	bool m_indexDirty{ false };
+	ShaderCacheStats m_stats;
+
+	std::unordered_map<std::string, std::shared_ptr<ShaderProgram>> m_prewarmed;
+	GLFWwindow* m_prewarmWindow{ nullptr };
+	std::thread m_prewarmThread;
+	std::exception_ptr m_prewarmError;
+};
+
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <ShaderBase.hpp>
+#include <ShaderCache.hpp>
+#include <ShaderProgram.hpp>
+
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace libgl
+{
+
+//
+// A single program build: cache lookup, compile of the stages, link and cache store.
+// Every step is started as soon as the previous one is complete, so with KHR_parallel_shader_compile
+// the driver works on all submitted builds at once while the application keeps loading other resources.
+//
+class ProgramBuild
+{
+public:
+	ProgramBuild(std::string vertexSource, std::string fragmentSource);
+	// single stage program: separable ones go to ProgramPipeline, a compute program is complete on its own
+	ProgramBuild(GLenum stage, std::string source, bool separable = true);
+	ProgramBuild(const ProgramBuild&) = delete;
+	ProgramBuild& operator=(const ProgramBuild&) = delete;
+
+	// advances the build, returns true once it is finished; never blocks on the driver unless `wait` is set
+	bool poll(bool wait);
+	bool finished() const noexcept { return m_state == State::DONE || m_state == State::FAILED; }
+
+	// throws std::invalid_argument with the compilation or link log when the build failed
+	std::shared_ptr<ShaderProgram> program() const;
+
+private:
+	enum class State
+	{
+		COMPILING,
+		LINKING,
+		DONE,
+		FAILED,
+	};
+
+	void submitCompile(GLenum stage, const std::string& source);
+	void fail(const std::string& log);
+
+	using Clock = std::chrono::steady_clock;
+
+	State m_state{ State::COMPILING };
+	Clock::time_point m_submitTime;
+	ShaderCacheKey m_key;
+	std::shared_ptr<ShaderProgram> m_program;
+	std::vector<std::unique_ptr<ShaderBase>> m_shaders;
+	std::string m_error;
+};
+
+//
+// Future-like access to a program built by ShaderCompileQueue.
+//
+class ProgramHandle
+{
+public:
+	ProgramHandle() = default;
+	explicit ProgramHandle(std::shared_ptr<ProgramBuild> build) : m_build(std::move(build)) {}
+
+	bool valid() const noexcept { return m_build != nullptr; }
+	// non-blocking
+	bool ready() const;
+	// blocks until the build is finished
+	std::shared_ptr<ShaderProgram> get() const;
+
+private:
+	std::shared_ptr<ProgramBuild> m_build;
+};
+
+class ShaderCompileQueue
+{
+public:
+	// asks the driver for as many compiler threads as it can use
+	ShaderCompileQueue();
+	ShaderCompileQueue(const ShaderCompileQueue&) = delete;
+	ShaderCompileQueue& operator=(const ShaderCompileQueue&) = delete;
+
+	ProgramHandle submit(const std::filesystem::path& vertexPath, const std::filesystem::path& fragmentPath);
+	ProgramHandle submitSources(std::string vertexSource, std::string fragmentSource);
+	ProgramHandle submitStage(GLenum stage, const std::filesystem::path& path, const std::vector<std::string>& defines = {});
+
+	// advances every pending build without blocking, call it once per frame or between loading steps
+	void poll();
+	// blocks until every submitted build is finished
+	void finish();
+
+	std::size_t pendingCount() const noexcept { return m_pending.size(); }
+
+private:
+	std::vector<std::shared_ptr<ProgramBuild>> m_pending;
+};
+
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <FileWatcher.hpp>
+#include <ShaderProgram.hpp>
+
+#include <condition_variable>
+#include <exception>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct GLFWwindow;
+
+namespace libgl
+{
+
+//
+// Rebuilds tracked programs when one of their source files (includes too) changes under the watched directory.
+// Compilation runs on a worker thread with a hidden context sharing objects with the main window,
+// update() swaps finished programs in between frames. Attribute locations of the old program are kept,
+// so vertex array objects stay valid. A failed build prints its log and leaves the old program in place.
+//
+class ShaderHotReload
+{
+public:
+	ShaderHotReload(GLFWwindow* mainWindow, const std::filesystem::path& watchedDirectory);
+	ShaderHotReload(const ShaderHotReload&) = delete;
+	ShaderHotReload& operator=(const ShaderHotReload&) = delete;
+	~ShaderHotReload();
+
+	// main thread, reads the attribute locations the rebuilt program keeps
+	void track(std::shared_ptr<ShaderProgram> program, std::filesystem::path vertexPath, std::filesystem::path fragmentPath, std::vector<std::string> defines = {});
+
+	// main thread, between frames; returns true when any program was replaced and uniforms must be set again
+	bool update();
+
+private:
+	struct TrackedProgram
+	{
+		std::shared_ptr<ShaderProgram> program;
+		std::filesystem::path vertexPath;
+		std::filesystem::path fragmentPath;
+		std::vector<std::string> defines;
+		std::vector<std::filesystem::path> dependencies;
+		// read on the main thread, the worker never queries the live program
+		std::vector<std::pair<std::string, GLint>> attribLocations;
+	};
+
+	struct ReadyProgram
+	{
+		std::shared_ptr<ShaderProgram> target;
+		std::shared_ptr<ShaderProgram> replacement;
+	};
+
+	void run();
+	void rebuild(TrackedProgram& tracked);
+
+	GLFWwindow* m_window{ nullptr };
+	FileWatcher m_watcher;
+
+	std::mutex m_mutex;
+	std::condition_variable m_wakeUp;
+	bool m_stop{ false };
+	std::vector<TrackedProgram> m_tracked;
+	std::vector<ReadyProgram> m_ready;
+	std::exception_ptr m_error;
+
+	std::thread m_thread;
+};
+
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace libgl
+{
+
+struct ShaderSource
+{
+	std::string text;
+	// dependencies[0] is the root file, the index is the source string number in #line directives
+	std::vector<std::filesystem::path> dependencies;
+};
+
+//
+// Expands `#include "file"` directives: the path is looked up next to the including file first,
+// then in every include directory. `#pragma once` is honoured, include cycles throw std::invalid_argument.
+// Expansions are cached until one of the files they were built from changes on disk,
+// and since the expanded text feeds the ShaderCache key, binaries follow the actual dependencies.
+//
+class ShaderPreprocessor
+{
+public:
+	void addIncludeDirectory(std::filesystem::path directory);
+
+	ShaderSource load(const std::filesystem::path& path);
+
+	// cached root files that include `file` directly or transitively
+	std::vector<std::filesystem::path> dependents(const std::filesystem::path& file) const;
+	// forgets every cached expansion depending on `file`
+	void invalidate(const std::filesystem::path& file);
+
+	static ShaderPreprocessor& instance();
+
+private:
+	struct CacheEntry
+	{
+		ShaderSource source;
+		std::vector<std::filesystem::file_time_type> timestamps;
+	};
+
+	struct ExpansionState
+	{
+		ShaderSource result;
+		std::vector<std::filesystem::path> stack;
+		std::vector<std::filesystem::path> onceFiles;
+	};
+
+	std::filesystem::path resolve(const std::string& name, const std::filesystem::path& includingFile) const;
+	void expand(const std::filesystem::path& path, ExpansionState& state) const;
+	bool isUpToDate(const CacheEntry& entry) const;
+
+	mutable std::mutex m_mutex;
+	std::vector<std::filesystem::path> m_includeDirectories;
+	std::map<std::filesystem::path, CacheEntry> m_cache;
+};
+
+}
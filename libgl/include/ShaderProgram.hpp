@@ -3,16 +3,21 @@
 #include <ShaderBase.hpp>
 
 #include <glm.hpp>
+#include <filesystem>
 #include <string_view>
 #include <vector>
 
-namespace std::filesystem
+namespace libgl
 {
-class path;
-}
 
-namespace libgl
+// Wall time from submission to completion, so with parallel compilation and non-blocking polls
+// the numbers are upper bounds. Programs loaded from ShaderCache report zero times.
+struct ProgramStats
 {
+	double compileMilliseconds{ 0.0 };
+	double linkMilliseconds{ 0.0 };
+	bool fromCache{ false };
+};
 
 class ShaderProgram
 {
@@ -27,6 +32,11 @@ public:
 	ShaderProgram& operator=(ShaderProgram&&) noexcept = delete;
 
 	const std::string& linkLog() const noexcept { return m_linkLog; }
+	const ProgramStats& stats() const noexcept { return m_stats; }
+
+	// shown by debuggers through KHR_debug and used by reports, see ProgramReflection
+	const std::string& label() const noexcept { return m_label; }
+	void setLabel(std::string label);
 	[[nodiscard]] GLint uniformLoc(const std::string_view& name) const noexcept;
 	[[nodiscard]] GLint attribLoc(const std::string_view& name) const noexcept;
 	void setUniform(const std::string_view& name, GLint scalar);
@@ -39,37 +49,67 @@ public:
 	void setUniform(const std::string_view& name, const glm::mat3& mat);
 	void setUniform(const std::string_view& name, const glm::mat4& mat);
 	void setUniform(const std::string_view& name, const glm::ivec2& vec);
+	void setUniform(const std::string_view& name, const glm::ivec3& vec);
 	void setUniform(const std::string_view& name, const glm::vec2& vec);
 	void setUniform(const std::string_view& name, const glm::vec3& vec);
 	void setUniform(const std::string_view& name, const glm::vec4& vec);
 	void setUniformVec2(const std::string_view& name, const GLfloat* vec2);
 	void setUniformIVec2(const std::string_view& name, const GLint* ivec2);
+	void setUniformIVec3(const std::string_view& name, const GLint* ivec3);
 	void setUniformVec3(const std::string_view& name, const GLfloat* vec3);
 	void setUniformVec4(const std::string_view& name, const GLfloat* vec4);
 	void setUniformMat3(const std::string_view& name, const GLfloat* mat3x3);
 	void setUniformMat4(const std::string_view& name, const GLfloat* mat4x4);
 	void setUniform1Array(const std::string_view& name, const GLfloat* array, GLsizei count);
+	void setUniformVec4Array(const std::string_view& name, const GLfloat* array, GLsizei count);
 
 	GLuint nativeHandle() const noexcept { return m_program; }
+	// separable programs hold a single stage and are combined by ProgramPipeline
+	bool separable() const noexcept { return m_separable; }
 
 	void bind() noexcept;
 	void unbind() noexcept;
 
+	// exchanges the GL programs, every holder of this object sees the other program from now on
+	void swapProgram(ShaderProgram& other) noexcept;
+
 	void validateProgram();
 	std::vector<char> binary() const;
 
-	static std::shared_ptr<ShaderProgram> make(const std::filesystem::path& fragmentPath, const std::filesystem::path& vertexPath);
+	// binaries are reused through ShaderCache::instance(), see also ShaderCompileQueue for non-blocking builds
+	static std::shared_ptr<ShaderProgram> make(const std::filesystem::path& vertexPath, const std::filesystem::path& fragmentPath);
+	// separable program of one stage (GL_VERTEX_SHADER, GL_FRAGMENT_SHADER, ...), cached on its own
+	static std::shared_ptr<ShaderProgram> makeStage(GLenum stage, const std::filesystem::path& path, const std::vector<std::string>& defines = {});
 private:
+	friend class ShaderCache;
+	friend class ProgramBuild;
+	friend class ShaderHotReload;
+
 	constexpr static GLuint kInvalidId = (std::numeric_limits<GLuint>::max)();
 	
 	GLuint m_program{ kInvalidId };
 	std::string m_linkLog;
+	std::string m_label;
+	ProgramStats m_stats;
+	bool m_separable{ false };
 
 	mutable std::vector<std::pair<std::string, GLint>> m_uniformLocations;
 	mutable std::vector<std::pair<std::string, GLint>> m_attributeLocations;
 
 	[[nodiscard]] bool attachAndCompile(std::shared_ptr<VertexShader>, std::shared_ptr<FragmentShader>);
+	void submitLink(const ShaderBase& vs, const ShaderBase& fs);
+	void attach(const ShaderBase& shader);
+	void submitLink();
+	// must be called before linking or loading a binary
+	void makeSeparable();
+	bool isLinkComplete() const;
+	[[nodiscard]] bool finishLink();
 	bool trySetBinary(GLenum format, const void* binary, size_t length);
+	void applyLabel() noexcept;
+	// names and locations of the active attributes, built-ins excluded
+	std::vector<std::pair<std::string, GLint>> activeAttribLocations() const;
+	// must be called before linking
+	void bindAttribLocations(const std::vector<std::pair<std::string, GLint>>& locations);
 };
 
 }
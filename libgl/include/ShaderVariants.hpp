@@ -0,0 +1,60 @@
+#pragma once
+
+#include <ShaderCompileQueue.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace libgl
+{
+
+// bit i enables the i-th keyword of ShaderVariants
+using VariantKey = std::uint64_t;
+
+//
+// Permutations of a vertex/fragment pair driven by keyword defines.
+// A variant is compiled the first time it is requested (going through the binary cache),
+// so only combinations that are actually drawn ever reach the compiler.
+//
+class ShaderVariants
+{
+public:
+	static constexpr inline std::size_t kMaxKeywords = 64;
+
+	ShaderVariants(const std::filesystem::path& vertexPath, const std::filesystem::path& fragmentPath, std::vector<std::string> keywords);
+	ShaderVariants(const ShaderVariants&) = delete;
+	ShaderVariants& operator=(const ShaderVariants&) = delete;
+
+	// throws std::invalid_argument for keywords the set was not created with
+	VariantKey key(const std::vector<std::string_view>& enabledKeywords) const;
+
+	// compiles synchronously on the first use of the key
+	std::shared_ptr<ShaderProgram> get(VariantKey key);
+	// starts compiling on the queue, get() waits for the pending build
+	ProgramHandle request(VariantKey key, ShaderCompileQueue& queue);
+	// e.g. with usedKeys() recorded during a previous run of the same scene
+	void precompile(const std::vector<VariantKey>& keys, ShaderCompileQueue& queue);
+
+	std::vector<VariantKey> usedKeys() const;
+	const std::vector<std::string>& keywords() const noexcept { return m_keywords; }
+
+	// inserts `#define NAME 1` lines right after #version and restores line numbering with #line
+	static std::string injectDefines(const std::string& source, const std::vector<std::string>& defines);
+	// "name [DEFINE ...]", the label of a program built with `defines`
+	static std::string labelOf(std::string name, const std::vector<std::string>& defines);
+
+private:
+	std::vector<std::string> definesOf(VariantKey key) const;
+
+	std::string m_vertexSource;
+	std::string m_fragmentSource;
+	std::vector<std::string> m_keywords;
+	std::unordered_map<VariantKey, ProgramHandle> m_programs;
+};
+
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <MutableTexture.hpp>
+
+#include <map>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+namespace libgl
+{
+
+struct TextureArraySlot
+{
+	std::shared_ptr<MutableTexture> texture;
+	GLint layer;
+};
+
+//
+// Groups textures of the same device format, host layout and size into layers of 2D array textures,
+// so materials sharing a group are drawn with a single texture bind and a per-draw layer index.
+// Pixels are copied on add(), the source buffers may be released right after the call.
+//
+class TextureArrayPacker
+{
+public:
+	using ImageId = std::size_t;
+
+	// build() uploads here, so bindings of the units the renderer uses stay as they are
+	static constexpr inline GLuint kUploadUnit = 15;
+
+	ImageId add(TextureDeviceFormat format, GLsizei width, GLsizei height, const TextureData& data);
+
+	// creates the arrays (splitting groups exceeding GL_MAX_ARRAY_TEXTURE_LAYERS), uploads every layer
+	// and generates mipmaps when requested; the result is indexed by ImageId
+	std::vector<TextureArraySlot> build(bool generateMipmaps = true);
+
+	std::size_t imagesCount() const noexcept { return m_imagesCount; }
+	std::size_t groupsCount() const noexcept { return m_groups.size(); }
+
+private:
+	using GroupKey = std::tuple<TextureDeviceFormat, TextureHostFormat, TextureHostType, GLint, GLsizei, GLsizei>;
+
+	struct Group
+	{
+		std::size_t layerBytes;
+		std::vector<ImageId> images;
+		std::vector<std::uint8_t> pixels;
+	};
+
+	std::map<GroupKey, Group> m_groups;
+	std::size_t m_imagesCount{ 0 };
+};
+
+}
@@ -8,6 +8,11 @@ namespace libgl
 enum class TextureTarget
 {
 	TEXTURE_2D = GL_TEXTURE_2D,
+	TEXTURE_2D_ARRAY = GL_TEXTURE_2D_ARRAY,
+	TEXTURE_3D = GL_TEXTURE_3D,
+	TEXTURE_2D_MULTISAMPLE = GL_TEXTURE_2D_MULTISAMPLE,
+	// texels of a buffer object, see BufferTexture
+	TEXTURE_BUFFER = GL_TEXTURE_BUFFER,
 };
 
 enum class TextureDeviceFormat
@@ -24,25 +29,62 @@ enum class TextureDeviceFormat
 	RG16F = GL_RG16F,
 	RGB16F = GL_RGB16F,
 	RGBA16F = GL_RGBA16F,
+	// packed HDR color without alpha, half the bandwidth of RGBA16F
+	R11F_G11F_B10F = GL_R11F_G11F_B10F,
 	
 	R32F = GL_R32F,
 	RG32F = GL_RG32F,
 	RGB32F = GL_RGB32F,
 	RGBA32F = GL_RGBA32F,
+
+	// unnormalized integers, read with usampler* and texelFetch
+	R32UI = GL_R32UI,
+	RG32UI = GL_RG32UI,
+
+	BC1_RGBA = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT,
+	BC1_SRGB8_ALPHA = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT,
+	BC7_RGBA = GL_COMPRESSED_RGBA_BPTC_UNORM,
+	BC7_SRGB8_ALPHA = GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM,
+
+	DEPTH_COMPONENT16 = GL_DEPTH_COMPONENT16,
+	DEPTH_COMPONENT24 = GL_DEPTH_COMPONENT24,
+	DEPTH_COMPONENT32F = GL_DEPTH_COMPONENT32F,
+	DEPTH24_STENCIL8 = GL_DEPTH24_STENCIL8,
+	DEPTH32F_STENCIL8 = GL_DEPTH32F_STENCIL8,
+	// renderbuffers only before OpenGL 4.4
+	STENCIL_INDEX8 = GL_STENCIL_INDEX8,
 };
 
+bool isDepthFormat(TextureDeviceFormat format) noexcept;
+bool isStencilFormat(TextureDeviceFormat format) noexcept;
+
 enum class TextureHostFormat
 {
 	RED = GL_RED,
 	RG = GL_RG,
 	RGB = GL_RGB,
-	RGBA = GL_RGBA
+	RGBA = GL_RGBA,
+	RED_INTEGER = GL_RED_INTEGER,
+	RG_INTEGER = GL_RG_INTEGER,
+	DEPTH_COMPONENT = GL_DEPTH_COMPONENT,
+	DEPTH_STENCIL = GL_DEPTH_STENCIL,
 };
 
 enum class TextureHostType
 {
 	UNSIGNED_BYTE = GL_UNSIGNED_BYTE,
 	FLOAT = GL_FLOAT,
+	UNSIGNED_INT = GL_UNSIGNED_INT,
+	UNSIGNED_INT_24_8 = GL_UNSIGNED_INT_24_8,
+	FLOAT_32_UNSIGNED_INT_24_8_REV = GL_FLOAT_32_UNSIGNED_INT_24_8_REV,
+};
+
+// access of a texture bound as an image, see TextureBase::bindImage()
+enum class ImageAccess
+{
+	READ_ONLY = GL_READ_ONLY,
+	WRITE_ONLY = GL_WRITE_ONLY,
+	READ_WRITE = GL_READ_WRITE,
 };
 
 struct TextureData
@@ -53,6 +95,12 @@ struct TextureData
 	const void* data;
 };
 
+struct CompressedTextureData
+{
+	GLsizei size;
+	const void* data;
+};
+
 class TextureBase
 {
 public:
@@ -69,14 +117,28 @@ public:
 
 	void bind(GLuint slot);
 	void unbind(GLuint slot);
+
+	// OpenGL 4.3 image load/store of one mip level, arrays and 3D textures are bound with every layer;
+	// sRGB, compressed and 3-channel formats can't be used as images and throw std::invalid_argument
+	void bindImage(GLuint unit, ImageAccess access, GLint level = 0);
+	static void unbindImage(GLuint unit);
 	TextureTarget target() const noexcept { return m_target; }
 	TextureDeviceFormat deviceFormat() const noexcept { return m_deviceFormat; }
 	GLsizei width() const noexcept { return m_width; }
 	GLsizei height() const noexcept { return m_height; }
 	GLsizei depth() const noexcept { return m_depth; }
+	// 0 for single-sampled targets
+	GLsizei samples() const noexcept { return m_samples; }
 	GLuint nativeHandle() const noexcept { return m_texture; }
 	bool hasMipmaps() const noexcept { return m_hasMipMaps; }
 
+	// mip levels are assumed to form a full chain down to 1x1 when hasMipmaps() is set
+	GLint levelsCount() const noexcept;
+	// estimated device memory, drivers may add padding and alignment on top
+	std::size_t memoryUsage() const noexcept;
+
+	static std::size_t levelBytes(TextureDeviceFormat format, GLsizei width, GLsizei height, GLsizei depth = 1) noexcept;
+
 	void setHasMipmaps(bool value) noexcept { m_hasMipMaps = value; }
 
 protected:
@@ -89,6 +151,7 @@ protected:
 	GLsizei m_width;
 	GLsizei m_height;
 	GLsizei m_depth{ 1 };
+	GLsizei m_samples{ 0 };
 	GLuint m_texture = kEmptyHandle;
 	bool m_hasMipMaps{ false };
 };
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <MutableTexture.hpp>
+
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <vector>
+
+namespace libgl
+{
+
+struct TextureLoadOptions
+{
+	bool srgb{ true };
+	// the largest levels are not kept, the resulting image is (width >> skipLevels) x (height >> skipLevels)
+	GLint skipLevels{ 0 };
+};
+
+//
+// Host side copy of a 2D texture with its mip chain, levels[0] is the largest one.
+//
+struct TextureImage
+{
+	TextureDeviceFormat format;
+	bool compressed;
+	GLsizei width;
+	GLsizei height;
+	GLint skippedLevels;
+	std::vector<std::vector<std::uint8_t>> levels;
+};
+
+//
+// Decoding never touches the GL state and may run on any thread, uploading must happen on the GL thread.
+// PNG/JPEG images get a CPU mip chain built in linear space, KTX2 files baked by texbake are used as is.
+//
+class TextureLoader
+{
+public:
+	static TextureImage decode(const std::filesystem::path& path, const TextureLoadOptions& options = {});
+	static std::future<TextureImage> decodeAsync(std::filesystem::path path, TextureLoadOptions options = {});
+
+	// checks the stored format of a KTX2 file without reading the payload, other images are always supported
+	static bool isSupported(const std::filesystem::path& path);
+
+	// returns an empty pointer when the device cannot sample the image format
+	static std::shared_ptr<MutableTexture> upload(const TextureImage& image);
+};
+
+}
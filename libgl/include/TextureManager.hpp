@@ -0,0 +1,70 @@
+#pragma once
+
+#include <TextureLoader.hpp>
+
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <vector>
+
+namespace libgl
+{
+
+//
+// Keeps the estimated device memory of managed textures under a budget.
+// Textures not used during the current frame are trimmed in LRU order: the top mip level is dropped first
+// (while the device can copy images and the texture stays above kMinResidentSize), then the texture is evicted.
+// Evicted and trimmed textures are reloaded through TextureLoader::decodeAsync the next time they are acquired.
+// All methods must be called on the GL thread.
+//
+class TextureManager
+{
+public:
+	using TextureId = std::size_t;
+
+	static constexpr inline GLsizei kMinResidentSize = 64;
+	// trimming binds textures here so the units the renderer tracks keep their bindings
+	static constexpr inline GLuint kScratchUnit = 15;
+
+	explicit TextureManager(std::size_t budgetBytes);
+
+	TextureManager(const TextureManager&) = delete;
+	TextureManager& operator=(const TextureManager&) = delete;
+
+	TextureId add(std::filesystem::path path, TextureLoadOptions options = {});
+
+	// marks the texture as used in the current frame, returns an empty pointer until the first load finishes
+	std::shared_ptr<MutableTexture> acquire(TextureId id);
+
+	// call once per frame: uploads finished loads, enforces the budget and starts a new frame
+	void update();
+
+	void setBudget(std::size_t budgetBytes) noexcept { m_budget = budgetBytes; }
+	std::size_t budget() const noexcept { return m_budget; }
+	std::size_t residentBytes() const noexcept { return m_residentBytes; }
+
+private:
+	struct Entry
+	{
+		std::filesystem::path path;
+		TextureLoadOptions options;
+		std::shared_ptr<MutableTexture> texture;
+		std::size_t bytes{ 0 };
+		// levels missing on top of options.skipLevels, 0 once the texture is complete
+		GLint droppedLevels{ 0 };
+		std::uint64_t lastUsedFrame{ 0 };
+		std::future<TextureImage> pending;
+	};
+
+	void requestLoad(Entry& entry, GLint skipLevels);
+	void setTexture(Entry& entry, std::shared_ptr<MutableTexture> texture, GLint droppedLevels);
+	bool dropTopLevel(Entry& entry);
+	void enforceBudget();
+
+	std::vector<Entry> m_entries;
+	std::size_t m_budget;
+	std::size_t m_residentBytes{ 0 };
+	std::uint64_t m_frame{ 1 };
+};
+
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <opengl.hpp>
+
+#include <string>
+
+namespace libgl
+{
+
+namespace detail
+{
+
+// glGetString returns null on error, callers get an empty string instead
+inline std::string getGlString(GLenum name)
+{
+	const auto* value = reinterpret_cast<const char*>(glGetString(name));
+	checkGl();
+
+	return value ? value : "";
+}
+
+}
+
+}
@@ -1,8 +1,13 @@
 #include <Application.hpp>
+#include <ProgramReflection.hpp>
+#include <ShaderCache.hpp>
+#include <ShaderPreprocessor.hpp>
 
-#include <stb/stb_image.h>
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <fstream>
+#include <random>
 
 namespace libgl
 {
@@ -15,6 +20,17 @@ static constexpr bool kMacOS = false;
 
 static constexpr int kWidth = 1366;
 static constexpr int kHeight = 768;
+static constexpr std::size_t kTextureBudget = 256 * 1024 * 1024;
+// 47^3 cubes, the odd count keeps one of them at the origin
+static constexpr int kFieldSize = 47;
+static constexpr float kFieldSpacing = 3.0f;
+static constexpr float kPointLightRadius = kFieldSpacing * 2.5f;
+static constexpr float kPointLightIntensity = 4.0f;
+static constexpr std::size_t kMaterialsCount = 4;
+static constexpr GLsizei kMaskSize = 128;
+static constexpr GLuint kMaskUnit = 8;
+// world space, toward the light
+static const glm::vec3 kLightDirection = glm::normalize(glm::vec3(1.0f, 2.0f, 1.0f));
 
 static Application* g_appInstance{ nullptr };
 
@@ -62,6 +78,40 @@ static const char* getDebugSeverity(GLenum severity)
 }
 #endif // !NDEBUG
 
+static void sortFrontToBack(std::vector<CullObject>& objects, const glm::vec3& eye)
+{
+	std::stable_sort(objects.begin(), objects.end(), [&](const CullObject& a, const CullObject& b)
+	{
+		return glm::distance(glm::vec3(a.boundingSphere), eye) - a.boundingSphere.w <
+			glm::distance(glm::vec3(b.boundingSphere), eye) - b.boundingSphere.w;
+	});
+}
+
+// hole cut in every face of a cube: a circle, a square, a diamond or none at all
+static std::vector<std::uint8_t> makeMaskPattern(std::size_t material, GLsizei size)
+{
+	std::vector<std::uint8_t> result(std::size_t(size) * size);
+	for (GLsizei y = 0; y < size; ++y)
+	{
+		for (GLsizei x = 0; x < size; ++x)
+		{
+			const auto u = std::abs((x + 0.5f) / size * 2.0f - 1.0f);
+			const auto v = std::abs((y + 0.5f) / size * 2.0f - 1.0f);
+
+			bool hole = false;
+			switch (material % kMaterialsCount)
+			{
+			case 0: hole = u * u + v * v < 1.0f; break;
+			case 1: hole = (std::max)(u, v) < 0.75f; break;
+			case 2: hole = u + v < 1.0f; break;
+			default: break;
+			}
+			result[std::size_t(y) * size + x] = hole ? 0 : 255;
+		}
+	}
+	return result;
+}
+
 static auto createAppWindow()
 {
 	if (!glfwInit())
@@ -87,10 +137,11 @@ static auto createAppWindow()
 	glfwWindowHint(GLFW_GREEN_BITS, 8);
 	glfwWindowHint(GLFW_BLUE_BITS, 8);
 	glfwWindowHint(GLFW_ALPHA_BITS, 8);
-	glfwWindowHint(GLFW_DEPTH_BITS, 24);
+	// the scene is drawn into multisampled targets and resolved, the window only receives the final image
+	glfwWindowHint(GLFW_DEPTH_BITS, 0);
 	glfwWindowHint(GLFW_DOUBLEBUFFER, GLFW_TRUE);
 	glfwWindowHint(GLFW_SRGB_CAPABLE, GLFW_TRUE);
-	glfwWindowHint(GLFW_SAMPLES, 8);
+	glfwWindowHint(GLFW_SAMPLES, 0);
 
 
 	if (auto window = glfwCreateWindow(kWidth, kHeight, "glsandbox", nullptr, nullptr))
@@ -149,115 +200,213 @@ static auto createAppWindow()
 	throw std::runtime_error("glfw failed to create a window");
 }
 
-static MutableTexture loadImage(const std::filesystem::path& path)
-{
-	const auto rawData = Application::fetchContent(path);
-
-	int width;
-	int height;
-	int channels;
-	auto data = stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(rawData.data()), static_cast<int>(rawData.size()), &width, &height, &channels, 0);
-
-	if (data == nullptr)
-	{
-		throw std::system_error(std::make_error_code(std::errc::no_such_file_or_directory), path.string());
-	}
-
-	TextureData hostData;
-	hostData.data = data;
-	hostData.rowAlignment = 1;
-	hostData.type = TextureHostType::UNSIGNED_BYTE;
-	switch (channels)
-	{
-	case 1: hostData.format = TextureHostFormat::RED; break;
-	case 2: hostData.format = TextureHostFormat::RG; break;
-	case 3: hostData.format = TextureHostFormat::RGB; break;
-	case 4: hostData.format = TextureHostFormat::RGBA; break;
-	default: assert(false);
-	}
-
-	try
-	{
-		MutableTexture texture = MutableTexture::make2D(width, height, TextureDeviceFormat::SRGB8_ALPHA8);
-		texture.bind(0);
-		texture.load(hostData);
-		stbi_image_free(data);
-		return texture;
-	}
-	catch (...)
-	{
-		stbi_image_free(data);
-		throw;
-	}
-}
-
 Application::Application(const std::filesystem::path& projectDir) 
 	: m_projectDir(projectDir)
 	, m_window(createAppWindow())
+	, m_samples(kDefaultSamples)
 {
 	g_appInstance = this;
 
-	m_program = ShaderProgram::make(m_projectDir / "assets/shaders/blit1.vs.glsl", m_projectDir / "assets/shaders/blit1.fs.glsl");
+	// cached programs are loaded on a shared context while the rest of the state is set up
+	ShaderCache::instance().beginPrewarm(m_window.get());
 
 	glEnable(GL_FRAMEBUFFER_SRGB);
 	glEnable(GL_DEPTH_TEST);
 	glClearColor(0.1f, 0.1f, 0.3f, 1.0f);
 	glDisable(GL_CULL_FACE);
-	glEnable(GL_SAMPLE_ALPHA_TO_COVERAGE);
-
-	glEnable(GL_SAMPLE_SHADING);
-	glMinSampleShading(8);
 	checkGl();
 
 
+	ShaderPreprocessor::instance().addIncludeDirectory(m_projectDir / "assets/shaders");
+
+	// buffers are filled now, attributes are pointed at them once the programs exist
 	m_vao = std::make_shared<VertexArrayObject>();
 	m_vao->bind();
 
 	auto cube = Mesh::cube();
 
 	m_meshData = std::make_shared<BufferData>();
-	
 	m_meshData->positions.setData(BufferUsage::STATIC_DRAW, cube.positions());
-	m_vao->setVertexAttribute(m_program->attribLoc("A_POSITION_0"), VertexAttribute::make<glm::vec3>());
-
 	m_meshData->normals.setData(BufferUsage::STATIC_DRAW, cube.normals());
-	m_vao->setVertexAttribute(m_program->attribLoc("A_NORMAL_0"), VertexAttribute::make<glm::vec3>());
-
 	m_meshData->texCoords0.setData(BufferUsage::STATIC_DRAW, cube.texCoords0());
-	m_vao->setVertexAttribute(m_program->attribLoc("A_TEX_COORD_0"), VertexAttribute::make<glm::vec2>());
-
 	m_meshData->indices.setData(BufferUsage::STATIC_DRAW, cube.triangles());
 	m_meshData->indicesCount = cube.triangles().size();
 
-	m_texture = std::make_shared<MutableTexture>(loadImage(m_projectDir / "assets/png/grid.png"));
-	m_texture->generateMipmap();
-	glTexParameteri((GLenum)m_texture->target(), GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glTexParameteri((GLenum)m_texture->target(), GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-	glTexParameteri((GLenum)m_texture->target(), GL_TEXTURE_MAX_ANISOTROPY, 16);
+	// equal size and format, so the packer puts every mask into the same array
+	TextureArrayPacker masksPacker;
+	for (std::size_t material = 0; material < kMaterialsCount; ++material)
+	{
+		const auto pattern = makeMaskPattern(material, kMaskSize);
+		masksPacker.add(TextureDeviceFormat::R8, kMaskSize, kMaskSize, { TextureHostFormat::RED, TextureHostType::UNSIGNED_BYTE, 1, pattern.data() });
+	}
+	const auto maskSlots = masksPacker.build();
+	m_masks = maskSlots.front().texture;
+
+	if (GpuCulling::isSupported())
+	{
+		std::vector<glm::vec4> instances;
+		std::vector<glm::vec1> materials;
+		std::vector<CullObject> objects;
+		for (int z = 0; z < kFieldSize; ++z)
+		{
+			for (int y = 0; y < kFieldSize; ++y)
+			{
+				for (int x = 0; x < kFieldSize; ++x)
+				{
+					const auto center = (glm::vec3(x, y, z) - glm::vec3(kFieldSize / 2)) * kFieldSpacing;
+
+					CullObject object;
+					object.boundingSphere = glm::vec4(center, glm::length(glm::vec3(0.5f)));
+					object.indexCount = GLuint(m_meshData->indicesCount * 3);
+					object.firstIndex = 0;
+					object.baseVertex = 0;
+					object.baseInstance = GLuint(instances.size());
+
+					instances.emplace_back(center, 1.0f);
+					materials.emplace_back(GLfloat(maskSlots[(x + y + z) % kMaterialsCount].layer));
+					objects.push_back(object);
+				}
+			}
+		}
+
+		m_meshData->instances.setData(BufferUsage::STATIC_DRAW, instances);
+		m_meshData->materials.setData(BufferUsage::STATIC_DRAW, materials);
+
+		sortFrontToBack(objects, m_sortEye);
+		m_cullObjects = std::move(objects);
+		m_culling = std::make_shared<GpuCulling>(m_projectDir / "assets/shaders");
+		m_culling->setObjects(m_cullObjects);
+	}
+
+	// textures baked by texbake are preferred, blit1.fs.glsl works with straight alpha
+	auto texturePath = m_projectDir / "assets/ktx2/grid.ktx2";
+	if (!std::filesystem::exists(texturePath) || !TextureLoader::isSupported(texturePath))
+	{
+		texturePath = m_projectDir / "assets/png/grid.png";
+	}
+
+	m_textures = std::make_shared<TextureManager>(kTextureBudget);
+	m_samplers = std::make_shared<SamplerCache>();
+	m_gridTexture = m_textures->add(texturePath);
+
+	m_lighting = std::make_shared<ClusteredLighting>();
+	setPointLightsCount(kDefaultPointLights);
+	// the cube field never moves, so nothing calls invalidate() and cascades are only redrawn when their fit changes
+	m_shadows = std::make_shared<CascadedShadowMaps>();
+
+	// targets outlive two resolution changes, so stepping back to a previous scale reuses them
+	m_renderTargets = std::make_shared<RenderTargetPool>(DynamicResolutionSettings{}.cooldownFrames * 2);
+	m_renderGraph = std::make_shared<RenderGraph>(m_renderTargets);
+	m_postProcess = std::make_shared<PostProcessStack>(m_projectDir / "assets/shaders");
+	m_gpuTimer = std::make_shared<GpuTimer>();
+	m_dynamicResolution = std::make_shared<DynamicResolution>();
+
+	// the setup above gave the worker its time, the variants below are the first programs it may have loaded
+	std::cout << "Prewarmed shader programs: " << ShaderCache::instance().finishPrewarm() << '\n';
+	m_blitVariants = std::make_shared<ShaderVariants>(
+		m_projectDir / "assets/shaders/blit1.vs.glsl",
+		m_projectDir / "assets/shaders/blit1.fs.glsl",
+		std::vector<std::string>{ "ALPHA_MASK", "CLUSTERED_LIGHTING", "SHADOWS" });
+	m_program = m_blitVariants->get(m_blitVariants->key({ "ALPHA_MASK", "CLUSTERED_LIGHTING", "SHADOWS" }));
+	m_program->setLabel("blit1 [ALPHA_MASK CLUSTERED_LIGHTING SHADOWS]");
+
+	m_shaderHotReload = std::make_shared<ShaderHotReload>(m_window.get(), m_projectDir / "assets/shaders");
+	m_shaderHotReload->track(m_program,
+		m_projectDir / "assets/shaders/blit1.vs.glsl",
+		m_projectDir / "assets/shaders/blit1.fs.glsl",
+		{ "ALPHA_MASK", "CLUSTERED_LIGHTING", "SHADOWS" });
+
+	m_depthVariants = std::make_shared<ShaderVariants>(
+		m_projectDir / "assets/shaders/depth_prepass.vs.glsl",
+		m_projectDir / "assets/shaders/depth_prepass.fs.glsl",
+		std::vector<std::string>{ "ALPHA_MASK" });
+	m_depthProgram = m_depthVariants->get(m_depthVariants->key({ "ALPHA_MASK" }));
+	m_depthProgram->setLabel("depth_prepass [ALPHA_MASK]");
+	m_shaderHotReload->track(m_depthProgram,
+		m_projectDir / "assets/shaders/depth_prepass.vs.glsl",
+		m_projectDir / "assets/shaders/depth_prepass.fs.glsl",
+		{ "ALPHA_MASK" });
+
+	auto instanceAttribute = VertexAttribute::make<glm::vec4>();
+	instanceAttribute.divisor = 1;
+	auto materialAttribute = VertexAttribute::make<glm::vec1>();
+	materialAttribute.divisor = 1;
+
+	m_vao->bind();
+	m_meshData->positions.bind();
+	m_vao->setVertexAttribute(m_program->attribLoc("A_POSITION_0"), VertexAttribute::make<glm::vec3>());
+	m_meshData->normals.bind();
+	m_vao->setVertexAttribute(m_program->attribLoc("A_NORMAL_0"), VertexAttribute::make<glm::vec3>());
+	m_meshData->texCoords0.bind();
+	m_vao->setVertexAttribute(m_program->attribLoc("A_TEX_COORD_0"), VertexAttribute::make<glm::vec2>());
+	if (m_culling)
+	{
+		m_meshData->instances.bind();
+		m_vao->setVertexAttribute(m_program->attribLoc("A_INSTANCE_0"), instanceAttribute);
+		m_meshData->materials.bind();
+		m_vao->setVertexAttribute(m_program->attribLoc("A_MATERIAL_0"), materialAttribute);
+	}
+	m_meshData->indices.bind();
+
+	// the same buffers without normals, texture coordinates are only fetched for the alpha test
+	m_depthVao = std::make_shared<VertexArrayObject>();
+	m_depthVao->bind();
+	m_meshData->positions.bind();
+	m_depthVao->setVertexAttribute(m_depthProgram->attribLoc("A_POSITION_0"), VertexAttribute::make<glm::vec3>());
+	m_meshData->texCoords0.bind();
+	m_depthVao->setVertexAttribute(m_depthProgram->attribLoc("A_TEX_COORD_0"), VertexAttribute::make<glm::vec2>());
+	if (m_culling)
+	{
+		m_meshData->instances.bind();
+		m_depthVao->setVertexAttribute(m_depthProgram->attribLoc("A_INSTANCE_0"), instanceAttribute);
+		m_meshData->materials.bind();
+		m_depthVao->setVertexAttribute(m_depthProgram->attribLoc("A_MATERIAL_0"), materialAttribute);
+	}
+	m_meshData->indices.bind();
 
 	std::pair<int, int> winDim;
 	glfwGetWindowSize(m_window.get(), &winDim.first, &winDim.second);
 	resize(winDim.first, winDim.second);
 }
 
+Application::~Application()
+{
+	// prewarmed programs nobody asked for are deleted while the context is still alive
+	ShaderCache::instance().releasePrewarmed();
+}
+
 void Application::run()
 {
 	m_program->bind();
 	m_vao->bind();
 	m_meshData->indices.bind();
 	
-	m_texture->bind(0);
-	m_program->setUniform("U_SAMPLER_0", 0);
-	m_program->setUniform("U_LIGHT_DIR_0", glm::normalize(glm::vec3(1.0f, 0.0f, 1.0f)));
+	SamplerDesc trilinear;
+	trilinear.maxAnisotropy = 16.0f;
+	m_samplers->bind(0, trilinear);
+
+	SamplerDesc maskSampler;
+	maskSampler.wrapS = TextureWrap::CLAMP_TO_EDGE;
+	maskSampler.wrapT = TextureWrap::CLAMP_TO_EDGE;
+	m_samplers->bind(kMaskUnit, maskSampler);
+	m_masks->bind(kMaskUnit);
+	setStaticUniforms();
 
 	m_program->validateProgram();
 
 	const auto startTime = std::chrono::high_resolution_clock::now();
 
+	// keeps the previous texture bound while a reload is in flight
+	std::shared_ptr<MutableTexture> boundTexture;
+
 	while (!glfwWindowShouldClose(m_window.get()))
 	{
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-		checkGl();
+		if (m_windowSize.x == 0 || m_windowSize.y == 0)
+		{
+			// minimized, render targets can't be empty
+			glfwWaitEvents();
+			continue;
+		}
 
 		const auto timeSec 
 			= std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - startTime).count() / 1e6f;
@@ -268,23 +417,271 @@ void Application::run()
 		viewMat = glm::rotate(viewMat, timeSec * 0.25f, glm::vec3(0.0f, 1.0f, 0.0f));
 		viewMat = glm::rotate(viewMat, timeSec * 0.25f, glm::vec3(0.0f, 0.0f, 1.0f));
 
-		m_program->setUniform("U_PROJECTION_TRANSFORM", m_projMatrix);
-		m_program->setUniform("U_VIEW_TRANSFORM", viewMat);
+		// the camera rarely travels far enough to change the order, and then the objects are uploaded again
+		if (const auto eye = glm::vec3(glm::inverse(viewMat)[3]); m_culling && glm::distance(eye, m_sortEye) > kFieldSpacing)
+		{
+			m_sortEye = eye;
+			sortFrontToBack(m_cullObjects, m_sortEye);
+			m_culling->setObjects(m_cullObjects);
+		}
 
-		glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(m_meshData->indicesCount * 3), GL_UNSIGNED_SHORT, 0);
-		checkGl();
+		if (auto texture = m_textures->acquire(m_gridTexture); texture && texture != boundTexture)
+		{
+			texture->bind(0);
+			boundTexture = std::move(texture);
+		}
+
+		auto renderSize = m_windowSize;
+		if (m_dynamicResolution)
+		{
+			if (const auto gpuTime = m_gpuTimer->takeMilliseconds())
+			{
+				m_dynamicResolution->update(*gpuTime);
+			}
+			renderSize = m_dynamicResolution->renderSize(m_windowSize);
+		}
+
+		m_lighting->update(viewMat, m_projMatrix);
+		m_shadows->update(viewMat, m_projMatrix, kLightDirection);
+
+		m_renderGraph->reset();
+		m_renderGraph->setBackBufferSize(m_windowSize.x, m_windowSize.y);
+
+		// linear HDR, alpha only feeds alpha-to-coverage and doesn't need storage
+		m_renderGraph->createTarget("sceneColor", { TextureDeviceFormat::R11F_G11F_B10F, renderSize.x, renderSize.y, m_samples });
+		m_renderGraph->createTarget("sceneDepth", { TextureDeviceFormat::DEPTH_COMPONENT24, renderSize.x, renderSize.y, m_samples });
+
+		// the objects culled last, or the only cube without GPU culling
+		const auto drawScene = [this]()
+		{
+			if (m_culling)
+			{
+				m_culling->draw(GL_UNSIGNED_SHORT);
+			}
+			else
+			{
+				glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(m_meshData->indicesCount * 3), GL_UNSIGNED_SHORT, 0);
+				checkGl();
+			}
+		};
+
+		m_renderGraph->importTexture("shadowMap", m_shadows->texture());
+		m_renderGraph->addPass("shadows", [&](const RenderGraph::PassContext&)
+		{
+			// most frames find every cascade cached and draw nothing
+			m_shadows->render([&](const glm::mat4& lightViewProjection)
+			{
+				if (m_culling)
+				{
+					m_culling->cull(lightViewProjection, false);
+				}
+
+				m_depthProgram->bind();
+				m_depthProgram->setUniform("U_PROJECTION_TRANSFORM", lightViewProjection);
+				m_depthProgram->setUniform("U_VIEW_TRANSFORM", glm::identity<glm::mat4>());
+				m_depthVao->bind();
+				drawScene();
+			});
+		}).write("shadowMap");
+
+		m_renderGraph->addPass("scene", [&](const RenderGraph::PassContext& context)
+		{
+			context.bindFrameBuffer();
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			checkGl();
+
+			if (m_culling)
+			{
+				m_culling->cull(m_projMatrix * viewMat);
+			}
+
+			if (m_depthPrepass)
+			{
+				m_depthProgram->bind();
+				m_depthProgram->setUniform("U_PROJECTION_TRANSFORM", m_projMatrix);
+				m_depthProgram->setUniform("U_VIEW_TRANSFORM", viewMat);
+				m_depthVao->bind();
+
+				glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+				checkGl();
+				drawScene();
+
+				// only samples that passed the alpha test above are shaded, alpha-to-coverage has nothing left to do
+				glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+				glDepthFunc(GL_EQUAL);
+				glDepthMask(GL_FALSE);
+				checkGl();
+			}
+			else
+			{
+				glEnable(GL_SAMPLE_ALPHA_TO_COVERAGE);
+				checkGl();
+			}
+
+			// post-processing passes draw with their own program and vertex array
+			m_program->bind();
+			m_vao->bind();
+
+			// per-sample shading only where it is asked for, multisampling alone shades once per pixel
+			const bool sampleShading = m_samples > 0 && m_minSampleShading > 0.0f;
+			if (sampleShading)
+			{
+				glEnable(GL_SAMPLE_SHADING);
+				glMinSampleShading(m_minSampleShading);
+				checkGl();
+			}
+
+			m_program->setUniform("U_PROJECTION_TRANSFORM", m_projMatrix);
+			m_program->setUniform("U_VIEW_TRANSFORM", viewMat);
+			m_program->setUniform("U_LIGHT_DIR_0", glm::mat3(viewMat) * kLightDirection);
+			m_lighting->bind(*m_program, renderSize);
+			m_shadows->bind(*m_program, viewMat);
+			drawScene();
+
+			if (sampleShading)
+			{
+				glDisable(GL_SAMPLE_SHADING);
+				checkGl();
+			}
+
+			if (m_depthPrepass)
+			{
+				glDepthFunc(GL_LESS);
+				glDepthMask(GL_TRUE);
+			}
+			else
+			{
+				glDisable(GL_SAMPLE_ALPHA_TO_COVERAGE);
+			}
+			checkGl();
+		}).read("shadowMap").write("sceneColor").write("sceneDepth");
+
+		if (m_culling)
+		{
+			// the occlusion test of the next frame's cull()
+			m_renderGraph->addPass("hiz", [&](const RenderGraph::PassContext& context)
+			{
+				m_culling->buildHiZ(context.texture("sceneDepth"), m_projMatrix * viewMat);
+			}).read("sceneDepth").setSideEffects();
+		}
+
+		std::string postSource = "sceneColor";
+		if (m_samples > 0)
+		{
+			m_renderGraph->createTarget("sceneResolved", { TextureDeviceFormat::R11F_G11F_B10F, renderSize.x, renderSize.y });
+			m_renderGraph->addPass("resolve", [](const RenderGraph::PassContext& context)
+			{
+				context.resolve("sceneColor");
+			}).read("sceneColor").write("sceneResolved");
+			postSource = "sceneResolved";
+		}
+
+		m_postProcess->addPasses(*m_renderGraph, postSource, renderSize.x, renderSize.y);
+
+		m_gpuTimer->begin();
+		m_renderGraph->execute();
+		m_gpuTimer->end();
 
 		glfwSwapBuffers(m_window.get());
 		glfwPollEvents();
+
+		m_textures->update();
+		m_renderTargets->nextFrame();
+
+		if (m_shaderHotReload->update())
+		{
+			m_program->bind();
+			setStaticUniforms();
+		}
 	}
 }
 
-void Application::resize(int x, int y)
+void Application::writeShaderReport(const std::filesystem::path& path) const
 {
-	glViewport(0, 0, x, y);
-	checkGl();
+	std::vector<const ShaderProgram*> programs = { m_program.get(), m_depthProgram.get() };
+	if (m_culling)
+	{
+		const auto culling = m_culling->programs();
+		programs.insert(programs.end(), culling.begin(), culling.end());
+	}
+	const auto postProcess = m_postProcess->programs();
+	programs.insert(programs.end(), postProcess.begin(), postProcess.end());
+
+	std::ofstream stream(path);
+	ProgramReflection::writeJson(stream, programs);
+	if (stream.flush().fail())
+	{
+		throw std::system_error(std::make_error_code(std::errc::io_error), path.string());
+	}
+}
+
+void Application::setMultisampling(GLsizei samples, float minSampleShading)
+{
+	if (samples < 0 || minSampleShading < 0.0f || minSampleShading > 1.0f)
+	{
+		throw std::invalid_argument("invalid multisampling settings");
+	}
+
+	m_samples = samples;
+	m_minSampleShading = minSampleShading;
+}
+
+void Application::setFrameBudget(float milliseconds)
+{
+	if (milliseconds < 0.0f)
+	{
+		throw std::invalid_argument("negative frame budget");
+	}
+
+	if (milliseconds == 0.0f)
+	{
+		m_dynamicResolution.reset();
+		return;
+	}
+
+	DynamicResolutionSettings settings;
+	settings.targetMilliseconds = milliseconds;
+	m_dynamicResolution = std::make_shared<DynamicResolution>(settings);
+}
+
+void Application::setPointLightsCount(std::size_t count)
+{
+	std::mt19937 random;
+	const auto extent = kFieldSize / 2 * kFieldSpacing;
+	std::uniform_real_distribution<float> position(-extent, extent);
+	std::uniform_real_distribution<float> channel(0.0f, 1.0f);
+
+	std::vector<PointLight> lights(count);
+	for (auto& light : lights)
+	{
+		light.position = glm::vec3(position(random), position(random), position(random));
+		light.radius = kPointLightRadius;
+		const auto color = glm::vec3(channel(random), channel(random), channel(random));
+		light.color = color / (std::max)({ color.x, color.y, color.z, 1e-3f }) * kPointLightIntensity;
+	}
+
+	m_lighting->setLights(std::move(lights));
+}
 
+void Application::setStaticUniforms()
+{
+	m_program->setUniform("U_SAMPLER_0", 0);
+	m_program->setUniform("U_MASKS", GLint(kMaskUnit));
+	m_depthProgram->setUniform("U_SAMPLER_0", 0);
+	m_depthProgram->setUniform("U_MASKS", GLint(kMaskUnit));
+}
+
+void Application::resize(int x, int y)
+{
+	// the render graph sets viewports per pass
+	m_windowSize = glm::ivec2(x, y);
 	m_projMatrix = glm::perspective(glm::radians(60.0f), float(x) / y, 0.01f, 100.0f);
+
+	// the pyramid of the old size and projection would reject objects it never saw
+	if (m_culling)
+	{
+		m_culling->resetHiZ();
+	}
 }
 
 std::vector<std::uint8_t> Application::fetchContent(const std::filesystem::path& path)
@@ -32,4 +32,38 @@ void BufferObjectBase::unbind()
 	checkGl();
 }
 
+void BufferObjectBase::bind(BufferTarget target)
+{
+	glBindBuffer(static_cast<GLenum>(target), m_buffer);
+	checkGl();
+}
+
+void BufferObjectBase::bindBase(GLuint index)
+{
+	bindBase(m_target, index);
+}
+
+void BufferObjectBase::bindBase(BufferTarget target, GLuint index)
+{
+	assert(target == BufferTarget::UNIFORM_BUFFER || target == BufferTarget::SHADER_STORAGE_BUFFER);
+
+	glBindBufferBase(static_cast<GLenum>(target), index, m_buffer);
+	checkGl();
+}
+
+void BufferObjectBase::bindRange(GLuint index, GLintptr byteOffset, GLsizeiptr bytesCount)
+{
+	assert(m_target == BufferTarget::UNIFORM_BUFFER || m_target == BufferTarget::SHADER_STORAGE_BUFFER);
+
+	glBindBufferRange(static_cast<GLenum>(m_target), index, m_buffer, byteOffset, bytesCount);
+	checkGl();
+}
+
+void BufferObjectBase::clear()
+{
+	bind();
+	glClearBufferData(static_cast<GLenum>(m_target), GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+	checkGl();
+}
+
 }
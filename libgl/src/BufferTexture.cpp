@@ -0,0 +1,50 @@
+#include <BufferTexture.hpp>
+
+namespace libgl
+{
+
+BufferTexture BufferTexture::make(TextureDeviceFormat format)
+{
+	switch (format)
+	{
+	case TextureDeviceFormat::R8:
+	case TextureDeviceFormat::RG8:
+	case TextureDeviceFormat::RGBA8:
+	case TextureDeviceFormat::R16F:
+	case TextureDeviceFormat::RG16F:
+	case TextureDeviceFormat::RGBA16F:
+	case TextureDeviceFormat::R32F:
+	case TextureDeviceFormat::RG32F:
+	case TextureDeviceFormat::RGBA32F:
+	case TextureDeviceFormat::R32UI:
+	case TextureDeviceFormat::RG32UI:
+		break;
+	default:
+		throw std::invalid_argument("texture format can't view a buffer");
+	}
+
+	return BufferTexture(TextureTarget::TEXTURE_BUFFER, format, 0, 1);
+}
+
+GLsizei BufferTexture::maxTexels()
+{
+	GLint result = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &result);
+	checkGl();
+	return result;
+}
+
+void BufferTexture::attach(GLuint buffer, std::size_t bytes)
+{
+	const auto texelBytes = levelBytes(m_deviceFormat, 1, 1);
+	assert(bytes % texelBytes == 0);
+
+	glBindTexture(GL_TEXTURE_BUFFER, m_texture);
+	checkGl();
+	glTexBuffer(GL_TEXTURE_BUFFER, static_cast<GLenum>(m_deviceFormat), buffer);
+	checkGl();
+
+	m_width = static_cast<GLsizei>(bytes / texelBytes);
+}
+
+}
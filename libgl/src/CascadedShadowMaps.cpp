@@ -0,0 +1,171 @@
+#include <CascadedShadowMaps.hpp>
+
+#include <cmath>
+
+namespace libgl
+{
+
+static SamplerDesc makeCompareSampler()
+{
+	SamplerDesc desc;
+	desc.mipmapMode = MipmapMode::NONE;
+	desc.wrapS = TextureWrap::CLAMP_TO_EDGE;
+	desc.wrapT = TextureWrap::CLAMP_TO_EDGE;
+	desc.wrapR = TextureWrap::CLAMP_TO_EDGE;
+	desc.depthCompare = true;
+	return desc;
+}
+
+static const ShadowSettings& validate(const ShadowSettings& settings)
+{
+	if (settings.cascades < 1 || settings.cascades > CascadedShadowMaps::kMaxCascades || settings.resolution < 1 ||
+		settings.maxDistance <= 0.0f || settings.splitLambda < 0.0f || settings.splitLambda > 1.0f ||
+		settings.casterDistance < 0.0f || settings.cacheSlack < 0.0f)
+	{
+		throw std::invalid_argument("invalid shadow settings");
+	}
+	return settings;
+}
+
+CascadedShadowMaps::CascadedShadowMaps(const ShadowSettings& settings) :
+	m_settings(validate(settings)),
+	m_compareSampler(makeCompareSampler())
+{
+	m_depth = std::make_shared<MutableTexture>(MutableTexture::make2DArray(
+		settings.resolution, settings.resolution, settings.cascades, TextureDeviceFormat::DEPTH_COMPONENT32F));
+	m_depth->bind(kTextureUnit);
+	m_depth->allocate();
+
+	m_cascades.resize(settings.cascades);
+	for (GLsizei layer = 0; layer < settings.cascades; ++layer)
+	{
+		FrameBufferDesc desc;
+		desc.depth = FrameBufferAttachment::make(m_depth, 0, layer);
+		m_cascades[layer].frameBuffer = std::make_unique<FrameBuffer>(std::move(desc));
+	}
+	FrameBuffer::bindDefault();
+}
+
+void CascadedShadowMaps::update(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& lightDirection)
+{
+	// glm::perspective: [0][0] = 1 / (aspect * tan(fovy / 2)), [1][1] = 1 / tan(fovy / 2), the depth range in [2][2] and [3][2]
+	const auto zNear = projection[3][2] / (projection[2][2] - 1.0f);
+	const auto zFar = projection[3][2] / (projection[2][2] + 1.0f);
+	const glm::vec2 tanHalf(1.0f / projection[0][0], 1.0f / projection[1][1]);
+	// squared distance of a frustum corner from the view axis per unit of depth
+	const auto cornerSlope = glm::dot(tanHalf, tanHalf);
+	const auto shadowFar = (std::min)(m_settings.maxDistance, zFar);
+
+	// a fixed basis, so light space only changes with the light
+	const auto up = std::abs(lightDirection.y) > 0.99f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+	const auto lightView = glm::lookAt(glm::vec3(0.0f), -lightDirection, up);
+	const auto viewToLight = lightView * glm::inverse(view);
+
+	auto sliceNear = zNear;
+	for (std::size_t i = 0; i < m_cascades.size(); ++i)
+	{
+		auto& cascade = m_cascades[i];
+
+		const auto fraction = float(i + 1) / m_cascades.size();
+		const auto logarithmic = zNear * std::pow(shadowFar / zNear, fraction);
+		const auto uniform = zNear + (shadowFar - zNear) * fraction;
+		const auto sliceFar = m_settings.splitLambda * logarithmic + (1.0f - m_settings.splitLambda) * uniform;
+
+		// the smallest sphere around the slice has its center on the view axis, equally far from the near and the far corners
+		auto centerDistance = (sliceNear + sliceFar) * (1.0f + cornerSlope) * 0.5f;
+		auto radius = 0.0f;
+		if (centerDistance >= sliceFar)
+		{
+			centerDistance = sliceFar;
+			radius = sliceFar * std::sqrt(cornerSlope);
+		}
+		else
+		{
+			radius = std::sqrt((sliceFar - centerDistance) * (sliceFar - centerDistance) + sliceFar * sliceFar * cornerSlope);
+		}
+		const auto slack = radius * m_settings.cacheSlack;
+		radius += slack;
+
+		// whole texels at least, the rounding error of the center stays within the slack
+		const auto texel = 2.0f * radius / m_settings.resolution;
+		const auto step = (std::max)(1.0f, std::floor(slack / texel)) * texel;
+		auto center = glm::vec3(viewToLight * glm::vec4(0.0f, 0.0f, -centerDistance, 1.0f));
+		center = glm::round(center / step) * step;
+
+		// light space looks down -z, casters between the light and the cascade have larger z
+		const auto lightProjection = glm::ortho(center.x - radius, center.x + radius, center.y - radius, center.y + radius,
+			-center.z - radius - m_settings.casterDistance, -center.z + radius);
+
+		cascade.viewProjection = lightProjection * lightView;
+		cascade.split = sliceFar;
+		sliceNear = sliceFar;
+	}
+}
+
+void CascadedShadowMaps::invalidate() noexcept
+{
+	for (auto& cascade : m_cascades)
+	{
+		cascade.valid = false;
+	}
+}
+
+GLsizei CascadedShadowMaps::render(const DrawFunc& drawCasters)
+{
+	GLsizei rendered = 0;
+	for (auto& cascade : m_cascades)
+	{
+		if (cascade.valid && cascade.renderedViewProjection == cascade.viewProjection)
+		{
+			continue;
+		}
+
+		if (rendered == 0)
+		{
+			glEnable(GL_POLYGON_OFFSET_FILL);
+			glPolygonOffset(m_settings.slopeBias, m_settings.constantBias);
+			checkGl();
+		}
+
+		cascade.frameBuffer->bind();
+		cascade.frameBuffer->setViewport();
+		glClear(GL_DEPTH_BUFFER_BIT);
+		checkGl();
+
+		drawCasters(cascade.viewProjection);
+
+		cascade.renderedViewProjection = cascade.viewProjection;
+		cascade.valid = true;
+		++rendered;
+	}
+
+	if (rendered > 0)
+	{
+		glDisable(GL_POLYGON_OFFSET_FILL);
+		checkGl();
+	}
+	return rendered;
+}
+
+void CascadedShadowMaps::bind(ShaderProgram& program, const glm::mat4& view)
+{
+	m_depth->bind(kTextureUnit);
+	m_compareSampler.bind(kTextureUnit);
+
+	// clip space of a cascade to texture coordinates and depth in [0, 1]
+	const auto toTexture = glm::translate(glm::mat4(1.0f), glm::vec3(0.5f)) * glm::scale(glm::mat4(1.0f), glm::vec3(0.5f));
+	const auto inverseView = glm::inverse(view);
+
+	glm::vec4 splits(0.0f);
+	for (std::size_t i = 0; i < m_cascades.size(); ++i)
+	{
+		splits[glm::length_t(i)] = m_cascades[i].split;
+		program.setUniform("U_SHADOW_MATRICES[" + std::to_string(i) + ']', toTexture * m_cascades[i].renderedViewProjection * inverseView);
+	}
+
+	program.setUniform("U_SHADOW_MAP", GLint(kTextureUnit));
+	program.setUniform("U_SHADOW_CASCADES", GLint(m_cascades.size()));
+	program.setUniform("U_SHADOW_SPLITS", splits);
+}
+
+}
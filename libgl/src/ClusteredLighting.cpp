@@ -0,0 +1,186 @@
+#include <ClusteredLighting.hpp>
+
+#include <cmath>
+
+namespace libgl
+{
+
+// signed distance from the plane through the eye that holds the tile boundary at `ndc` along one axis,
+// positive on the side of larger coordinates
+static float boundaryDistance(float coordinate, float depth, float ndc, float tanHalf)
+{
+	const auto slope = ndc * tanHalf;
+	return (coordinate + depth * slope) / std::sqrt(1.0f + slope * slope);
+}
+
+// the tiles along one axis whose slab touches a view space sphere, false when there is none
+static bool tileRange(float coordinate, float depth, float radius, float tanHalf, int tiles, int& first, int& last)
+{
+	first = tiles;
+	last = -1;
+	for (int tile = 0; tile < tiles; ++tile)
+	{
+		const auto lower = boundaryDistance(coordinate, depth, 2.0f * tile / tiles - 1.0f, tanHalf);
+		const auto upper = boundaryDistance(coordinate, depth, 2.0f * (tile + 1) / tiles - 1.0f, tanHalf);
+		if (lower >= -radius && upper <= radius)
+		{
+			first = (std::min)(first, tile);
+			last = tile;
+		}
+	}
+	return first <= last;
+}
+
+ClusteredLighting::ClusteredLighting(const glm::ivec3& gridSize) :
+	m_gridSize(gridSize),
+	m_lightsTexture(BufferTexture::make(TextureDeviceFormat::RGBA32F)),
+	m_clustersTexture(BufferTexture::make(TextureDeviceFormat::RG32UI)),
+	m_indicesTexture(BufferTexture::make(TextureDeviceFormat::R32UI))
+{
+	if (gridSize.x < 1 || gridSize.y < 1 || gridSize.z < 1)
+	{
+		throw std::invalid_argument("empty cluster grid");
+	}
+	m_maxIndices = static_cast<GLuint>(BufferTexture::maxTexels());
+	if (GLuint(gridSize.x * gridSize.y * gridSize.z) > m_maxIndices)
+	{
+		throw std::invalid_argument("cluster grid exceeds GL_MAX_TEXTURE_BUFFER_SIZE");
+	}
+}
+
+void ClusteredLighting::setLights(std::vector<PointLight> lights)
+{
+	for (const auto& light : lights)
+	{
+		if (!(light.radius > 0.0f))
+		{
+			throw std::invalid_argument("point light radius must be positive");
+		}
+	}
+	m_lights = std::move(lights);
+}
+
+void ClusteredLighting::update(const glm::mat4& view, const glm::mat4& projection)
+{
+	// glm::perspective: [0][0] = 1 / (aspect * tan(fovy / 2)), [1][1] = 1 / tan(fovy / 2), the depth range in [2][2] and [3][2]
+	const auto zNear = projection[3][2] / (projection[2][2] - 1.0f);
+	const auto zFar = projection[3][2] / (projection[2][2] + 1.0f);
+	const glm::vec2 tanHalf(1.0f / projection[0][0], 1.0f / projection[1][1]);
+
+	// slice = log(distance / near) / log(far / near) * slices, split into a scale and a bias of log(distance)
+	m_depthScale = m_gridSize.z / std::log(zFar / zNear);
+	m_depthBias = -std::log(zNear) * m_depthScale;
+
+	const auto sliceOf = [&](float distance)
+	{
+		const auto slice = static_cast<int>(std::floor(std::log((std::max)(distance, zNear)) * m_depthScale + m_depthBias));
+		return std::clamp(slice, 0, m_gridSize.z - 1);
+	};
+
+	m_viewLights.clear();
+	m_bounds.clear();
+	m_clusters.assign(std::size_t(m_gridSize.x) * m_gridSize.y * m_gridSize.z, glm::uvec2(0));
+
+	for (const auto& light : m_lights)
+	{
+		const auto center = glm::vec3(view * glm::vec4(light.position, 1.0f));
+		const auto nearest = -center.z - light.radius;
+		const auto farthest = -center.z + light.radius;
+		if (farthest < zNear || nearest > zFar)
+		{
+			continue;
+		}
+
+		LightBounds bounds;
+		if (!tileRange(center.x, center.z, light.radius, tanHalf.x, m_gridSize.x, bounds.min.x, bounds.max.x) ||
+			!tileRange(center.y, center.z, light.radius, tanHalf.y, m_gridSize.y, bounds.min.y, bounds.max.y))
+		{
+			continue;
+		}
+		bounds.min.z = sliceOf(nearest);
+		bounds.max.z = sliceOf(farthest);
+
+		m_viewLights.emplace_back(center, light.radius);
+		m_viewLights.emplace_back(light.color, 0.0f);
+		m_bounds.push_back(bounds);
+	}
+
+	const auto forEachCluster = [this](const LightBounds& bounds, const auto& func)
+	{
+		for (int z = bounds.min.z; z <= bounds.max.z; ++z)
+		{
+			for (int y = bounds.min.y; y <= bounds.max.y; ++y)
+			{
+				for (int x = bounds.min.x; x <= bounds.max.x; ++x)
+				{
+					func(m_clusters[(std::size_t(z) * m_gridSize.y + y) * m_gridSize.x + x]);
+				}
+			}
+		}
+	};
+
+	for (const auto& bounds : m_bounds)
+	{
+		forEachCluster(bounds, [](glm::uvec2& cluster) { ++cluster.y; });
+	}
+
+	// lists past the texel limit of the index buffer are cut short rather than failing the frame
+	GLuint offset = 0;
+	for (auto& cluster : m_clusters)
+	{
+		cluster.x = offset;
+		cluster.y = (std::min)(cluster.y, m_maxIndices - offset);
+		offset += cluster.y;
+	}
+
+	// the counts are rebuilt while the lists are filled
+	m_indices.assign(offset, 0);
+	std::vector<GLuint> fill(m_clusters.size(), 0);
+	for (std::size_t light = 0; light < m_bounds.size(); ++light)
+	{
+		forEachCluster(m_bounds[light], [&](glm::uvec2& cluster)
+		{
+			auto& filled = fill[&cluster - m_clusters.data()];
+			if (filled < cluster.y)
+			{
+				m_indices[cluster.x + filled++] = GLuint(light);
+			}
+		});
+	}
+
+	// buffer textures over empty buffers are incomplete, a padding element keeps them valid
+	if (m_viewLights.empty())
+	{
+		m_viewLights.emplace_back(0.0f);
+	}
+	const auto indicesCount = m_indices.size();
+	if (m_indices.empty())
+	{
+		m_indices.push_back(0);
+	}
+
+	m_lightsBuffer.setData(BufferUsage::STREAM_DRAW, m_viewLights);
+	m_clustersBuffer.setData(BufferUsage::STREAM_DRAW, m_clusters);
+	m_indicesBuffer.setData(BufferUsage::STREAM_DRAW, m_indices);
+	m_indices.resize(indicesCount);
+
+	m_lightsTexture.attach(m_lightsBuffer);
+	m_clustersTexture.attach(m_clustersBuffer);
+	m_indicesTexture.attach(m_indicesBuffer);
+}
+
+void ClusteredLighting::bind(ShaderProgram& program, const glm::ivec2& viewportSize)
+{
+	m_lightsTexture.bind(kLightsUnit);
+	m_clustersTexture.bind(kClustersUnit);
+	m_indicesTexture.bind(kIndicesUnit);
+
+	program.setUniform("U_LIGHTS", GLint(kLightsUnit));
+	program.setUniform("U_CLUSTERS", GLint(kClustersUnit));
+	program.setUniform("U_LIGHT_INDICES", GLint(kIndicesUnit));
+	program.setUniform("U_CLUSTER_GRID", m_gridSize);
+	program.setUniform("U_CLUSTER_VIEWPORT", glm::vec2(viewportSize));
+	program.setUniform("U_CLUSTER_DEPTH", glm::vec2(m_depthScale, m_depthBias));
+}
+
+}
@@ -0,0 +1,88 @@
+#include <ComputeProgram.hpp>
+#include <ShaderCompileQueue.hpp>
+#include <ShaderPreprocessor.hpp>
+#include <ShaderVariants.hpp>
+
+namespace libgl
+{
+
+ComputeProgram::ComputeProgram(std::shared_ptr<ShaderProgram> program) :
+	m_program(std::move(program))
+{
+	glGetProgramiv(m_program->nativeHandle(), GL_COMPUTE_WORK_GROUP_SIZE, glm::value_ptr(m_workGroupSize));
+	checkGl();
+
+	for (GLuint i = 0; i < 3; ++i)
+	{
+		glGetIntegeri_v(GL_MAX_COMPUTE_WORK_GROUP_COUNT, i, &m_maxGroupsCount[i]);
+		checkGl();
+	}
+}
+
+void ComputeProgram::bind() noexcept
+{
+	m_program->bind();
+}
+
+void ComputeProgram::dispatch(GLuint groupsX, GLuint groupsY, GLuint groupsZ)
+{
+	if (groupsX > GLuint(m_maxGroupsCount.x) || groupsY > GLuint(m_maxGroupsCount.y) || groupsZ > GLuint(m_maxGroupsCount.z))
+	{
+		throw std::invalid_argument("too many compute work groups");
+	}
+
+	if (groupsX == 0 || groupsY == 0 || groupsZ == 0)
+	{
+		return;
+	}
+
+	glDispatchCompute(groupsX, groupsY, groupsZ);
+	checkGl();
+}
+
+void ComputeProgram::dispatchThreads(GLuint threadsX, GLuint threadsY, GLuint threadsZ)
+{
+	const auto groups = [](GLuint threads, GLint groupSize)
+	{
+		return (threads + GLuint(groupSize) - 1) / GLuint(groupSize);
+	};
+
+	dispatch(groups(threadsX, m_workGroupSize.x), groups(threadsY, m_workGroupSize.y), groups(threadsZ, m_workGroupSize.z));
+}
+
+void ComputeProgram::dispatchIndirect(BufferObjectBase& buffer, GLintptr byteOffset)
+{
+	assert(buffer.target() == BufferTarget::DISPATCH_INDIRECT_BUFFER);
+
+	buffer.bind();
+	glDispatchComputeIndirect(byteOffset);
+	checkGl();
+}
+
+void ComputeProgram::memoryBarrier(GLbitfield barriers)
+{
+	glMemoryBarrier(barriers);
+	checkGl();
+}
+
+bool ComputeProgram::isSupported() noexcept
+{
+	return GLEW_VERSION_4_3 || GLEW_ARB_compute_shader;
+}
+
+std::shared_ptr<ComputeProgram> ComputeProgram::make(const std::filesystem::path& path, const std::vector<std::string>& defines)
+{
+	if (!isSupported())
+	{
+		throw std::runtime_error("compute shaders are not supported by the context");
+	}
+
+	ProgramBuild build(GL_COMPUTE_SHADER, ShaderVariants::injectDefines(ShaderPreprocessor::instance().load(path).text, defines), false);
+	build.poll(true);
+
+	auto program = build.program();
+	program->setLabel(ShaderVariants::labelOf(path.filename().string(), defines));
+	return std::make_shared<ComputeProgram>(std::move(program));
+}
+
+}
@@ -0,0 +1,77 @@
+#include <DynamicResolution.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace libgl
+{
+
+// weight of the newest sample in the running average
+static constexpr float kAverageWeight = 0.1f;
+
+DynamicResolution::DynamicResolution(const DynamicResolutionSettings& settings)
+{
+	setSettings(settings);
+}
+
+void DynamicResolution::setSettings(const DynamicResolutionSettings& settings)
+{
+	if (settings.targetMilliseconds <= 0.0f || settings.scaleStep <= 0.0f ||
+		settings.minScale <= 0.0f || settings.minScale > settings.maxScale || settings.maxScale > 1.0f)
+	{
+		throw std::invalid_argument("invalid dynamic resolution settings");
+	}
+
+	m_settings = settings;
+	m_scale = quantize(settings.maxScale);
+	m_cooldown = 0;
+}
+
+bool DynamicResolution::update(float gpuMilliseconds)
+{
+	m_averageMilliseconds = m_averageMilliseconds > 0.0f
+		? m_averageMilliseconds + (gpuMilliseconds - m_averageMilliseconds) * kAverageWeight
+		: gpuMilliseconds;
+
+	if (m_cooldown > 0)
+	{
+		--m_cooldown;
+		return false;
+	}
+
+	auto scale = m_scale;
+	if (m_averageMilliseconds > m_settings.targetMilliseconds)
+	{
+		scale = (std::min)(quantize(m_scale * std::sqrt(m_settings.targetMilliseconds / m_averageMilliseconds)), quantize(m_scale - m_settings.scaleStep));
+	}
+	else if (m_averageMilliseconds < m_settings.targetMilliseconds * m_settings.headroom)
+	{
+		scale = quantize(m_scale + m_settings.scaleStep);
+	}
+
+	if (scale == m_scale)
+	{
+		return false;
+	}
+
+	// the average measured the old resolution, start over at the new one
+	m_scale = scale;
+	m_averageMilliseconds = 0.0f;
+	m_cooldown = m_settings.cooldownFrames;
+	return true;
+}
+
+glm::ivec2 DynamicResolution::renderSize(const glm::ivec2& outputSize) const noexcept
+{
+	return glm::max(glm::ivec2(glm::round(glm::vec2(outputSize) * m_scale)), glm::ivec2(1));
+}
+
+float DynamicResolution::quantize(float scale) const noexcept
+{
+	// rounding down keeps a shrinking scale from landing back on the size that was too slow
+	const auto steps = std::floor(scale / m_settings.scaleStep + 1e-3f);
+	return std::clamp(steps * m_settings.scaleStep, m_settings.minScale, m_settings.maxScale);
+}
+
+}
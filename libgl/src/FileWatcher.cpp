@@ -0,0 +1,157 @@
+#include <FileWatcher.hpp>
+
+#include <system_error>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace libgl
+{
+
+FileWatcher::FileWatcher(std::filesystem::path root) :
+	m_root(std::filesystem::weakly_canonical(root))
+{
+#ifdef __linux__
+	m_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (m_inotify < 0)
+	{
+		throw std::system_error(errno, std::generic_category(), "inotify_init1");
+	}
+
+	addWatch(m_root);
+	for (const auto& entry : std::filesystem::recursive_directory_iterator(m_root))
+	{
+		if (entry.is_directory())
+		{
+			addWatch(entry.path());
+		}
+	}
+#endif
+
+	m_thread = std::thread(&FileWatcher::run, this);
+}
+
+FileWatcher::~FileWatcher()
+{
+	m_stop = true;
+	m_thread.join();
+
+#ifdef __linux__
+	close(m_inotify);
+#endif
+}
+
+std::vector<std::filesystem::path> FileWatcher::takeChanges()
+{
+	std::lock_guard lock(m_mutex);
+
+	std::vector<std::filesystem::path> result(m_changes.begin(), m_changes.end());
+	m_changes.clear();
+	return result;
+}
+
+void FileWatcher::push(const std::filesystem::path& path)
+{
+	std::lock_guard lock(m_mutex);
+	m_changes.insert(path);
+}
+
+#ifdef __linux__
+
+void FileWatcher::addWatch(const std::filesystem::path& directory)
+{
+	// editors often save through a temporary file and rename it, hence IN_MOVED_TO
+	const auto watch = inotify_add_watch(m_inotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+	if (watch < 0)
+	{
+		throw std::system_error(errno, std::generic_category(), "inotify_add_watch " + directory.string());
+	}
+
+	m_watches[watch] = directory;
+}
+
+void FileWatcher::run()
+{
+	alignas(inotify_event) char buffer[4096];
+
+	while (!m_stop)
+	{
+		pollfd descriptor{ m_inotify, POLLIN, 0 };
+		if (::poll(&descriptor, 1, static_cast<int>(kPollInterval.count())) <= 0)
+		{
+			continue;
+		}
+
+		for (auto length = read(m_inotify, buffer, sizeof(buffer)); length > 0; length = read(m_inotify, buffer, sizeof(buffer)))
+		{
+			for (auto* cursor = buffer; cursor < buffer + length;)
+			{
+				const auto* event = reinterpret_cast<const inotify_event*>(cursor);
+				cursor += sizeof(inotify_event) + event->len;
+
+				const auto directory = m_watches.find(event->wd);
+				if (directory == m_watches.end() || event->len == 0)
+				{
+					continue;
+				}
+
+				const auto path = directory->second / event->name;
+				if (event->mask & IN_ISDIR)
+				{
+					if (event->mask & (IN_CREATE | IN_MOVED_TO))
+					{
+						addWatch(path);
+					}
+				}
+				else if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO))
+				{
+					push(path);
+				}
+			}
+		}
+	}
+}
+
+#else
+
+std::map<std::filesystem::path, std::filesystem::file_time_type> FileWatcher::scan() const
+{
+	std::map<std::filesystem::path, std::filesystem::file_time_type> result;
+
+	std::error_code error;
+	for (std::filesystem::recursive_directory_iterator it(m_root, error), end; !error && it != end; it.increment(error))
+	{
+		if (it->is_regular_file(error))
+		{
+			result[std::filesystem::weakly_canonical(it->path())] = it->last_write_time(error);
+		}
+	}
+	return result;
+}
+
+void FileWatcher::run()
+{
+	auto previous = scan();
+
+	while (!m_stop)
+	{
+		std::this_thread::sleep_for(kPollInterval);
+
+		auto current = scan();
+		for (const auto& [path, time] : current)
+		{
+			if (auto it = previous.find(path); it == previous.end() || it->second != time)
+			{
+				push(path);
+			}
+		}
+		previous = std::move(current);
+	}
+}
+
+#endif
+
+}
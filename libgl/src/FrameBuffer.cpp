@@ -6,11 +6,163 @@
 namespace libgl
 {
 
-FrameBuffer::FrameBuffer(BindingMode mode) :
-	m_bindngMode(mode)
+static const char* getStatusName(GLenum status)
 {
+	switch (status)
+	{
+	case GL_FRAMEBUFFER_UNDEFINED: return "GL_FRAMEBUFFER_UNDEFINED";
+	case GL_FRAMEBUFFER_INCOMPLETE_ATTACHMENT: return "GL_FRAMEBUFFER_INCOMPLETE_ATTACHMENT";
+	case GL_FRAMEBUFFER_INCOMPLETE_MISSING_ATTACHMENT: return "GL_FRAMEBUFFER_INCOMPLETE_MISSING_ATTACHMENT";
+	case GL_FRAMEBUFFER_INCOMPLETE_DRAW_BUFFER: return "GL_FRAMEBUFFER_INCOMPLETE_DRAW_BUFFER";
+	case GL_FRAMEBUFFER_INCOMPLETE_READ_BUFFER: return "GL_FRAMEBUFFER_INCOMPLETE_READ_BUFFER";
+	case GL_FRAMEBUFFER_UNSUPPORTED: return "GL_FRAMEBUFFER_UNSUPPORTED";
+	case GL_FRAMEBUFFER_INCOMPLETE_MULTISAMPLE: return "GL_FRAMEBUFFER_INCOMPLETE_MULTISAMPLE";
+	case GL_FRAMEBUFFER_INCOMPLETE_LAYER_TARGETS: return "GL_FRAMEBUFFER_INCOMPLETE_LAYER_TARGETS";
+	}
+	return "unknown framebuffer status";
+}
+
+static void attach(GLenum attachmentPoint, const FrameBufferAttachment& attachment)
+{
+	if (attachment.renderBuffer)
+	{
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, attachmentPoint, GL_RENDERBUFFER, attachment.renderBuffer->nativeHandle());
+		checkGl();
+	}
+	else if (attachment.layer >= 0)
+	{
+		glFramebufferTextureLayer(GL_FRAMEBUFFER, attachmentPoint, attachment.texture->nativeHandle(), attachment.level, attachment.layer);
+		checkGl();
+	}
+	else
+	{
+		glFramebufferTexture(GL_FRAMEBUFFER, attachmentPoint, attachment.texture->nativeHandle(), attachment.level);
+		checkGl();
+	}
+}
+
+GLsizei FrameBufferAttachment::width() const noexcept
+{
+	return renderBuffer ? renderBuffer->width() : (std::max)(1, texture->width() >> level);
+}
+
+GLsizei FrameBufferAttachment::height() const noexcept
+{
+	return renderBuffer ? renderBuffer->height() : (std::max)(1, texture->height() >> level);
+}
+
+TextureDeviceFormat FrameBufferAttachment::format() const noexcept
+{
+	return renderBuffer ? renderBuffer->format() : texture->deviceFormat();
+}
+
+static void blit(GLuint source, GLsizei sourceWidth, GLsizei sourceHeight, GLuint target, GLsizei targetWidth, GLsizei targetHeight, GLbitfield mask, GLenum filter)
+{
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, source);
+	checkGl();
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, target);
+	checkGl();
+
+	glBlitFramebuffer(0, 0, sourceWidth, sourceHeight, 0, 0, targetWidth, targetHeight, mask, filter);
+	checkGl();
+}
+
+FrameBufferAttachment FrameBufferAttachment::make(std::shared_ptr<TextureBase> texture, GLint level, GLint layer)
+{
+	FrameBufferAttachment result;
+	result.texture = std::move(texture);
+	result.level = level;
+	result.layer = layer;
+	return result;
+}
+
+FrameBufferAttachment FrameBufferAttachment::make(std::shared_ptr<RenderBuffer> renderBuffer)
+{
+	FrameBufferAttachment result;
+	result.renderBuffer = std::move(renderBuffer);
+	return result;
+}
+
+FrameBuffer::FrameBuffer(FrameBufferDesc desc) :
+	m_desc(std::move(desc))
+{
+	GLint maxColorAttachments;
+	glGetIntegerv(GL_MAX_COLOR_ATTACHMENTS, &maxColorAttachments);
+	checkGl();
+
+	if (m_desc.colors.size() > std::size_t(maxColorAttachments))
+	{
+		throw std::invalid_argument("too many color attachments");
+	}
+
 	glGenFramebuffers(1, &m_framebuffer);
 	checkGl();
+
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+	checkGl();
+
+	std::vector<GLenum> drawBuffers;
+	for (std::size_t i = 0; i < m_desc.colors.size(); ++i)
+	{
+		const auto attachmentPoint = GLenum(GL_COLOR_ATTACHMENT0 + i);
+		attach(attachmentPoint, m_desc.colors[i]);
+		drawBuffers.push_back(attachmentPoint);
+		m_attachmentPoints.push_back(attachmentPoint);
+	}
+
+	if (!m_desc.depth.empty())
+	{
+		const auto format = m_desc.depth.format();
+		assert(isDepthFormat(format));
+		m_attachmentPoints.push_back(isStencilFormat(format) ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT);
+		attach(m_attachmentPoints.back(), m_desc.depth);
+	}
+
+	if (!m_desc.stencil.empty())
+	{
+		assert(m_desc.stencil.format() == TextureDeviceFormat::STENCIL_INDEX8);
+		m_attachmentPoints.push_back(GL_STENCIL_ATTACHMENT);
+		attach(GL_STENCIL_ATTACHMENT, m_desc.stencil);
+	}
+
+	// depth-only framebuffers (shadow maps) read and draw no color at all
+	if (drawBuffers.empty())
+	{
+		glDrawBuffer(GL_NONE);
+		glReadBuffer(GL_NONE);
+	}
+	else
+	{
+		glDrawBuffers(static_cast<GLsizei>(drawBuffers.size()), drawBuffers.data());
+	}
+	checkGl();
+
+	const auto status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	checkGl();
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	checkGl();
+
+	if (status != GL_FRAMEBUFFER_COMPLETE)
+	{
+		glDeleteFramebuffers(1, &m_framebuffer);
+		throw std::runtime_error(std::string("incomplete framebuffer: ") + getStatusName(status));
+	}
+
+	// GL renders to the intersection of differently sized attachments
+	for (const auto* attachment : { &m_desc.depth, &m_desc.stencil })
+	{
+		if (!attachment->empty())
+		{
+			m_width = m_width ? (std::min)(m_width, attachment->width()) : attachment->width();
+			m_height = m_height ? (std::min)(m_height, attachment->height()) : attachment->height();
+		}
+	}
+	for (const auto& attachment : m_desc.colors)
+	{
+		m_width = m_width ? (std::min)(m_width, attachment.width()) : attachment.width();
+		m_height = m_height ? (std::min)(m_height, attachment.height()) : attachment.height();
+	}
 }
 
 FrameBuffer::~FrameBuffer() noexcept
@@ -22,43 +174,64 @@ FrameBuffer::~FrameBuffer() noexcept
 	}
 }
 
-void FrameBuffer::bind(const TextureBase& texture)
+void FrameBuffer::releaseAttachments() noexcept
 {
-	glBindFramebuffer(static_cast<GLenum>(m_bindngMode), m_framebuffer);
-	checkGl();
+	for (auto& attachment : m_desc.colors)
+	{
+		attachment.texture.reset();
+		attachment.renderBuffer.reset();
+	}
+	for (auto* attachment : { &m_desc.depth, &m_desc.stencil })
+	{
+		attachment->texture.reset();
+		attachment->renderBuffer.reset();
+	}
+}
 
-	glViewport(0, 0, texture.width(), texture.height());
+void FrameBuffer::bind(BindingMode mode)
+{
+	glBindFramebuffer(static_cast<GLenum>(mode), m_framebuffer);
 	checkGl();
+}
 
-	glFramebufferTexture2D(
-		static_cast<GLenum>(m_bindngMode),
-		GL_COLOR_ATTACHMENT0,
-		GL_TEXTURE_2D,
-		texture.nativeHandle(),
-		0);
+void FrameBuffer::bindDefault(BindingMode mode)
+{
+	glBindFramebuffer(static_cast<GLenum>(mode), 0);
 	checkGl();
+}
 
-	assert(glCheckFramebufferStatus(static_cast<GLenum>(m_bindngMode)) == GL_FRAMEBUFFER_COMPLETE);
+void FrameBuffer::setViewport() const
+{
+	glViewport(0, 0, m_width, m_height);
 	checkGl();
+}
 
-	if (m_bindngMode == BindingMode::DRAW_FRAMEBUFFER)
-	{
-		glClear(GL_COLOR_BUFFER_BIT);
-		checkGl();
-	}
+void FrameBuffer::blitTo(const FrameBuffer& target, GLbitfield mask, GLenum filter) const
+{
+	blit(m_framebuffer, m_width, m_height, target.m_framebuffer, target.m_width, target.m_height, mask, filter);
+}
+
+void FrameBuffer::blitToDefault(GLsizei width, GLsizei height, GLbitfield mask, GLenum filter) const
+{
+	blit(m_framebuffer, m_width, m_height, 0, width, height, mask, filter);
 }
 
-void FrameBuffer::unbind()
+void FrameBuffer::invalidate()
 {
-	glFramebufferTexture2D(
-	static_cast<GLenum>(m_bindngMode),
-	GL_COLOR_ATTACHMENT0,
-	GL_TEXTURE_2D,
-	0,
-	0);
+	invalidate(m_attachmentPoints);
+}
+
+void FrameBuffer::invalidate(const std::vector<GLenum>& attachmentPoints)
+{
+	if (!(GLEW_VERSION_4_3 || GLEW_ARB_invalidate_subdata) || attachmentPoints.empty())
+	{
+		return;
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
 	checkGl();
 
-	glBindFramebuffer(static_cast<GLenum>(m_bindngMode), 0);
+	glInvalidateFramebuffer(GL_FRAMEBUFFER, static_cast<GLsizei>(attachmentPoints.size()), attachmentPoints.data());
 	checkGl();
 }
 
@@ -0,0 +1,85 @@
+#include <FrameBufferCache.hpp>
+
+#include <algorithm>
+
+namespace libgl
+{
+
+static std::vector<FrameBufferCache*> g_caches;
+
+FrameBufferCache::FrameBufferCache()
+{
+	g_caches.push_back(this);
+}
+
+FrameBufferCache::~FrameBufferCache()
+{
+	g_caches.erase(std::find(g_caches.begin(), g_caches.end(), this));
+}
+
+FrameBuffer& FrameBufferCache::get(const FrameBufferDesc& desc)
+{
+	auto key = makeKey(desc);
+	if (auto it = m_frameBuffers.find(key); it != m_frameBuffers.end())
+	{
+		return *it->second;
+	}
+
+	auto frameBuffer = std::make_unique<FrameBuffer>(desc);
+	frameBuffer->releaseAttachments();
+
+	return *m_frameBuffers.emplace(std::move(key), std::move(frameBuffer)).first->second;
+}
+
+void FrameBufferCache::clear() noexcept
+{
+	m_frameBuffers.clear();
+}
+
+void FrameBufferCache::notifyDestroyed(GLenum kind, GLuint name) noexcept
+{
+	for (auto* cache : g_caches)
+	{
+		cache->erase(kind, name);
+	}
+}
+
+FrameBufferCache::Key FrameBufferCache::makeKey(const FrameBufferDesc& desc)
+{
+	Key result;
+	for (std::size_t i = 0; i < desc.colors.size(); ++i)
+	{
+		appendKey(result, GLenum(GL_COLOR_ATTACHMENT0 + i), desc.colors[i]);
+	}
+	appendKey(result, GL_DEPTH_ATTACHMENT, desc.depth);
+	appendKey(result, GL_STENCIL_ATTACHMENT, desc.stencil);
+	return result;
+}
+
+void FrameBufferCache::erase(GLenum kind, GLuint name) noexcept
+{
+	for (auto it = m_frameBuffers.begin(); it != m_frameBuffers.end();)
+	{
+		const auto& key = it->first;
+		const auto attached = std::any_of(key.begin(), key.end(), [&](const AttachmentKey& attachment)
+		{
+			return attachment.kind == kind && attachment.name == name;
+		});
+
+		it = attached ? m_frameBuffers.erase(it) : std::next(it);
+	}
+}
+
+void FrameBufferCache::appendKey(Key& key, GLenum point, const FrameBufferAttachment& attachment)
+{
+	if (attachment.renderBuffer)
+	{
+		key.push_back({ point, GL_RENDERBUFFER, attachment.renderBuffer->nativeHandle(), 0, -1 });
+	}
+	else if (attachment.texture)
+	{
+		key.push_back({ point, GL_TEXTURE, attachment.texture->nativeHandle(), attachment.level, attachment.layer });
+	}
+}
+
+}
@@ -0,0 +1,189 @@
+#include <GpuCulling.hpp>
+
+#include <array>
+
+namespace libgl
+{
+
+static SamplerDesc makePointSampler(MipmapMode mipmapMode)
+{
+	SamplerDesc desc;
+	desc.magFilter = TextureFilter::NEAREST;
+	desc.minFilter = TextureFilter::NEAREST;
+	desc.mipmapMode = mipmapMode;
+	desc.wrapS = TextureWrap::CLAMP_TO_EDGE;
+	desc.wrapT = TextureWrap::CLAMP_TO_EDGE;
+	desc.wrapR = TextureWrap::CLAMP_TO_EDGE;
+	return desc;
+}
+
+// Gribb & Hartmann, planes point inside and are normalized so sphere distances are in world units
+static std::array<glm::vec4, 6> extractFrustumPlanes(const glm::mat4& viewProjection)
+{
+	const auto row = [&](int i)
+	{
+		return glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+	};
+
+	std::array<glm::vec4, 6> planes = {
+		row(3) + row(0),
+		row(3) - row(0),
+		row(3) + row(1),
+		row(3) - row(1),
+		row(3) + row(2),
+		row(3) - row(2),
+	};
+
+	for (auto& plane : planes)
+	{
+		plane /= glm::length(glm::vec3(plane));
+	}
+	return planes;
+}
+
+GpuCulling::GpuCulling(const std::filesystem::path& shadersDirectory) :
+	m_depthSampler(makePointSampler(MipmapMode::NONE)),
+	m_hiZSampler(makePointSampler(MipmapMode::NEAREST))
+{
+	m_cullProgram = ComputeProgram::make(shadersDirectory / "cull.cs.glsl");
+	m_compactProgram = ComputeProgram::make(shadersDirectory / "cull_compact.cs.glsl");
+	m_hiZDepthProgram = ComputeProgram::make(shadersDirectory / "hiz_depth.cs.glsl");
+	m_hiZDepthMultisampleProgram = ComputeProgram::make(shadersDirectory / "hiz_depth.cs.glsl", { "MULTISAMPLE" });
+	m_hiZReduceProgram = ComputeProgram::make(shadersDirectory / "hiz_reduce.cs.glsl");
+
+	m_drawCount.setData(BufferUsage::DYNAMIC_COPY, std::vector<GLuint>{ 0 });
+}
+
+void GpuCulling::setObjects(const std::vector<CullObject>& objects)
+{
+	if (!objects.empty() && objects.size() == m_objectsCount)
+	{
+		// reordered objects, e.g. a new front to back sort, the per-object buffers keep their storage
+		m_objects.setSubData(0, objects.data(), objects.data() + objects.size());
+		return;
+	}
+
+	m_objects.setData(BufferUsage::DYNAMIC_DRAW, objects);
+	m_visible.reserve(BufferUsage::DYNAMIC_COPY, objects.size());
+	m_commands.reserve(BufferUsage::DYNAMIC_COPY, objects.size());
+	m_objectsCount = objects.size();
+}
+
+void GpuCulling::allocateHiZ(GLsizei width, GLsizei height)
+{
+	m_hiZ = std::make_unique<MutableTexture>(MutableTexture::make2D(width, height, TextureDeviceFormat::R32F));
+	m_hiZ->bind(kTextureUnit);
+	m_hiZ->setHasMipmaps(true);
+
+	for (GLint level = 0; level < m_hiZ->levelsCount(); ++level)
+	{
+		m_hiZ->load({ TextureHostFormat::RED, TextureHostType::FLOAT, 4, nullptr }, level);
+	}
+}
+
+void GpuCulling::buildHiZ(const TextureBase& depth, const glm::mat4& viewProjection)
+{
+	// the first level already halves the resolution, a texel of level N covers 2^(N+1) depth texels
+	const auto width = (std::max)(1, depth.width() / 2);
+	const auto height = (std::max)(1, depth.height() / 2);
+	if (!m_hiZ || m_hiZ->width() != width || m_hiZ->height() != height)
+	{
+		allocateHiZ(width, height);
+	}
+
+	auto& depthProgram = depth.samples() > 0 ? *m_hiZDepthMultisampleProgram : *m_hiZDepthProgram;
+	depthProgram.bind();
+	depthProgram.program().setUniform("U_SOURCE", GLint(kTextureUnit));
+	if (depth.samples() > 0)
+	{
+		depthProgram.program().setUniform("U_SAMPLES", GLint(depth.samples()));
+	}
+	glActiveTexture(GL_TEXTURE0 + kTextureUnit);
+	glBindTexture(static_cast<GLenum>(depth.target()), depth.nativeHandle());
+	checkGl();
+	m_depthSampler.bind(kTextureUnit);
+
+	m_hiZ->bindImage(0, ImageAccess::WRITE_ONLY, 0);
+	depthProgram.dispatchThreads(GLuint(width), GLuint(height));
+
+	m_hiZReduceProgram->bind();
+	for (GLint level = 1; level < m_hiZ->levelsCount(); ++level)
+	{
+		ComputeProgram::memoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+		m_hiZ->bindImage(0, ImageAccess::WRITE_ONLY, level);
+		m_hiZ->bindImage(1, ImageAccess::READ_ONLY, level - 1);
+		m_hiZReduceProgram->dispatchThreads(GLuint((std::max)(1, width >> level)), GLuint((std::max)(1, height >> level)));
+	}
+
+	ComputeProgram::memoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+
+	m_hiZViewProjection = viewProjection;
+	m_hiZValid = true;
+}
+
+void GpuCulling::cull(const glm::mat4& viewProjection, bool occlusion)
+{
+	if (!GLEW_ARB_indirect_parameters)
+	{
+		m_commands.clear();
+	}
+
+	auto& program = m_cullProgram->program();
+	m_cullProgram->bind();
+
+	const auto planes = extractFrustumPlanes(viewProjection);
+	program.setUniformVec4Array("U_FRUSTUM_PLANES", glm::value_ptr(planes[0]), GLsizei(planes.size()));
+	program.setUniform("U_OBJECTS_COUNT", GLint(m_objectsCount));
+	occlusion = occlusion && m_hiZValid;
+	program.setUniform("U_OCCLUSION", occlusion);
+	if (occlusion)
+	{
+		program.setUniform("U_HIZ_VIEW_PROJECTION", m_hiZViewProjection);
+		program.setUniform("U_HIZ", GLint(kTextureUnit));
+		m_hiZ->bind(kTextureUnit);
+		m_hiZSampler.bind(kTextureUnit);
+	}
+
+	m_objects.bindBase(0);
+	m_visible.bindBase(1);
+	m_cullProgram->dispatchThreads(GLuint(m_objectsCount));
+	ComputeProgram::memoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+	// a single workgroup, the survivors keep the object order
+	m_compactProgram->program().setUniform("U_OBJECTS_COUNT", GLint(m_objectsCount));
+	m_compactProgram->bind();
+	m_commands.bindBase(BufferTarget::SHADER_STORAGE_BUFFER, 2);
+	m_drawCount.bindBase(3);
+	m_compactProgram->dispatch(1);
+	ComputeProgram::memoryBarrier(GL_COMMAND_BARRIER_BIT);
+}
+
+void GpuCulling::draw(GLenum indexType)
+{
+	m_commands.bind();
+
+	if (GLEW_ARB_indirect_parameters)
+	{
+		m_drawCount.bind(BufferTarget::PARAMETER_BUFFER);
+		glMultiDrawElementsIndirectCountARB(GL_TRIANGLES, indexType, nullptr, 0, GLsizei(m_objectsCount), 0);
+		checkGl();
+	}
+	else
+	{
+		glMultiDrawElementsIndirect(GL_TRIANGLES, indexType, nullptr, GLsizei(m_objectsCount), 0);
+		checkGl();
+	}
+}
+
+std::vector<const ShaderProgram*> GpuCulling::programs() const
+{
+	return { &m_cullProgram->program(), &m_compactProgram->program(), &m_hiZDepthProgram->program(), &m_hiZDepthMultisampleProgram->program(), &m_hiZReduceProgram->program() };
+}
+
+bool GpuCulling::isSupported() noexcept
+{
+	return ComputeProgram::isSupported() && (GLEW_VERSION_4_3 || GLEW_ARB_multi_draw_indirect);
+}
+
+}
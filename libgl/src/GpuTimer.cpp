@@ -0,0 +1,69 @@
+#include <GpuTimer.hpp>
+
+namespace libgl
+{
+
+GpuTimer::GpuTimer()
+{
+	glGenQueries(static_cast<GLsizei>(m_queries.size()), m_queries.data());
+	checkGl();
+}
+
+GpuTimer::~GpuTimer() noexcept
+{
+	glDeleteQueries(static_cast<GLsizei>(m_queries.size()), m_queries.data());
+	checkGl();
+}
+
+void GpuTimer::begin()
+{
+	if (m_pending == m_queries.size())
+	{
+		return;
+	}
+
+	glBeginQuery(GL_TIME_ELAPSED, m_queries[(m_first + m_pending) % m_queries.size()]);
+	checkGl();
+	m_active = true;
+}
+
+void GpuTimer::end()
+{
+	if (!m_active)
+	{
+		return;
+	}
+
+	glEndQuery(GL_TIME_ELAPSED);
+	checkGl();
+	m_active = false;
+	++m_pending;
+}
+
+std::optional<float> GpuTimer::takeMilliseconds()
+{
+	if (m_pending == 0)
+	{
+		return std::nullopt;
+	}
+
+	const auto query = m_queries[m_first];
+
+	GLint available = GL_FALSE;
+	glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+	checkGl();
+	if (!available)
+	{
+		return std::nullopt;
+	}
+
+	GLuint64 nanoseconds = 0;
+	glGetQueryObjectui64v(query, GL_QUERY_RESULT, &nanoseconds);
+	checkGl();
+
+	m_first = (m_first + 1) % m_queries.size();
+	--m_pending;
+	return static_cast<float>(nanoseconds / 1e6);
+}
+
+}
@@ -0,0 +1,700 @@
+#include <ImageKernels.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define LIBGL_X86_SIMD
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define LIBGL_TARGET_SSE41
+#define LIBGL_TARGET_AVX2
+#else
+#include <cpuid.h>
+#define LIBGL_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define LIBGL_TARGET_AVX2 __attribute__((target("avx2,f16c")))
+#endif
+#endif
+
+namespace libgl
+{
+
+//
+// linear -> sRGB encoding is a piecewise linear approximation indexed by the float exponent and
+// the 3 highest mantissa bits, 8 segments per octave in [2^-13, 1). The result is at most 1 off the
+// correctly rounded 8-bit value, and everything below 2^-13 encodes to zero anyway.
+//
+static constexpr std::uint32_t kEncodeMinBits = 0x39000000; // 2^-13
+static constexpr std::uint32_t kEncodeMaxBits = 0x3F7FFFFF; // 1 - ulp
+static constexpr std::uint32_t kEncodeSegments = (0x3F800000 - kEncodeMinBits) >> 20;
+static constexpr std::uint32_t kEncodeMantissaMask = 0xFFFFF;
+
+// pixels processed per chunk by the composite kernels, keeps the float scratch in L1
+static constexpr std::size_t kChunkPixels = 256;
+
+struct KernelTables
+{
+	float srgbToLinear[256];
+	float unormToFloat[256];
+	float encodeBase[kEncodeSegments];
+	float encodeSlope[kEncodeSegments];
+};
+
+struct Kernels
+{
+	SimdLevel level;
+	void (*unpackRGBA8)(const std::uint8_t*, float*, std::size_t, bool);
+	void (*packRGBA8)(const float*, std::uint8_t*, std::size_t, bool);
+	void (*unpackRGBA16F)(const std::uint16_t*, float*, std::size_t);
+	void (*packRGBA16F)(const float*, std::uint16_t*, std::size_t);
+	void (*downsampleRow)(const float*, const float*, std::uint32_t, float*);
+	void (*accumulate)(const float*, float, float*, std::size_t);
+	void (*premultiplyAlphaRGBA16F)(std::uint16_t*, std::size_t);
+	void (*premultiplyAlphaRGBA32F)(float*, std::size_t);
+};
+
+static float floatFromBits(std::uint32_t bits)
+{
+	float value;
+	std::memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+static std::uint32_t bitsFromFloat(float value)
+{
+	std::uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	return bits;
+}
+
+static float halfToFloat(std::uint16_t half)
+{
+	const auto sign = std::uint32_t(half & 0x8000) << 16;
+	const auto exponent = (half >> 10) & 0x1F;
+	const auto mantissa = std::uint32_t(half & 0x3FF);
+
+	if (exponent == 0x1F)
+	{
+		// signaling NaNs come out quiet, as from F16C
+		return floatFromBits(sign | 0x7F800000 | (mantissa << 13) | (mantissa ? 0x400000 : 0));
+	}
+	if (exponent == 0)
+	{
+		// subnormals are mantissa * 2^-24, exact in float
+		return floatFromBits(sign | bitsFromFloat(static_cast<float>(mantissa) * 5.9604644775390625e-8f));
+	}
+	return floatFromBits(sign | ((exponent + 112) << 23) | (mantissa << 13));
+}
+
+static std::uint16_t floatToHalf(float value)
+{
+	const auto bits = bitsFromFloat(value);
+	const auto sign = static_cast<std::uint16_t>((bits >> 16) & 0x8000);
+	const auto magnitude = bits & 0x7FFFFFFF;
+
+	if (magnitude >= 0x7F800000)
+	{
+		return static_cast<std::uint16_t>(sign | (magnitude > 0x7F800000 ? 0x7E00 | ((magnitude >> 13) & 0x3FF) : 0x7C00));
+	}
+	// 65520 is halfway between the largest half and the next power of two, ties go to the even infinity
+	if (magnitude >= 0x477FF000)
+	{
+		return static_cast<std::uint16_t>(sign | 0x7C00);
+	}
+
+	const auto exponent = magnitude >> 23;
+	if (exponent < 102)
+	{
+		// below 2^-25, half of the smallest subnormal
+		return sign;
+	}
+
+	// the dropped bits are rounded to nearest even, a carry moves into the exponent on its own
+	std::uint32_t result;
+	std::uint32_t remainder;
+	std::uint32_t halfway;
+	if (exponent < 113)
+	{
+		const auto shift = 126 - exponent;
+		const auto mantissa = (magnitude & 0x7FFFFF) | 0x800000;
+		result = mantissa >> shift;
+		remainder = mantissa & ((1u << shift) - 1);
+		halfway = 1u << (shift - 1);
+	}
+	else
+	{
+		result = (magnitude - 0x38000000) >> 13;
+		remainder = magnitude & 0x1FFF;
+		halfway = 0x1000;
+	}
+
+	if (remainder > halfway || (remainder == halfway && (result & 1)))
+	{
+		++result;
+	}
+	return static_cast<std::uint16_t>(sign | result);
+}
+
+static double srgbEncode(double value)
+{
+	return value <= 0.0031308 ? value * 12.92 : 1.055 * std::pow(value, 1.0 / 2.4) - 0.055;
+}
+
+static KernelTables makeTables()
+{
+	KernelTables tables;
+	for (int i = 0; i < 256; ++i)
+	{
+		const double value = i / 255.0;
+		tables.srgbToLinear[i] = static_cast<float>(value <= 0.04045 ? value / 12.92 : std::pow((value + 0.055) / 1.055, 2.4));
+		tables.unormToFloat[i] = static_cast<float>(value);
+	}
+
+	for (std::uint32_t i = 0; i < kEncodeSegments; ++i)
+	{
+		const double begin = floatFromBits(kEncodeMinBits + (i << 20));
+		const double end = floatFromBits(kEncodeMinBits + ((i + 1) << 20));
+		tables.encodeBase[i] = static_cast<float>(srgbEncode(begin) * 255.0);
+		tables.encodeSlope[i] = static_cast<float>((srgbEncode(end) - srgbEncode(begin)) * 255.0 / (kEncodeMantissaMask + 1));
+	}
+
+	return tables;
+}
+
+static const KernelTables& tables()
+{
+	static const KernelTables instance = makeTables();
+	return instance;
+}
+
+static std::uint8_t encodeUnorm(float value)
+{
+	// written so that NaN ends up as zero, the same way the SIMD max/min pairs treat it
+	value = value > 0.0f ? value : 0.0f;
+	value = value < 1.0f ? value : 1.0f;
+	return static_cast<std::uint8_t>(value * 255.0f + 0.5f);
+}
+
+static std::uint8_t encodeSrgb(float value, const KernelTables& tables)
+{
+	const auto minValue = floatFromBits(kEncodeMinBits);
+	const auto maxValue = floatFromBits(kEncodeMaxBits);
+	value = value > minValue ? value : minValue;
+	value = value < maxValue ? value : maxValue;
+
+	const auto bits = bitsFromFloat(value);
+	const auto segment = (bits - kEncodeMinBits) >> 20;
+	const auto fraction = static_cast<float>(bits & kEncodeMantissaMask);
+	return static_cast<std::uint8_t>(tables.encodeBase[segment] + tables.encodeSlope[segment] * fraction + 0.5f);
+}
+
+static void unpackRGBA8Scalar(const std::uint8_t* src, float* dst, std::size_t pixelsCount, bool srgb)
+{
+	const auto& t = tables();
+	const float* colorTable = srgb ? t.srgbToLinear : t.unormToFloat;
+	for (std::size_t i = 0; i < pixelsCount * 4; i += 4)
+	{
+		dst[i + 0] = colorTable[src[i + 0]];
+		dst[i + 1] = colorTable[src[i + 1]];
+		dst[i + 2] = colorTable[src[i + 2]];
+		dst[i + 3] = t.unormToFloat[src[i + 3]];
+	}
+}
+
+static void packRGBA8Scalar(const float* src, std::uint8_t* dst, std::size_t pixelsCount, bool srgb)
+{
+	const auto& t = tables();
+	for (std::size_t i = 0; i < pixelsCount * 4; i += 4)
+	{
+		for (std::size_t c = 0; c < 3; ++c)
+		{
+			dst[i + c] = srgb ? encodeSrgb(src[i + c], t) : encodeUnorm(src[i + c]);
+		}
+		dst[i + 3] = encodeUnorm(src[i + 3]);
+	}
+}
+
+static void unpackRGBA16FScalar(const std::uint16_t* src, float* dst, std::size_t pixelsCount)
+{
+	for (std::size_t i = 0; i < pixelsCount * 4; ++i)
+	{
+		dst[i] = halfToFloat(src[i]);
+	}
+}
+
+static void packRGBA16FScalar(const float* src, std::uint16_t* dst, std::size_t pixelsCount)
+{
+	for (std::size_t i = 0; i < pixelsCount * 4; ++i)
+	{
+		dst[i] = floatToHalf(src[i]);
+	}
+}
+
+static void downsamplePixel(const float* row0, const float* row1, std::uint32_t width, std::uint32_t x, float* dst)
+{
+	const auto x0 = std::size_t(x) * 2 * 4;
+	const auto x1 = std::size_t((std::min)(x * 2 + 1, width - 1)) * 4;
+	for (std::size_t c = 0; c < 4; ++c)
+	{
+		dst[c] = ((row0[x0 + c] + row1[x0 + c]) + (row0[x1 + c] + row1[x1 + c])) * 0.25f;
+	}
+}
+
+static void downsampleRowScalar(const float* row0, const float* row1, std::uint32_t width, float* dst)
+{
+	const auto dstWidth = (std::max)(1u, width / 2);
+	for (std::uint32_t x = 0; x < dstWidth; ++x)
+	{
+		downsamplePixel(row0, row1, width, x, dst + std::size_t(x) * 4);
+	}
+}
+
+static void accumulateScalar(const float* src, float weight, float* dst, std::size_t pixelsCount)
+{
+	for (std::size_t i = 0; i < pixelsCount * 4; ++i)
+	{
+		dst[i] += src[i] * weight;
+	}
+}
+
+static void premultiplyAlphaRGBA16FScalar(std::uint16_t* pixels, std::size_t pixelsCount)
+{
+	for (std::size_t i = 0; i < pixelsCount * 4; i += 4)
+	{
+		const auto alpha = halfToFloat(pixels[i + 3]);
+		for (std::size_t c = 0; c < 3; ++c)
+		{
+			pixels[i + c] = floatToHalf(halfToFloat(pixels[i + c]) * alpha);
+		}
+	}
+}
+
+static void premultiplyAlphaRGBA32FScalar(float* pixels, std::size_t pixelsCount)
+{
+	for (std::size_t i = 0; i < pixelsCount * 4; i += 4)
+	{
+		pixels[i + 0] *= pixels[i + 3];
+		pixels[i + 1] *= pixels[i + 3];
+		pixels[i + 2] *= pixels[i + 3];
+	}
+}
+
+#ifdef LIBGL_X86_SIMD
+
+LIBGL_TARGET_SSE41 static void unpackRGBA8Sse41(const std::uint8_t* src, float* dst, std::size_t pixelsCount, bool srgb)
+{
+	// SSE has no gathers, the table lookups stay scalar but the stores are full width
+	const auto& t = tables();
+	const float* colorTable = srgb ? t.srgbToLinear : t.unormToFloat;
+	for (std::size_t i = 0; i < pixelsCount * 4; i += 4)
+	{
+		_mm_storeu_ps(dst + i, _mm_setr_ps(colorTable[src[i + 0]], colorTable[src[i + 1]], colorTable[src[i + 2]], t.unormToFloat[src[i + 3]]));
+	}
+}
+
+LIBGL_TARGET_SSE41 static __m128i encodePixelSse41(__m128 value, bool srgb, const KernelTables& t)
+{
+	const auto zero = _mm_setzero_ps();
+	const auto one = _mm_set1_ps(1.0f);
+	const auto half = _mm_set1_ps(0.5f);
+
+	const auto unorm = _mm_add_ps(_mm_mul_ps(_mm_min_ps(_mm_max_ps(value, zero), one), _mm_set1_ps(255.0f)), half);
+	if (!srgb)
+	{
+		return _mm_cvttps_epi32(unorm);
+	}
+
+	const auto clamped = _mm_min_ps(_mm_max_ps(value, _mm_set1_ps(floatFromBits(kEncodeMinBits))), _mm_set1_ps(floatFromBits(kEncodeMaxBits)));
+	const auto bits = _mm_castps_si128(clamped);
+	const auto segment = _mm_srli_epi32(_mm_sub_epi32(bits, _mm_set1_epi32(static_cast<int>(kEncodeMinBits))), 20);
+	const auto fraction = _mm_cvtepi32_ps(_mm_and_si128(bits, _mm_set1_epi32(static_cast<int>(kEncodeMantissaMask))));
+
+	const auto s0 = _mm_extract_epi32(segment, 0);
+	const auto s1 = _mm_extract_epi32(segment, 1);
+	const auto s2 = _mm_extract_epi32(segment, 2);
+	const auto base = _mm_setr_ps(t.encodeBase[s0], t.encodeBase[s1], t.encodeBase[s2], 0.0f);
+	const auto slope = _mm_setr_ps(t.encodeSlope[s0], t.encodeSlope[s1], t.encodeSlope[s2], 0.0f);
+	const auto encoded = _mm_add_ps(_mm_add_ps(base, _mm_mul_ps(slope, fraction)), half);
+
+	return _mm_cvttps_epi32(_mm_blend_ps(encoded, unorm, 0x8));
+}
+
+LIBGL_TARGET_SSE41 static void packRGBA8Sse41(const float* src, std::uint8_t* dst, std::size_t pixelsCount, bool srgb)
+{
+	const auto& t = tables();
+	for (std::size_t i = 0; i < pixelsCount * 4; i += 4)
+	{
+		const auto ints = encodePixelSse41(_mm_loadu_ps(src + i), srgb, t);
+		const auto words = _mm_packus_epi32(ints, ints);
+		const auto bytes = _mm_packus_epi16(words, words);
+		const auto packed = _mm_cvtsi128_si32(bytes);
+		std::memcpy(dst + i, &packed, 4);
+	}
+}
+
+LIBGL_TARGET_SSE41 static void downsampleRowSse41(const float* row0, const float* row1, std::uint32_t width, float* dst)
+{
+	const auto quarter = _mm_set1_ps(0.25f);
+	const auto dstWidth = (std::max)(1u, width / 2);
+
+	std::uint32_t x = 0;
+	for (; x < dstWidth && x * 2 + 2 <= width; ++x)
+	{
+		const auto offset = std::size_t(x) * 8;
+		const auto left = _mm_add_ps(_mm_loadu_ps(row0 + offset), _mm_loadu_ps(row1 + offset));
+		const auto right = _mm_add_ps(_mm_loadu_ps(row0 + offset + 4), _mm_loadu_ps(row1 + offset + 4));
+		_mm_storeu_ps(dst + std::size_t(x) * 4, _mm_mul_ps(_mm_add_ps(left, right), quarter));
+	}
+
+	for (; x < dstWidth; ++x)
+	{
+		downsamplePixel(row0, row1, width, x, dst + std::size_t(x) * 4);
+	}
+}
+
+// multiply and add stay separate (no FMA), so every path rounds like the scalar one
+LIBGL_TARGET_SSE41 static void accumulateSse41(const float* src, float weight, float* dst, std::size_t pixelsCount)
+{
+	const auto scale = _mm_set1_ps(weight);
+	for (std::size_t i = 0; i < pixelsCount; ++i)
+	{
+		const auto offset = i * 4;
+		_mm_storeu_ps(dst + offset, _mm_add_ps(_mm_loadu_ps(dst + offset), _mm_mul_ps(_mm_loadu_ps(src + offset), scale)));
+	}
+}
+
+LIBGL_TARGET_SSE41 static void premultiplyAlphaRGBA32FSse41(float* pixels, std::size_t pixelsCount)
+{
+	for (std::size_t i = 0; i < pixelsCount * 4; i += 4)
+	{
+		const auto value = _mm_loadu_ps(pixels + i);
+		const auto alpha = _mm_shuffle_ps(value, value, _MM_SHUFFLE(3, 3, 3, 3));
+		_mm_storeu_ps(pixels + i, _mm_blend_ps(_mm_mul_ps(value, alpha), value, 0x8));
+	}
+}
+
+LIBGL_TARGET_AVX2 static void unpackRGBA8Avx2(const std::uint8_t* src, float* dst, std::size_t pixelsCount, bool srgb)
+{
+	const auto& t = tables();
+	const float* colorTable = srgb ? t.srgbToLinear : t.unormToFloat;
+
+	std::size_t i = 0;
+	for (; i + 2 <= pixelsCount; i += 2)
+	{
+		const auto indices = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i * 4)));
+		const auto color = _mm256_i32gather_ps(colorTable, indices, 4);
+		const auto alpha = _mm256_i32gather_ps(t.unormToFloat, indices, 4);
+		_mm256_storeu_ps(dst + i * 4, _mm256_blend_ps(color, alpha, 0x88));
+	}
+
+	unpackRGBA8Scalar(src + i * 4, dst + i * 4, pixelsCount - i, srgb);
+}
+
+LIBGL_TARGET_AVX2 static void packRGBA8Avx2(const float* src, std::uint8_t* dst, std::size_t pixelsCount, bool srgb)
+{
+	const auto& t = tables();
+	const auto zero = _mm256_setzero_ps();
+	const auto one = _mm256_set1_ps(1.0f);
+	const auto half = _mm256_set1_ps(0.5f);
+	const auto scale = _mm256_set1_ps(255.0f);
+	const auto minValue = _mm256_set1_ps(floatFromBits(kEncodeMinBits));
+	const auto maxValue = _mm256_set1_ps(floatFromBits(kEncodeMaxBits));
+	const auto minBits = _mm256_set1_epi32(static_cast<int>(kEncodeMinBits));
+	const auto mantissaMask = _mm256_set1_epi32(static_cast<int>(kEncodeMantissaMask));
+
+	std::size_t i = 0;
+	for (; i + 2 <= pixelsCount; i += 2)
+	{
+		const auto value = _mm256_loadu_ps(src + i * 4);
+		auto result = _mm256_add_ps(_mm256_mul_ps(_mm256_min_ps(_mm256_max_ps(value, zero), one), scale), half);
+
+		if (srgb)
+		{
+			const auto bits = _mm256_castps_si256(_mm256_min_ps(_mm256_max_ps(value, minValue), maxValue));
+			const auto segment = _mm256_srli_epi32(_mm256_sub_epi32(bits, minBits), 20);
+			const auto fraction = _mm256_cvtepi32_ps(_mm256_and_si256(bits, mantissaMask));
+			const auto base = _mm256_i32gather_ps(t.encodeBase, segment, 4);
+			const auto slope = _mm256_i32gather_ps(t.encodeSlope, segment, 4);
+			const auto encoded = _mm256_add_ps(_mm256_add_ps(base, _mm256_mul_ps(slope, fraction)), half);
+			result = _mm256_blend_ps(encoded, result, 0x88);
+		}
+
+		const auto ints = _mm256_cvttps_epi32(result);
+		const auto words = _mm_packus_epi32(_mm256_castsi256_si128(ints), _mm256_extracti128_si256(ints, 1));
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(dst + i * 4), _mm_packus_epi16(words, words));
+	}
+
+	packRGBA8Scalar(src + i * 4, dst + i * 4, pixelsCount - i, srgb);
+}
+
+LIBGL_TARGET_AVX2 static void unpackRGBA16FAvx2(const std::uint16_t* src, float* dst, std::size_t pixelsCount)
+{
+	std::size_t i = 0;
+	for (; i + 2 <= pixelsCount; i += 2)
+	{
+		_mm256_storeu_ps(dst + i * 4, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4))));
+	}
+
+	unpackRGBA16FScalar(src + i * 4, dst + i * 4, pixelsCount - i);
+}
+
+LIBGL_TARGET_AVX2 static void packRGBA16FAvx2(const float* src, std::uint16_t* dst, std::size_t pixelsCount)
+{
+	std::size_t i = 0;
+	for (; i + 2 <= pixelsCount; i += 2)
+	{
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), _mm256_cvtps_ph(_mm256_loadu_ps(src + i * 4), _MM_FROUND_TO_NEAREST_INT));
+	}
+
+	packRGBA16FScalar(src + i * 4, dst + i * 4, pixelsCount - i);
+}
+
+LIBGL_TARGET_AVX2 static void downsampleRowAvx2(const float* row0, const float* row1, std::uint32_t width, float* dst)
+{
+	const auto quarter = _mm256_set1_ps(0.25f);
+	const auto dstWidth = (std::max)(1u, width / 2);
+
+	// two destination pixels out of four source ones per iteration
+	std::uint32_t x = 0;
+	for (; x + 2 <= dstWidth && x * 2 + 4 <= width; x += 2)
+	{
+		const auto offset = std::size_t(x) * 8;
+		const auto first = _mm256_add_ps(_mm256_loadu_ps(row0 + offset), _mm256_loadu_ps(row1 + offset));
+		const auto second = _mm256_add_ps(_mm256_loadu_ps(row0 + offset + 8), _mm256_loadu_ps(row1 + offset + 8));
+		const auto left = _mm256_permute2f128_ps(first, second, 0x20);
+		const auto right = _mm256_permute2f128_ps(first, second, 0x31);
+		_mm256_storeu_ps(dst + std::size_t(x) * 4, _mm256_mul_ps(_mm256_add_ps(left, right), quarter));
+	}
+
+	for (; x < dstWidth; ++x)
+	{
+		downsamplePixel(row0, row1, width, x, dst + std::size_t(x) * 4);
+	}
+}
+
+LIBGL_TARGET_AVX2 static void accumulateAvx2(const float* src, float weight, float* dst, std::size_t pixelsCount)
+{
+	const auto scale = _mm256_set1_ps(weight);
+
+	std::size_t i = 0;
+	for (; i + 2 <= pixelsCount; i += 2)
+	{
+		const auto offset = i * 4;
+		_mm256_storeu_ps(dst + offset, _mm256_add_ps(_mm256_loadu_ps(dst + offset), _mm256_mul_ps(_mm256_loadu_ps(src + offset), scale)));
+	}
+
+	accumulateScalar(src + i * 4, weight, dst + i * 4, pixelsCount - i);
+}
+
+LIBGL_TARGET_AVX2 static void premultiplyAlphaRGBA16FAvx2(std::uint16_t* pixels, std::size_t pixelsCount)
+{
+	std::size_t i = 0;
+	for (; i + 2 <= pixelsCount; i += 2)
+	{
+		auto* address = reinterpret_cast<__m128i*>(pixels + i * 4);
+		const auto value = _mm256_cvtph_ps(_mm_loadu_si128(address));
+		const auto alpha = _mm256_permute_ps(value, _MM_SHUFFLE(3, 3, 3, 3));
+		const auto result = _mm256_blend_ps(_mm256_mul_ps(value, alpha), value, 0x88);
+		_mm_storeu_si128(address, _mm256_cvtps_ph(result, _MM_FROUND_TO_NEAREST_INT));
+	}
+
+	premultiplyAlphaRGBA16FScalar(pixels + i * 4, pixelsCount - i);
+}
+
+LIBGL_TARGET_AVX2 static void premultiplyAlphaRGBA32FAvx2(float* pixels, std::size_t pixelsCount)
+{
+	std::size_t i = 0;
+	for (; i + 2 <= pixelsCount; i += 2)
+	{
+		const auto value = _mm256_loadu_ps(pixels + i * 4);
+		const auto alpha = _mm256_permute_ps(value, _MM_SHUFFLE(3, 3, 3, 3));
+		_mm256_storeu_ps(pixels + i * 4, _mm256_blend_ps(_mm256_mul_ps(value, alpha), value, 0x88));
+	}
+
+	premultiplyAlphaRGBA32FScalar(pixels + i * 4, pixelsCount - i);
+}
+
+static SimdLevel detectSimdLevel()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+	int info[4];
+	__cpuid(info, 0);
+	const auto maxLeaf = info[0];
+
+	__cpuid(info, 1);
+	const bool sse41 = info[2] & (1 << 19);
+	const bool osxsave = info[2] & (1 << 27);
+	const bool f16c = info[2] & (1 << 29);
+
+	bool avx2 = false;
+	if (maxLeaf >= 7 && osxsave && (_xgetbv(0) & 6) == 6)
+	{
+		__cpuidex(info, 7, 0);
+		avx2 = info[1] & (1 << 5);
+	}
+#else
+	__builtin_cpu_init();
+	const bool sse41 = __builtin_cpu_supports("sse4.1");
+	const bool avx2 = __builtin_cpu_supports("avx2");
+
+	unsigned eax, ebx, ecx, edx;
+	const bool f16c = __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_F16C);
+#endif
+
+	if (avx2 && f16c)
+	{
+		return SimdLevel::AVX2;
+	}
+	return sse41 ? SimdLevel::SSE41 : SimdLevel::SCALAR;
+}
+
+#endif // LIBGL_X86_SIMD
+
+static Kernels selectKernels()
+{
+	Kernels kernels{
+		SimdLevel::SCALAR,
+		unpackRGBA8Scalar,
+		packRGBA8Scalar,
+		unpackRGBA16FScalar,
+		packRGBA16FScalar,
+		downsampleRowScalar,
+		accumulateScalar,
+		premultiplyAlphaRGBA16FScalar,
+		premultiplyAlphaRGBA32FScalar };
+
+#ifdef LIBGL_X86_SIMD
+	switch (detectSimdLevel())
+	{
+	case SimdLevel::AVX2:
+		kernels = {
+			SimdLevel::AVX2,
+			unpackRGBA8Avx2,
+			packRGBA8Avx2,
+			unpackRGBA16FAvx2,
+			packRGBA16FAvx2,
+			downsampleRowAvx2,
+			accumulateAvx2,
+			premultiplyAlphaRGBA16FAvx2,
+			premultiplyAlphaRGBA32FAvx2 };
+		break;
+	case SimdLevel::SSE41:
+		kernels = {
+			SimdLevel::SSE41,
+			unpackRGBA8Sse41,
+			packRGBA8Sse41,
+			// half conversions need F16C, which only comes with the AVX2 path
+			unpackRGBA16FScalar,
+			packRGBA16FScalar,
+			downsampleRowSse41,
+			accumulateSse41,
+			premultiplyAlphaRGBA16FScalar,
+			premultiplyAlphaRGBA32FSse41 };
+		break;
+	case SimdLevel::SCALAR:
+		break;
+	}
+#endif
+
+	return kernels;
+}
+
+static const Kernels& kernels()
+{
+	static const Kernels instance = selectKernels();
+	return instance;
+}
+
+SimdLevel imageKernelsSimdLevel() noexcept
+{
+	return kernels().level;
+}
+
+void unpackRGBA8(const std::uint8_t* src, float* dst, std::size_t pixelsCount, bool srgb)
+{
+	kernels().unpackRGBA8(src, dst, pixelsCount, srgb);
+}
+
+void packRGBA8(const float* src, std::uint8_t* dst, std::size_t pixelsCount, bool srgb)
+{
+	kernels().packRGBA8(src, dst, pixelsCount, srgb);
+}
+
+void unpackRGBA16F(const std::uint16_t* src, float* dst, std::size_t pixelsCount)
+{
+	kernels().unpackRGBA16F(src, dst, pixelsCount);
+}
+
+void packRGBA16F(const float* src, std::uint16_t* dst, std::size_t pixelsCount)
+{
+	kernels().packRGBA16F(src, dst, pixelsCount);
+}
+
+void downsampleRGBA32F(const float* src, std::uint32_t width, std::uint32_t height, float* dst)
+{
+	const auto& table = kernels();
+	const auto dstWidth = (std::max)(1u, width / 2);
+	const auto dstHeight = (std::max)(1u, height / 2);
+
+	for (std::uint32_t y = 0; y < dstHeight; ++y)
+	{
+		const auto* row0 = src + std::size_t(y * 2) * width * 4;
+		const auto* row1 = src + std::size_t((std::min)(y * 2 + 1, height - 1)) * width * 4;
+		table.downsampleRow(row0, row1, width, dst + std::size_t(y) * dstWidth * 4);
+	}
+}
+
+void downsampleRGBA16F(const std::uint16_t* src, std::uint32_t width, std::uint32_t height, std::uint16_t* dst)
+{
+	const auto& table = kernels();
+	const auto dstWidth = (std::max)(1u, width / 2);
+	const auto dstHeight = (std::max)(1u, height / 2);
+
+	// two source rows and one destination row in float, the image itself is never widened
+	std::vector<float> rows(std::size_t(width) * 4 * 2 + std::size_t(dstWidth) * 4);
+	auto* row0 = rows.data();
+	auto* row1 = row0 + std::size_t(width) * 4;
+	auto* dstRow = row1 + std::size_t(width) * 4;
+
+	for (std::uint32_t y = 0; y < dstHeight; ++y)
+	{
+		table.unpackRGBA16F(src + std::size_t(y * 2) * width * 4, row0, width);
+		table.unpackRGBA16F(src + std::size_t((std::min)(y * 2 + 1, height - 1)) * width * 4, row1, width);
+		table.downsampleRow(row0, row1, width, dstRow);
+		table.packRGBA16F(dstRow, dst + std::size_t(y) * dstWidth * 4, dstWidth);
+	}
+}
+
+void accumulateRGBA32F(const float* src, float weight, float* dst, std::size_t pixelsCount)
+{
+	kernels().accumulate(src, weight, dst, pixelsCount);
+}
+
+void premultiplyAlphaRGBA8(std::uint8_t* pixels, std::size_t pixelsCount, bool srgb)
+{
+	const auto& table = kernels();
+
+	float scratch[kChunkPixels * 4];
+	for (std::size_t i = 0; i < pixelsCount; i += kChunkPixels)
+	{
+		const auto count = (std::min)(kChunkPixels, pixelsCount - i);
+		table.unpackRGBA8(pixels + i * 4, scratch, count, srgb);
+		table.premultiplyAlphaRGBA32F(scratch, count);
+		table.packRGBA8(scratch, pixels + i * 4, count, srgb);
+	}
+}
+
+void premultiplyAlphaRGBA16F(std::uint16_t* pixels, std::size_t pixelsCount)
+{
+	kernels().premultiplyAlphaRGBA16F(pixels, pixelsCount);
+}
+
+void premultiplyAlphaRGBA32F(float* pixels, std::size_t pixelsCount)
+{
+	kernels().premultiplyAlphaRGBA32F(pixels, pixelsCount);
+}
+
+}
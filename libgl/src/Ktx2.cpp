@@ -0,0 +1,355 @@
+#include <Ktx2.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace libgl
+{
+
+static constexpr std::uint8_t kIdentifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+static constexpr std::size_t kHeaderSize = 80;
+static constexpr std::size_t kLevelIndexEntrySize = 24;
+
+// Data Format Descriptor constants
+// https://registry.khronos.org/DataFormat/specs/1.3/dataformat.1.3.html
+static constexpr std::uint8_t kModelRGBSDA = 1;
+static constexpr std::uint8_t kModelBC1A = 128;
+static constexpr std::uint8_t kModelBC7 = 134;
+static constexpr std::uint8_t kPrimariesBT709 = 1;
+static constexpr std::uint8_t kTransferLinear = 1;
+static constexpr std::uint8_t kTransferSRGB = 2;
+static constexpr std::uint8_t kSampleLinear = 0x10;
+
+static void putU8(std::vector<std::uint8_t>& out, std::uint8_t value)
+{
+	out.push_back(value);
+}
+
+static void putU16(std::vector<std::uint8_t>& out, std::uint16_t value)
+{
+	out.push_back(static_cast<std::uint8_t>(value));
+	out.push_back(static_cast<std::uint8_t>(value >> 8));
+}
+
+static void putU32(std::vector<std::uint8_t>& out, std::uint32_t value)
+{
+	putU16(out, static_cast<std::uint16_t>(value));
+	putU16(out, static_cast<std::uint16_t>(value >> 16));
+}
+
+static void putU64(std::vector<std::uint8_t>& out, std::uint64_t value)
+{
+	putU32(out, static_cast<std::uint32_t>(value));
+	putU32(out, static_cast<std::uint32_t>(value >> 32));
+}
+
+static void padTo(std::vector<std::uint8_t>& out, std::size_t alignment)
+{
+	while (out.size() % alignment)
+	{
+		out.push_back(0);
+	}
+}
+
+static std::uint32_t getU32(const std::vector<std::uint8_t>& bytes, std::size_t offset)
+{
+	if (offset + 4 > bytes.size())
+	{
+		throw std::invalid_argument("KTX2: unexpected end of file");
+	}
+
+	return std::uint32_t(bytes[offset])
+		| std::uint32_t(bytes[offset + 1]) << 8
+		| std::uint32_t(bytes[offset + 2]) << 16
+		| std::uint32_t(bytes[offset + 3]) << 24;
+}
+
+static std::uint64_t getU64(const std::vector<std::uint8_t>& bytes, std::size_t offset)
+{
+	return std::uint64_t(getU32(bytes, offset)) | std::uint64_t(getU32(bytes, offset + 4)) << 32;
+}
+
+static bool isKnownFormat(std::uint32_t vkFormat)
+{
+	switch (static_cast<Ktx2Format>(vkFormat))
+	{
+	case Ktx2Format::R8G8B8A8_UNORM:
+	case Ktx2Format::R8G8B8A8_SRGB:
+	case Ktx2Format::BC1_RGBA_UNORM:
+	case Ktx2Format::BC1_RGBA_SRGB:
+	case Ktx2Format::BC7_UNORM:
+	case Ktx2Format::BC7_SRGB:
+		return true;
+	}
+	return false;
+}
+
+static void putSample(std::vector<std::uint8_t>& out, std::uint16_t bitOffset, std::uint8_t bitLength, std::uint8_t channelType, std::uint32_t upper)
+{
+	putU16(out, bitOffset);
+	putU8(out, static_cast<std::uint8_t>(bitLength - 1));
+	putU8(out, channelType);
+	putU32(out, 0); // samplePosition
+	putU32(out, 0); // sampleLower
+	putU32(out, upper);
+}
+
+static std::vector<std::uint8_t> makeDataFormatDescriptor(Ktx2Format format)
+{
+	const bool compressed = Ktx2Container::isCompressed(format);
+	const std::uint16_t samplesCount = compressed ? 1 : 4;
+
+	std::vector<std::uint8_t> block;
+	putU32(block, 0); // vendorId = KHRONOS, descriptorType = BASICFORMAT
+	putU16(block, 2); // versionNumber
+	putU16(block, static_cast<std::uint16_t>(24 + 16 * samplesCount));
+
+	switch (format)
+	{
+	case Ktx2Format::BC1_RGBA_UNORM:
+	case Ktx2Format::BC1_RGBA_SRGB:
+		putU8(block, kModelBC1A);
+		break;
+	case Ktx2Format::BC7_UNORM:
+	case Ktx2Format::BC7_SRGB:
+		putU8(block, kModelBC7);
+		break;
+	default:
+		putU8(block, kModelRGBSDA);
+	}
+
+	putU8(block, kPrimariesBT709);
+	putU8(block, Ktx2Container::isSrgb(format) ? kTransferSRGB : kTransferLinear);
+	putU8(block, 0); // straight alpha
+
+	const std::uint8_t blockDimension = compressed ? 3 : 0;
+	putU8(block, blockDimension);
+	putU8(block, blockDimension);
+	putU8(block, 0);
+	putU8(block, 0);
+
+	putU8(block, static_cast<std::uint8_t>(Ktx2Container::blockBytes(format)));
+	for (int i = 1; i < 8; ++i)
+	{
+		putU8(block, 0);
+	}
+
+	switch (format)
+	{
+	case Ktx2Format::BC1_RGBA_UNORM:
+	case Ktx2Format::BC1_RGBA_SRGB:
+		putSample(block, 0, 64, 1, 0xFFFFFFFFu); // KHR_DF_CHANNEL_BC1A_ALPHA
+		break;
+	case Ktx2Format::BC7_UNORM:
+	case Ktx2Format::BC7_SRGB:
+		putSample(block, 0, 128, 0, 0xFFFFFFFFu); // KHR_DF_CHANNEL_BC7_COLOR
+		break;
+	default:
+		putSample(block, 0, 8, 0, 255);
+		putSample(block, 8, 8, 1, 255);
+		putSample(block, 16, 8, 2, 255);
+		putSample(block, 24, 8, 15 | (Ktx2Container::isSrgb(format) ? kSampleLinear : 0), 255);
+	}
+
+	std::vector<std::uint8_t> result;
+	putU32(result, static_cast<std::uint32_t>(4 + block.size()));
+	result.insert(result.end(), block.cbegin(), block.cend());
+	return result;
+}
+
+static std::vector<std::uint8_t> makeKeyValueData()
+{
+	static constexpr char kKey[] = "KTXwriter";
+	static constexpr char kValue[] = "libgl";
+
+	std::vector<std::uint8_t> result;
+	putU32(result, static_cast<std::uint32_t>(sizeof(kKey) + sizeof(kValue)));
+	result.insert(result.end(), kKey, kKey + sizeof(kKey));
+	result.insert(result.end(), kValue, kValue + sizeof(kValue));
+	padTo(result, 4);
+	return result;
+}
+
+Ktx2Container::Ktx2Container(Ktx2Format format, std::uint32_t width, std::uint32_t height) :
+	m_format(format),
+	m_width(width),
+	m_height(height)
+{
+	if (width == 0 || height == 0)
+	{
+		throw std::invalid_argument("KTX2: empty image");
+	}
+}
+
+void Ktx2Container::addLevel(std::vector<std::uint8_t> data)
+{
+	const auto index = static_cast<std::uint32_t>(m_levels.size());
+	const auto levelWidth = (std::max)(1u, m_width >> index);
+	const auto levelHeight = (std::max)(1u, m_height >> index);
+
+	if ((m_width >> index) == 0 && (m_height >> index) == 0)
+	{
+		throw std::invalid_argument("KTX2: too many levels");
+	}
+
+	if (data.size() != levelBytes(m_format, levelWidth, levelHeight))
+	{
+		throw std::invalid_argument("KTX2: incorrect level size");
+	}
+
+	m_levels.emplace_back(std::move(data));
+}
+
+std::vector<std::uint8_t> Ktx2Container::serialize() const
+{
+	if (m_levels.empty())
+	{
+		throw std::logic_error("KTX2: no levels to serialize");
+	}
+
+	const auto dfd = makeDataFormatDescriptor(m_format);
+	const auto kvd = makeKeyValueData();
+
+	const std::size_t levelIndexSize = kLevelIndexEntrySize * m_levels.size();
+	const std::size_t dfdOffset = kHeaderSize + levelIndexSize;
+	const std::size_t kvdOffset = dfdOffset + dfd.size();
+	// lcm(texel block size, 4), all supported block sizes are multiples of 4
+	const std::size_t levelAlignment = blockBytes(m_format);
+
+	// mip levels are stored from the smallest to the largest one
+	std::vector<std::uint8_t> payload;
+	std::vector<std::uint64_t> levelOffsets(m_levels.size());
+	std::size_t payloadStart = kvdOffset + kvd.size();
+	payloadStart += (levelAlignment - payloadStart % levelAlignment) % levelAlignment;
+
+	for (auto i = m_levels.size(); i-- > 0;)
+	{
+		while ((payloadStart + payload.size()) % levelAlignment)
+		{
+			payload.push_back(0);
+		}
+		levelOffsets[i] = payloadStart + payload.size();
+		payload.insert(payload.end(), m_levels[i].cbegin(), m_levels[i].cend());
+	}
+
+	std::vector<std::uint8_t> result;
+	result.reserve(payloadStart + payload.size());
+	result.insert(result.end(), std::begin(kIdentifier), std::end(kIdentifier));
+
+	putU32(result, static_cast<std::uint32_t>(m_format));
+	putU32(result, 1); // typeSize
+	putU32(result, m_width);
+	putU32(result, m_height);
+	putU32(result, 0); // pixelDepth
+	putU32(result, 0); // layerCount
+	putU32(result, 1); // faceCount
+	putU32(result, static_cast<std::uint32_t>(m_levels.size()));
+	putU32(result, 0); // supercompressionScheme
+
+	putU32(result, static_cast<std::uint32_t>(dfdOffset));
+	putU32(result, static_cast<std::uint32_t>(dfd.size()));
+	putU32(result, static_cast<std::uint32_t>(kvdOffset));
+	putU32(result, static_cast<std::uint32_t>(kvd.size()));
+	putU64(result, 0); // sgdByteOffset
+	putU64(result, 0); // sgdByteLength
+
+	for (std::size_t i = 0; i < m_levels.size(); ++i)
+	{
+		putU64(result, levelOffsets[i]);
+		putU64(result, m_levels[i].size());
+		putU64(result, m_levels[i].size());
+	}
+
+	result.insert(result.end(), dfd.cbegin(), dfd.cend());
+	result.insert(result.end(), kvd.cbegin(), kvd.cend());
+	result.resize(payloadStart, 0);
+	result.insert(result.end(), payload.cbegin(), payload.cend());
+
+	return result;
+}
+
+Ktx2Container Ktx2Container::parse(const std::vector<std::uint8_t>& bytes)
+{
+	if (bytes.size() < kHeaderSize || !std::equal(std::begin(kIdentifier), std::end(kIdentifier), bytes.cbegin()))
+	{
+		throw std::invalid_argument("KTX2: invalid identifier");
+	}
+
+	const auto vkFormat = getU32(bytes, 12);
+	const auto width = getU32(bytes, 20);
+	const auto height = getU32(bytes, 24);
+	const auto depth = getU32(bytes, 28);
+	const auto layers = getU32(bytes, 32);
+	const auto faces = getU32(bytes, 36);
+	const auto levels = (std::max)(1u, getU32(bytes, 40));
+	const auto supercompression = getU32(bytes, 44);
+
+	if (!isKnownFormat(vkFormat))
+	{
+		throw std::invalid_argument("KTX2: unsupported format " + std::to_string(vkFormat));
+	}
+
+	if (depth != 0 || layers > 1 || faces != 1 || supercompression != 0)
+	{
+		throw std::invalid_argument("KTX2: only plain 2D textures are supported");
+	}
+
+	Ktx2Container result(static_cast<Ktx2Format>(vkFormat), width, height);
+
+	for (std::uint32_t i = 0; i < levels; ++i)
+	{
+		const auto entry = kHeaderSize + kLevelIndexEntrySize * i;
+		const auto offset = getU64(bytes, entry);
+		const auto length = getU64(bytes, entry + 8);
+
+		if (offset > bytes.size() || length > bytes.size() - offset)
+		{
+			throw std::invalid_argument("KTX2: level " + std::to_string(i) + " is out of bounds");
+		}
+
+		const auto begin = bytes.cbegin() + static_cast<std::ptrdiff_t>(offset);
+		result.addLevel(std::vector<std::uint8_t>(begin, begin + static_cast<std::ptrdiff_t>(length)));
+	}
+
+	return result;
+}
+
+bool Ktx2Container::isCompressed(Ktx2Format format) noexcept
+{
+	return format != Ktx2Format::R8G8B8A8_UNORM && format != Ktx2Format::R8G8B8A8_SRGB;
+}
+
+bool Ktx2Container::isSrgb(Ktx2Format format) noexcept
+{
+	return format == Ktx2Format::R8G8B8A8_SRGB
+		|| format == Ktx2Format::BC1_RGBA_SRGB
+		|| format == Ktx2Format::BC7_SRGB;
+}
+
+std::uint32_t Ktx2Container::blockBytes(Ktx2Format format) noexcept
+{
+	switch (format)
+	{
+	case Ktx2Format::BC1_RGBA_UNORM:
+	case Ktx2Format::BC1_RGBA_SRGB:
+		return 8;
+	case Ktx2Format::BC7_UNORM:
+	case Ktx2Format::BC7_SRGB:
+		return 16;
+	default:
+		return 4;
+	}
+}
+
+std::size_t Ktx2Container::levelBytes(Ktx2Format format, std::uint32_t width, std::uint32_t height) noexcept
+{
+	if (isCompressed(format))
+	{
+		return std::size_t((width + 3) / 4) * ((height + 3) / 4) * blockBytes(format);
+	}
+
+	return std::size_t(width) * height * blockBytes(format);
+}
+
+}
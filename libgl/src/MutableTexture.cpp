@@ -5,15 +5,23 @@
 namespace libgl
 {
 
-void MutableTexture::load(const TextureData& data)
+void MutableTexture::load(const TextureData& data, GLint level)
 {
+	const auto levelWidth = (std::max)(1, m_width >> level);
+	const auto levelHeight = (std::max)(1, m_height >> level);
+
 	glPixelStorei(GL_UNPACK_ALIGNMENT, data.rowAlignment);
 	checkGl();
 
 	switch (m_target)
 	{
 	case TextureTarget::TEXTURE_2D:
-		glTexImage2D(GL_TEXTURE_2D, 0, static_cast<GLenum>(m_deviceFormat), m_width, m_height, 0, static_cast<GLenum>(data.format), static_cast<GLenum>(data.type), data.data);
+		glTexImage2D(GL_TEXTURE_2D, level, static_cast<GLenum>(m_deviceFormat), levelWidth, levelHeight, 0, static_cast<GLenum>(data.format), static_cast<GLenum>(data.type), data.data);
+		checkGl();
+		break;
+	case TextureTarget::TEXTURE_2D_ARRAY:
+	case TextureTarget::TEXTURE_3D:
+		glTexImage3D(static_cast<GLenum>(m_target), level, static_cast<GLenum>(m_deviceFormat), levelWidth, levelHeight, levelDepth(level), 0, static_cast<GLenum>(data.format), static_cast<GLenum>(data.type), data.data);
 		checkGl();
 		break;
 	default:
@@ -21,9 +29,105 @@ void MutableTexture::load(const TextureData& data)
 	}
 }
 
+void MutableTexture::allocate(GLint level)
+{
+	if (m_target == TextureTarget::TEXTURE_2D_MULTISAMPLE)
+	{
+		assert(level == 0);
+		// fixed sample locations keep resolves and depth tests consistent across attachments
+		glTexImage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, m_samples, static_cast<GLenum>(m_deviceFormat), m_width, m_height, GL_TRUE);
+		checkGl();
+		return;
+	}
+
+	TextureData data{ TextureHostFormat::RGBA, TextureHostType::UNSIGNED_BYTE, 4, nullptr };
+	switch (m_deviceFormat)
+	{
+	case TextureDeviceFormat::DEPTH_COMPONENT16:
+	case TextureDeviceFormat::DEPTH_COMPONENT24:
+	case TextureDeviceFormat::DEPTH_COMPONENT32F:
+		data.format = TextureHostFormat::DEPTH_COMPONENT;
+		data.type = TextureHostType::FLOAT;
+		break;
+	case TextureDeviceFormat::DEPTH24_STENCIL8:
+		data.format = TextureHostFormat::DEPTH_STENCIL;
+		data.type = TextureHostType::UNSIGNED_INT_24_8;
+		break;
+	case TextureDeviceFormat::DEPTH32F_STENCIL8:
+		data.format = TextureHostFormat::DEPTH_STENCIL;
+		data.type = TextureHostType::FLOAT_32_UNSIGNED_INT_24_8_REV;
+		break;
+	case TextureDeviceFormat::R32UI:
+		data.format = TextureHostFormat::RED_INTEGER;
+		data.type = TextureHostType::UNSIGNED_INT;
+		break;
+	case TextureDeviceFormat::RG32UI:
+		data.format = TextureHostFormat::RG_INTEGER;
+		data.type = TextureHostType::UNSIGNED_INT;
+		break;
+	default:
+		break;
+	}
+
+	load(data, level);
+}
+
+void MutableTexture::loadCompressed(const CompressedTextureData& data, GLint level)
+{
+	const auto levelWidth = (std::max)(1, m_width >> level);
+	const auto levelHeight = (std::max)(1, m_height >> level);
+
+	switch (m_target)
+	{
+	case TextureTarget::TEXTURE_2D:
+		glCompressedTexImage2D(GL_TEXTURE_2D, level, static_cast<GLenum>(m_deviceFormat), levelWidth, levelHeight, 0, data.size, data.data);
+		checkGl();
+		break;
+	case TextureTarget::TEXTURE_2D_ARRAY:
+	case TextureTarget::TEXTURE_3D:
+		glCompressedTexImage3D(static_cast<GLenum>(m_target), level, static_cast<GLenum>(m_deviceFormat), levelWidth, levelHeight, levelDepth(level), 0, data.size, data.data);
+		checkGl();
+		break;
+	default:
+		assert(false);
+	}
+}
+
+GLsizei MutableTexture::levelDepth(GLint level) const noexcept
+{
+	// array layers are not minified, 3D slices are
+	return m_target == TextureTarget::TEXTURE_3D ? (std::max)(1, m_depth >> level) : m_depth;
+}
+
 MutableTexture MutableTexture::make2D(GLsizei width, GLsizei height, TextureDeviceFormat format)
 {
 	return MutableTexture(TextureTarget::TEXTURE_2D, format, width, height);
 }
 
+MutableTexture MutableTexture::make2DArray(GLsizei width, GLsizei height, GLsizei layers, TextureDeviceFormat format)
+{
+	return MutableTexture(TextureTarget::TEXTURE_2D_ARRAY, format, width, height, layers);
+}
+
+MutableTexture MutableTexture::make3D(GLsizei width, GLsizei height, GLsizei depth, TextureDeviceFormat format)
+{
+	return MutableTexture(TextureTarget::TEXTURE_3D, format, width, height, depth);
+}
+
+MutableTexture MutableTexture::make2DMultisample(GLsizei width, GLsizei height, GLsizei samples, TextureDeviceFormat format)
+{
+	GLint maxSamples;
+	glGetIntegerv(isDepthFormat(format) ? GL_MAX_DEPTH_TEXTURE_SAMPLES : GL_MAX_COLOR_TEXTURE_SAMPLES, &maxSamples);
+	checkGl();
+
+	if (samples < 1 || samples > maxSamples)
+	{
+		throw std::invalid_argument("unsupported texture samples count");
+	}
+
+	MutableTexture result(TextureTarget::TEXTURE_2D_MULTISAMPLE, format, width, height);
+	result.m_samples = samples;
+	return result;
+}
+
 }
@@ -0,0 +1,232 @@
+#include <PostProcessStack.hpp>
+
+namespace libgl
+{
+
+static SamplerDesc makeLinearClampSampler()
+{
+	SamplerDesc desc;
+	desc.mipmapMode = MipmapMode::NONE;
+	desc.wrapS = TextureWrap::CLAMP_TO_EDGE;
+	desc.wrapT = TextureWrap::CLAMP_TO_EDGE;
+	desc.wrapR = TextureWrap::CLAMP_TO_EDGE;
+	return desc;
+}
+
+static std::string bloomLevelName(GLsizei level)
+{
+	return "bloom" + std::to_string(level);
+}
+
+PostProcessStack::PostProcessStack(const std::filesystem::path& shadersDirectory) :
+	m_fullscreenPath(shadersDirectory / "fullscreen.vs.glsl"),
+	m_compositePath(shadersDirectory / "post_composite.fs.glsl"),
+	m_upscalePath(shadersDirectory / "upscale.fs.glsl"),
+	m_linearClamp(makeLinearClampSampler())
+{
+	const auto downsamplePath = shadersDirectory / "bloom_downsample.fs.glsl";
+	m_prefilterPipeline = m_pipelines.get(m_fullscreenPath, downsamplePath, { "PREFILTER" });
+	m_downsamplePipeline = m_pipelines.get(m_fullscreenPath, downsamplePath);
+	m_upsamplePipeline = m_pipelines.get(m_fullscreenPath, shadersDirectory / "bloom_upsample.fs.glsl");
+	m_fxaaPipeline = m_pipelines.get(m_fullscreenPath, shadersDirectory / "fxaa.fs.glsl");
+}
+
+void PostProcessStack::setSettings(const PostProcessSettings& settings)
+{
+	if (settings.bloomLevels < 1 || settings.bloomKnee < 0.0f || settings.exposure <= 0.0f ||
+		settings.upscaleSharpness < 0.0f || settings.upscaleSharpness > 1.0f)
+	{
+		throw std::invalid_argument("invalid post-process settings");
+	}
+	m_settings = settings;
+}
+
+void PostProcessStack::addPasses(RenderGraph& graph, const std::string& source, GLsizei width, GLsizei height)
+{
+	GLsizei bloomLevels = 0;
+	if (m_settings.bloom)
+	{
+		while (bloomLevels < m_settings.bloomLevels && (std::min)(width, height) >> (bloomLevels + 1) > 0)
+		{
+			++bloomLevels;
+		}
+	}
+
+	for (GLsizei level = 0; level < bloomLevels; ++level)
+	{
+		graph.createTarget(bloomLevelName(level), { TextureDeviceFormat::R11F_G11F_B10F, width >> (level + 1), height >> (level + 1) });
+	}
+
+	for (GLsizei level = 0; level < bloomLevels; ++level)
+	{
+		const auto input = level == 0 ? source : bloomLevelName(level - 1);
+		graph.addPass("bloom downsample " + std::to_string(level), [this, input, level](const RenderGraph::PassContext& context)
+		{
+			const auto& texture = context.texture(input);
+
+			context.bindFrameBuffer();
+			auto& program = bindPipeline(level == 0 ? *m_prefilterPipeline : *m_downsamplePipeline);
+			program.setUniform("U_SOURCE", GLint(kSourceUnit));
+			program.setUniform("U_SOURCE_TEXEL", 1.0f / texture.width(), 1.0f / texture.height());
+			if (level == 0)
+			{
+				program.setUniform("U_THRESHOLD", m_settings.bloomThreshold);
+				program.setUniform("U_KNEE", m_settings.bloomKnee);
+			}
+			bindSource(texture, kSourceUnit);
+			drawFullscreenTriangle();
+		}).read(input).write(bloomLevelName(level));
+	}
+
+	// each level accumulates the blurred smaller ones on top of its own downsample
+	for (GLsizei level = bloomLevels - 2; level >= 0; --level)
+	{
+		const auto input = bloomLevelName(level + 1);
+		graph.addPass("bloom upsample " + std::to_string(level), [this, input](const RenderGraph::PassContext& context)
+		{
+			const auto& texture = context.texture(input);
+
+			context.bindFrameBuffer();
+			auto& program = bindPipeline(*m_upsamplePipeline);
+			program.setUniform("U_SOURCE", GLint(kSourceUnit));
+			program.setUniform("U_SOURCE_TEXEL", 1.0f / texture.width(), 1.0f / texture.height());
+			program.setUniform("U_RADIUS", m_settings.bloomRadius);
+			bindSource(texture, kSourceUnit);
+
+			glEnable(GL_BLEND);
+			glBlendFunc(GL_ONE, GL_ONE);
+			checkGl();
+
+			drawFullscreenTriangle();
+
+			glDisable(GL_BLEND);
+			checkGl();
+		}).read(input).write(bloomLevelName(level));
+	}
+
+	std::vector<std::string> defines;
+	if (bloomLevels > 0)
+	{
+		defines.push_back("BLOOM");
+	}
+	if (m_settings.fxaa)
+	{
+		defines.push_back("FXAA_LUMA");
+		// sRGB keeps the 8 bits where they are visible, alpha isn't encoded and carries the luma as it is
+		graph.createTarget("postLdr", { TextureDeviceFormat::SRGB8_ALPHA8, width, height });
+	}
+
+	auto compositePipeline = m_pipelines.get(m_fullscreenPath, m_compositePath, defines);
+	auto compositePass = graph.addPass("tonemap", [this, compositePipeline, source, bloomLevels](const RenderGraph::PassContext& context)
+	{
+		context.bindFrameBuffer();
+		auto& composite = bindPipeline(*compositePipeline);
+		composite.setUniform("U_SOURCE", GLint(kSourceUnit));
+		composite.setUniform("U_EXPOSURE", m_settings.exposure);
+		bindSource(context.texture(source), kSourceUnit);
+		if (bloomLevels > 0)
+		{
+			composite.setUniform("U_BLOOM", GLint(kBloomUnit));
+			composite.setUniform("U_BLOOM_INTENSITY", m_settings.bloomIntensity);
+			bindSource(context.texture(bloomLevelName(0)), kBloomUnit);
+		}
+		drawFullscreenTriangle();
+	});
+
+	compositePass.read(source);
+	if (bloomLevels > 0)
+	{
+		compositePass.read(bloomLevelName(0));
+	}
+
+	const bool upscale = width != graph.backBufferWidth() || height != graph.backBufferHeight();
+	if (upscale)
+	{
+		graph.createTarget("postFinal", { TextureDeviceFormat::SRGB8_ALPHA8, width, height });
+	}
+	const auto writeOutput = [upscale](RenderGraph::PassBuilder& pass)
+	{
+		if (upscale)
+		{
+			pass.write("postFinal");
+		}
+		else
+		{
+			pass.writeBackBuffer();
+		}
+	};
+
+	if (m_settings.fxaa)
+	{
+		compositePass.write("postLdr");
+		auto fxaaPass = graph.addPass("fxaa", [this](const RenderGraph::PassContext& context)
+		{
+			const auto& texture = context.texture("postLdr");
+
+			context.bindFrameBuffer();
+			auto& program = bindPipeline(*m_fxaaPipeline);
+			program.setUniform("U_SOURCE", GLint(kSourceUnit));
+			program.setUniform("U_SOURCE_TEXEL", 1.0f / texture.width(), 1.0f / texture.height());
+			bindSource(texture, kSourceUnit);
+			drawFullscreenTriangle();
+		});
+		fxaaPass.read("postLdr");
+		writeOutput(fxaaPass);
+	}
+	else
+	{
+		writeOutput(compositePass);
+	}
+
+	if (!upscale)
+	{
+		return;
+	}
+
+	const auto sharpen = m_settings.upscaleSharpness > 0.0f;
+	auto upscalePipeline = m_pipelines.get(m_fullscreenPath, m_upscalePath, sharpen ? std::vector<std::string>{ "SHARPEN" } : std::vector<std::string>{});
+	graph.addPass("upscale", [this, upscalePipeline, sharpen](const RenderGraph::PassContext& context)
+	{
+		const auto& texture = context.texture("postFinal");
+
+		context.bindFrameBuffer();
+		auto& program = bindPipeline(*upscalePipeline);
+		program.setUniform("U_SOURCE", GLint(kSourceUnit));
+		if (sharpen)
+		{
+			program.setUniform("U_SOURCE_TEXEL", 1.0f / texture.width(), 1.0f / texture.height());
+			program.setUniform("U_SHARPNESS", m_settings.upscaleSharpness);
+		}
+		bindSource(texture, kSourceUnit);
+		drawFullscreenTriangle();
+	}).read("postFinal").writeBackBuffer();
+}
+
+std::vector<const ShaderProgram*> PostProcessStack::programs() const
+{
+	return m_pipelines.stages();
+}
+
+ShaderProgram& PostProcessStack::bindPipeline(ProgramPipeline& pipeline)
+{
+	pipeline.bind();
+	return *pipeline.stageProgram(GL_FRAGMENT_SHADER_BIT);
+}
+
+void PostProcessStack::drawFullscreenTriangle()
+{
+	// the core profile needs a vertex array object even when no attribute is read
+	m_emptyVao.bind();
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+	checkGl();
+}
+
+void PostProcessStack::bindSource(const TextureBase& texture, GLuint unit)
+{
+	glActiveTexture(GL_TEXTURE0 + unit);
+	glBindTexture(static_cast<GLenum>(texture.target()), texture.nativeHandle());
+	checkGl();
+	m_linearClamp.bind(unit);
+}
+
+}
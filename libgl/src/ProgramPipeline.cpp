@@ -0,0 +1,146 @@
+#include <ProgramPipeline.hpp>
+
+#include <algorithm>
+
+namespace libgl
+{
+
+ProgramPipeline::ProgramPipeline()
+{
+	glGenProgramPipelines(1, &m_pipeline);
+	checkGl();
+}
+
+ProgramPipeline::~ProgramPipeline() noexcept
+{
+	if (m_pipeline == kEmptyHandle)
+		return;
+
+	glDeleteProgramPipelines(1, &m_pipeline);
+	checkGl();
+}
+
+void ProgramPipeline::useStages(GLbitfield stages, std::shared_ptr<ShaderProgram> program)
+{
+	assert(program->separable());
+
+	glUseProgramStages(m_pipeline, stages, program->nativeHandle());
+	checkGl();
+
+	// the previous owners of these stages are released once they provide nothing else
+	for (auto& entry : m_programs)
+	{
+		entry.first &= ~stages;
+	}
+	m_programs.erase(std::remove_if(m_programs.begin(), m_programs.end(), [](const auto& entry)
+	{
+		return entry.first == 0;
+	}), m_programs.end());
+
+	m_programs.emplace_back(stages, std::move(program));
+}
+
+std::shared_ptr<ShaderProgram> ProgramPipeline::stageProgram(GLbitfield stage) const
+{
+	for (const auto& [stages, program] : m_programs)
+	{
+		if (stages & stage)
+		{
+			return program;
+		}
+	}
+	return {};
+}
+
+void ProgramPipeline::bind()
+{
+	glUseProgram(0);
+	checkGl();
+
+	glBindProgramPipeline(m_pipeline);
+	checkGl();
+}
+
+void ProgramPipeline::unbind()
+{
+	glBindProgramPipeline(0);
+	checkGl();
+}
+
+void ProgramPipeline::validate()
+{
+	glValidateProgramPipeline(m_pipeline);
+	checkGl();
+
+	GLint validateStatus;
+	glGetProgramPipelineiv(m_pipeline, GL_VALIDATE_STATUS, &validateStatus);
+	checkGl();
+
+	if (validateStatus)
+		return;
+
+	GLint validateInfoLogLen;
+	glGetProgramPipelineiv(m_pipeline, GL_INFO_LOG_LENGTH, &validateInfoLogLen);
+	checkGl();
+
+	if (!validateInfoLogLen)
+		return;
+
+	std::vector<GLchar> rawLog(validateInfoLogLen);
+	glGetProgramPipelineInfoLog(m_pipeline, validateInfoLogLen, nullptr, rawLog.data());
+
+	auto message = std::string("Pipeline validation failed: ") + std::string(rawLog.cbegin(), rawLog.cend());
+	throw std::runtime_error(message);
+}
+
+GLbitfield ProgramPipeline::stageBit(GLenum stage)
+{
+	switch (stage)
+	{
+	case GL_VERTEX_SHADER: return GL_VERTEX_SHADER_BIT;
+	case GL_TESS_CONTROL_SHADER: return GL_TESS_CONTROL_SHADER_BIT;
+	case GL_TESS_EVALUATION_SHADER: return GL_TESS_EVALUATION_SHADER_BIT;
+	case GL_GEOMETRY_SHADER: return GL_GEOMETRY_SHADER_BIT;
+	case GL_FRAGMENT_SHADER: return GL_FRAGMENT_SHADER_BIT;
+	case GL_COMPUTE_SHADER: return GL_COMPUTE_SHADER_BIT;
+	default: throw std::invalid_argument("unknown shader stage");
+	}
+}
+
+std::shared_ptr<ShaderProgram> ProgramPipelineLibrary::stage(GLenum stage, const std::filesystem::path& path, const std::vector<std::string>& defines)
+{
+	// looked up every frame by render passes, so the path is normalized without touching the file system
+	auto& program = m_stages[{ stage, path.lexically_normal(), defines }];
+	if (!program)
+	{
+		program = ShaderProgram::makeStage(stage, path, defines);
+	}
+	return program;
+}
+
+std::shared_ptr<ProgramPipeline> ProgramPipelineLibrary::get(const std::filesystem::path& vertexPath, const std::filesystem::path& fragmentPath, const std::vector<std::string>& fragmentDefines)
+{
+	auto vertexStage = stage(GL_VERTEX_SHADER, vertexPath);
+	auto fragmentStage = stage(GL_FRAGMENT_SHADER, fragmentPath, fragmentDefines);
+
+	auto& pipeline = m_pipelines[{ vertexStage.get(), fragmentStage.get() }];
+	if (!pipeline)
+	{
+		pipeline = std::make_shared<ProgramPipeline>();
+		pipeline->useStages(GL_VERTEX_SHADER_BIT, std::move(vertexStage));
+		pipeline->useStages(GL_FRAGMENT_SHADER_BIT, std::move(fragmentStage));
+	}
+	return pipeline;
+}
+
+std::vector<const ShaderProgram*> ProgramPipelineLibrary::stages() const
+{
+	std::vector<const ShaderProgram*> result;
+	for (const auto& [key, program] : m_stages)
+	{
+		result.push_back(program.get());
+	}
+	return result;
+}
+
+}
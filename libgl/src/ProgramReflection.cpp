@@ -0,0 +1,309 @@
+#include <ProgramReflection.hpp>
+#include <glstring.hpp>
+
+#include <iomanip>
+#include <sstream>
+
+namespace libgl
+{
+
+static bool isSamplerOrImage(GLenum type)
+{
+	switch (type)
+	{
+	case GL_SAMPLER_1D:
+	case GL_SAMPLER_2D:
+	case GL_SAMPLER_3D:
+	case GL_SAMPLER_CUBE:
+	case GL_SAMPLER_2D_SHADOW:
+	case GL_SAMPLER_2D_ARRAY:
+	case GL_SAMPLER_2D_ARRAY_SHADOW:
+	case GL_SAMPLER_CUBE_SHADOW:
+	case GL_SAMPLER_2D_MULTISAMPLE:
+	case GL_SAMPLER_BUFFER:
+	case GL_INT_SAMPLER_2D:
+	case GL_INT_SAMPLER_3D:
+	case GL_INT_SAMPLER_2D_ARRAY:
+	case GL_INT_SAMPLER_BUFFER:
+	case GL_UNSIGNED_INT_SAMPLER_2D:
+	case GL_UNSIGNED_INT_SAMPLER_3D:
+	case GL_UNSIGNED_INT_SAMPLER_2D_ARRAY:
+	case GL_UNSIGNED_INT_SAMPLER_BUFFER:
+	case GL_IMAGE_2D:
+	case GL_IMAGE_3D:
+	case GL_IMAGE_2D_ARRAY:
+	case GL_IMAGE_BUFFER:
+	case GL_INT_IMAGE_2D:
+	case GL_UNSIGNED_INT_IMAGE_2D:
+	case GL_UNSIGNED_INT_IMAGE_BUFFER:
+		return true;
+	default:
+		return false;
+	}
+}
+
+static std::string escapeJson(const std::string& value)
+{
+	std::ostringstream stream;
+	for (const auto c : value)
+	{
+		switch (c)
+		{
+		case '"': stream << "\\\""; break;
+		case '\\': stream << "\\\\"; break;
+		case '\n': stream << "\\n"; break;
+		case '\r': stream << "\\r"; break;
+		case '\t': stream << "\\t"; break;
+		default:
+			if (static_cast<unsigned char>(c) < 0x20)
+			{
+				stream << "\\u" << std::hex << std::setw(4) << std::setfill('0') << int(c) << std::dec;
+			}
+			else
+			{
+				stream << c;
+			}
+		}
+	}
+	return stream.str();
+}
+
+static std::vector<ReflectedBlock> queryUniformBlocks(GLuint program)
+{
+	GLint blocksCount;
+	glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &blocksCount);
+	checkGl();
+
+	GLint maxNameLength;
+	glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxNameLength);
+	checkGl();
+
+	std::vector<ReflectedBlock> result;
+	std::vector<GLchar> name(static_cast<std::size_t>(maxNameLength) + 1);
+	for (GLuint i = 0; i < GLuint(blocksCount); ++i)
+	{
+		glGetActiveUniformBlockName(program, i, static_cast<GLsizei>(name.size()), nullptr, name.data());
+		checkGl();
+
+		ReflectedBlock block;
+		block.name = name.data();
+		glGetActiveUniformBlockiv(program, i, GL_UNIFORM_BLOCK_BINDING, &block.binding);
+		glGetActiveUniformBlockiv(program, i, GL_UNIFORM_BLOCK_DATA_SIZE, &block.dataSize);
+		glGetActiveUniformBlockiv(program, i, GL_UNIFORM_BLOCK_ACTIVE_UNIFORMS, &block.activeVariables);
+		checkGl();
+
+		result.push_back(std::move(block));
+	}
+	return result;
+}
+
+static std::vector<ReflectedBlock> queryStorageBlocks(GLuint program)
+{
+	if (!(GLEW_VERSION_4_3 || GLEW_ARB_program_interface_query))
+	{
+		return {};
+	}
+
+	GLint blocksCount;
+	glGetProgramInterfaceiv(program, GL_SHADER_STORAGE_BLOCK, GL_ACTIVE_RESOURCES, &blocksCount);
+	checkGl();
+
+	GLint maxNameLength;
+	glGetProgramInterfaceiv(program, GL_SHADER_STORAGE_BLOCK, GL_MAX_NAME_LENGTH, &maxNameLength);
+	checkGl();
+
+	std::vector<ReflectedBlock> result;
+	std::vector<GLchar> name(static_cast<std::size_t>(maxNameLength) + 1);
+	for (GLuint i = 0; i < GLuint(blocksCount); ++i)
+	{
+		glGetProgramResourceName(program, GL_SHADER_STORAGE_BLOCK, i, static_cast<GLsizei>(name.size()), nullptr, name.data());
+		checkGl();
+
+		const GLenum properties[] = { GL_BUFFER_BINDING, GL_BUFFER_DATA_SIZE, GL_NUM_ACTIVE_VARIABLES };
+		GLint values[3];
+		glGetProgramResourceiv(program, GL_SHADER_STORAGE_BLOCK, i, 3, properties, 3, nullptr, values);
+		checkGl();
+
+		result.push_back({ name.data(), values[0], values[1], values[2] });
+	}
+	return result;
+}
+
+ProgramReflection ProgramReflection::query(const ShaderProgram& program)
+{
+	const auto handle = program.nativeHandle();
+
+	ProgramReflection result;
+	result.label = program.label();
+	result.stats = program.stats();
+
+	glGetProgramiv(handle, GL_PROGRAM_BINARY_LENGTH, &result.binaryBytes);
+	checkGl();
+
+	GLint attributesCount;
+	glGetProgramiv(handle, GL_ACTIVE_ATTRIBUTES, &attributesCount);
+	GLint maxAttributeLength;
+	glGetProgramiv(handle, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxAttributeLength);
+	checkGl();
+
+	std::vector<GLchar> name(static_cast<std::size_t>(maxAttributeLength) + 1);
+	for (GLuint i = 0; i < GLuint(attributesCount); ++i)
+	{
+		ReflectedVariable variable;
+		glGetActiveAttrib(handle, i, static_cast<GLsizei>(name.size()), nullptr, &variable.arraySize, &variable.type, name.data());
+		checkGl();
+
+		variable.name = name.data();
+		variable.location = glGetAttribLocation(handle, name.data());
+		checkGl();
+
+		result.attributes.push_back(std::move(variable));
+	}
+
+	GLint uniformsCount;
+	glGetProgramiv(handle, GL_ACTIVE_UNIFORMS, &uniformsCount);
+	GLint maxUniformLength;
+	glGetProgramiv(handle, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxUniformLength);
+	checkGl();
+
+	name.resize(static_cast<std::size_t>(maxUniformLength) + 1);
+	for (GLuint i = 0; i < GLuint(uniformsCount); ++i)
+	{
+		ReflectedVariable variable;
+		glGetActiveUniform(handle, i, static_cast<GLsizei>(name.size()), nullptr, &variable.arraySize, &variable.type, name.data());
+		glGetActiveUniformsiv(handle, 1, &i, GL_UNIFORM_BLOCK_INDEX, &variable.blockIndex);
+		glGetActiveUniformsiv(handle, 1, &i, GL_UNIFORM_OFFSET, &variable.blockOffset);
+		checkGl();
+
+		variable.name = name.data();
+		variable.location = glGetUniformLocation(handle, name.data());
+		checkGl();
+
+		if (isSamplerOrImage(variable.type))
+		{
+			glGetUniformiv(handle, variable.location, &variable.textureUnit);
+			checkGl();
+
+			result.samplers.push_back(std::move(variable));
+		}
+		else
+		{
+			result.uniforms.push_back(std::move(variable));
+		}
+	}
+
+	result.uniformBlocks = queryUniformBlocks(handle);
+	result.storageBlocks = queryStorageBlocks(handle);
+	return result;
+}
+
+std::string ProgramReflection::typeName(GLenum type)
+{
+	switch (type)
+	{
+	case GL_FLOAT: return "float";
+	case GL_FLOAT_VEC2: return "vec2";
+	case GL_FLOAT_VEC3: return "vec3";
+	case GL_FLOAT_VEC4: return "vec4";
+	case GL_INT: return "int";
+	case GL_INT_VEC2: return "ivec2";
+	case GL_INT_VEC3: return "ivec3";
+	case GL_INT_VEC4: return "ivec4";
+	case GL_UNSIGNED_INT: return "uint";
+	case GL_UNSIGNED_INT_VEC2: return "uvec2";
+	case GL_UNSIGNED_INT_VEC3: return "uvec3";
+	case GL_UNSIGNED_INT_VEC4: return "uvec4";
+	case GL_BOOL: return "bool";
+	case GL_FLOAT_MAT2: return "mat2";
+	case GL_FLOAT_MAT3: return "mat3";
+	case GL_FLOAT_MAT4: return "mat4";
+	case GL_SAMPLER_2D: return "sampler2D";
+	case GL_SAMPLER_3D: return "sampler3D";
+	case GL_SAMPLER_CUBE: return "samplerCube";
+	case GL_SAMPLER_2D_SHADOW: return "sampler2DShadow";
+	case GL_SAMPLER_2D_ARRAY: return "sampler2DArray";
+	case GL_SAMPLER_2D_ARRAY_SHADOW: return "sampler2DArrayShadow";
+	case GL_SAMPLER_2D_MULTISAMPLE: return "sampler2DMS";
+	case GL_SAMPLER_BUFFER: return "samplerBuffer";
+	case GL_IMAGE_2D: return "image2D";
+	case GL_IMAGE_3D: return "image3D";
+	case GL_IMAGE_2D_ARRAY: return "image2DArray";
+	}
+
+	std::ostringstream stream;
+	stream << "0x" << std::hex << type;
+	return stream.str();
+}
+
+void ProgramReflection::writeJson(std::ostream& stream, const std::vector<const ShaderProgram*>& programs)
+{
+	const auto writeVariables = [&](const char* key, const std::vector<ReflectedVariable>& variables, bool samplers)
+	{
+		stream << "\t\t\t\"" << key << "\": [";
+		for (std::size_t i = 0; i < variables.size(); ++i)
+		{
+			const auto& variable = variables[i];
+			stream << (i ? ",\n" : "\n") << "\t\t\t\t{ \"name\": \"" << escapeJson(variable.name)
+				<< "\", \"type\": \"" << typeName(variable.type)
+				<< "\", \"size\": " << variable.arraySize
+				<< ", \"location\": " << variable.location;
+			if (samplers)
+			{
+				stream << ", \"unit\": " << variable.textureUnit;
+			}
+			else if (variable.blockIndex >= 0)
+			{
+				stream << ", \"block\": " << variable.blockIndex << ", \"offset\": " << variable.blockOffset;
+			}
+			stream << " }";
+		}
+		stream << (variables.empty() ? "]" : "\n\t\t\t]");
+	};
+
+	const auto writeBlocks = [&](const char* key, const std::vector<ReflectedBlock>& blocks)
+	{
+		stream << "\t\t\t\"" << key << "\": [";
+		for (std::size_t i = 0; i < blocks.size(); ++i)
+		{
+			const auto& block = blocks[i];
+			stream << (i ? ",\n" : "\n") << "\t\t\t\t{ \"name\": \"" << escapeJson(block.name)
+				<< "\", \"binding\": " << block.binding
+				<< ", \"dataSize\": " << block.dataSize
+				<< ", \"activeVariables\": " << block.activeVariables << " }";
+		}
+		stream << (blocks.empty() ? "]" : "\n\t\t\t]");
+	};
+
+	stream << "{\n\t\"driver\": {\n"
+		<< "\t\t\"vendor\": \"" << escapeJson(detail::getGlString(GL_VENDOR)) << "\",\n"
+		<< "\t\t\"renderer\": \"" << escapeJson(detail::getGlString(GL_RENDERER)) << "\",\n"
+		<< "\t\t\"version\": \"" << escapeJson(detail::getGlString(GL_VERSION)) << "\",\n"
+		<< "\t\t\"glsl\": \"" << escapeJson(detail::getGlString(GL_SHADING_LANGUAGE_VERSION)) << "\"\n"
+		<< "\t},\n\t\"programs\": [";
+
+	for (std::size_t i = 0; i < programs.size(); ++i)
+	{
+		const auto reflection = query(*programs[i]);
+
+		stream << (i ? ",\n" : "\n") << "\t\t{\n"
+			<< "\t\t\t\"label\": \"" << escapeJson(reflection.label) << "\",\n"
+			<< "\t\t\t\"binaryBytes\": " << reflection.binaryBytes << ",\n"
+			<< "\t\t\t\"compileMilliseconds\": " << reflection.stats.compileMilliseconds << ",\n"
+			<< "\t\t\t\"linkMilliseconds\": " << reflection.stats.linkMilliseconds << ",\n"
+			<< "\t\t\t\"fromCache\": " << (reflection.stats.fromCache ? "true" : "false") << ",\n";
+		writeVariables("attributes", reflection.attributes, false);
+		stream << ",\n";
+		writeVariables("uniforms", reflection.uniforms, false);
+		stream << ",\n";
+		writeVariables("samplers", reflection.samplers, true);
+		stream << ",\n";
+		writeBlocks("uniformBlocks", reflection.uniformBlocks);
+		stream << ",\n";
+		writeBlocks("storageBlocks", reflection.storageBlocks);
+		stream << "\n\t\t}";
+	}
+
+	stream << (programs.empty() ? "]\n}\n" : "\n\t]\n}\n");
+}
+
+}
@@ -0,0 +1,67 @@
+#include <RenderBuffer.hpp>
+#include <FrameBufferCache.hpp>
+
+namespace libgl
+{
+
+RenderBuffer::RenderBuffer(TextureDeviceFormat format, GLsizei width, GLsizei height, GLsizei samples) :
+	m_format(format),
+	m_width(width),
+	m_height(height),
+	m_samples(samples)
+{
+	GLint maxSamples;
+	glGetIntegerv(GL_MAX_SAMPLES, &maxSamples);
+	checkGl();
+
+	if (samples < 0 || samples > maxSamples)
+	{
+		throw std::invalid_argument("unsupported renderbuffer samples count");
+	}
+
+	glGenRenderbuffers(1, &m_renderBuffer);
+	checkGl();
+
+	glBindRenderbuffer(GL_RENDERBUFFER, m_renderBuffer);
+	checkGl();
+
+	glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, static_cast<GLenum>(format), width, height);
+	checkGl();
+
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+	checkGl();
+}
+
+RenderBuffer::RenderBuffer(RenderBuffer&& o) noexcept
+{
+	std::swap(o.m_format, m_format);
+	std::swap(o.m_width, m_width);
+	std::swap(o.m_height, m_height);
+	std::swap(o.m_samples, m_samples);
+	std::swap(o.m_renderBuffer, m_renderBuffer);
+}
+
+RenderBuffer::~RenderBuffer() noexcept
+{
+	if (m_renderBuffer != kEmptyHandle)
+	{
+		FrameBufferCache::notifyDestroyed(GL_RENDERBUFFER, m_renderBuffer);
+		glDeleteRenderbuffers(1, &m_renderBuffer);
+		checkGl();
+	}
+}
+
+RenderBuffer& RenderBuffer::operator=(RenderBuffer&& o) noexcept
+{
+	if (&o != this)
+	{
+		std::swap(o.m_format, m_format);
+		std::swap(o.m_width, m_width);
+		std::swap(o.m_height, m_height);
+		std::swap(o.m_samples, m_samples);
+		std::swap(o.m_renderBuffer, m_renderBuffer);
+	}
+	return *this;
+}
+
+}
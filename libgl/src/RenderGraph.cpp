@@ -0,0 +1,465 @@
+#include <RenderGraph.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <set>
+
+namespace libgl
+{
+
+// the attachment point follows the format, colors keep the order they are added in
+static void addAttachment(FrameBufferDesc& desc, const std::shared_ptr<TextureBase>& texture)
+{
+	const auto format = texture->deviceFormat();
+	if (isDepthFormat(format))
+	{
+		desc.depth = FrameBufferAttachment::make(texture);
+	}
+	else if (format == TextureDeviceFormat::STENCIL_INDEX8)
+	{
+		desc.stencil = FrameBufferAttachment::make(texture);
+	}
+	else
+	{
+		desc.colors.push_back(FrameBufferAttachment::make(texture));
+	}
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::read(const std::string& resource)
+{
+	m_graph.m_passes[m_pass].readNames.push_back(resource);
+	return *this;
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::write(const std::string& resource)
+{
+	m_graph.m_passes[m_pass].writeNames.push_back(resource);
+	return *this;
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::writeBackBuffer()
+{
+	m_graph.m_passes[m_pass].backBuffer = true;
+	return *this;
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::setSideEffects()
+{
+	m_graph.m_passes[m_pass].sideEffects = true;
+	return *this;
+}
+
+const std::string& RenderGraph::PassContext::passName() const noexcept
+{
+	return m_graph.m_passes[m_pass].name;
+}
+
+TextureBase& RenderGraph::PassContext::texture(const std::string& resource) const
+{
+	const auto& pass = m_graph.m_passes[m_pass];
+	const auto index = m_graph.resourceIndex(resource);
+	if (std::find(pass.reads.begin(), pass.reads.end(), index) == pass.reads.end() &&
+		std::find(pass.writes.begin(), pass.writes.end(), index) == pass.writes.end())
+	{
+		throw std::invalid_argument("pass " + pass.name + " doesn't declare " + resource);
+	}
+
+	return *m_graph.m_resources[index].texture;
+}
+
+void RenderGraph::PassContext::bindFrameBuffer() const
+{
+	const auto& pass = m_graph.m_passes[m_pass];
+	if (pass.backBuffer)
+	{
+		FrameBuffer::bindDefault();
+		glViewport(0, 0, m_graph.m_backBufferWidth, m_graph.m_backBufferHeight);
+		checkGl();
+		return;
+	}
+
+	auto& frameBuffer = m_graph.passFrameBuffer(m_pass);
+	frameBuffer.bind();
+	frameBuffer.setViewport();
+}
+
+void RenderGraph::PassContext::resolve(const std::string& source, GLbitfield mask) const
+{
+	const auto& pass = m_graph.m_passes[m_pass];
+	const auto index = m_graph.resourceIndex(source);
+	if (std::find(pass.reads.begin(), pass.reads.end(), index) == pass.reads.end())
+	{
+		throw std::invalid_argument("pass " + pass.name + " doesn't read " + source);
+	}
+
+	const auto& sourceFrameBuffer = m_graph.resourceFrameBuffer(index);
+	if (pass.backBuffer)
+	{
+		sourceFrameBuffer.blitToDefault(m_graph.m_backBufferWidth, m_graph.m_backBufferHeight, mask);
+	}
+	else
+	{
+		sourceFrameBuffer.blitTo(m_graph.passFrameBuffer(m_pass), mask);
+	}
+}
+
+RenderGraph::RenderGraph(std::shared_ptr<RenderTargetPool> pool) :
+	m_pool(std::move(pool))
+{
+}
+
+void RenderGraph::createTarget(std::string name, RenderTargetDesc desc)
+{
+	if (desc.width <= 0 || desc.height <= 0)
+	{
+		throw std::invalid_argument("empty render target " + name);
+	}
+
+	Resource resource;
+	resource.name = name;
+	resource.desc = desc;
+
+	if (!m_resourceIndices.emplace(std::move(name), m_resources.size()).second)
+	{
+		throw std::invalid_argument("render target " + resource.name + " is declared twice");
+	}
+	m_resources.emplace_back(std::move(resource));
+	m_compiled = false;
+}
+
+void RenderGraph::importTexture(std::string name, std::shared_ptr<TextureBase> texture)
+{
+	Resource resource;
+	resource.name = name;
+	resource.desc = { texture->deviceFormat(), texture->width(), texture->height(), texture->samples() };
+	resource.texture = std::move(texture);
+	resource.imported = true;
+
+	if (!m_resourceIndices.emplace(std::move(name), m_resources.size()).second)
+	{
+		throw std::invalid_argument("render target " + resource.name + " is declared twice");
+	}
+	m_resources.emplace_back(std::move(resource));
+	m_compiled = false;
+}
+
+RenderGraph::PassBuilder RenderGraph::addPass(std::string name, ExecuteFunc execute)
+{
+	Pass pass;
+	pass.name = std::move(name);
+	pass.execute = std::move(execute);
+	m_passes.emplace_back(std::move(pass));
+	m_compiled = false;
+
+	return PassBuilder(*this, m_passes.size() - 1);
+}
+
+void RenderGraph::setBackBufferSize(GLsizei width, GLsizei height) noexcept
+{
+	m_backBufferWidth = width;
+	m_backBufferHeight = height;
+}
+
+void RenderGraph::compile()
+{
+	resolveResources();
+	sortPasses();
+	cullPasses();
+	assignTextures();
+	m_compiled = true;
+}
+
+void RenderGraph::execute()
+{
+	if (!m_compiled)
+	{
+		compile();
+	}
+
+	for (std::size_t position = 0; position < m_order.size(); ++position)
+	{
+		const auto pass = m_order[position];
+		m_passes[pass].execute(PassContext(*this, pass));
+		invalidateExpired(position);
+	}
+}
+
+void RenderGraph::reset() noexcept
+{
+	m_resources.clear();
+	m_resourceIndices.clear();
+	m_passes.clear();
+	m_order.clear();
+	m_physicalTargets.clear();
+	m_compiled = false;
+}
+
+std::vector<std::string> RenderGraph::executionOrder() const
+{
+	std::vector<std::string> result;
+	for (const auto pass : m_order)
+	{
+		result.push_back(m_passes[pass].name);
+	}
+	return result;
+}
+
+std::size_t RenderGraph::resourceIndex(const std::string& name) const
+{
+	const auto it = m_resourceIndices.find(name);
+	if (it == m_resourceIndices.end())
+	{
+		throw std::invalid_argument("unknown render target " + name);
+	}
+	return it->second;
+}
+
+FrameBuffer& RenderGraph::passFrameBuffer(std::size_t pass)
+{
+	FrameBufferDesc desc;
+	for (const auto index : m_passes[pass].writes)
+	{
+		addAttachment(desc, m_resources[index].texture);
+	}
+	return m_frameBuffers.get(desc);
+}
+
+FrameBuffer& RenderGraph::resourceFrameBuffer(std::size_t resource)
+{
+	FrameBufferDesc desc;
+	addAttachment(desc, m_resources[resource].texture);
+	return m_frameBuffers.get(desc);
+}
+
+void RenderGraph::invalidateExpired(std::size_t position)
+{
+	for (std::size_t i = 0; i < m_resources.size(); ++i)
+	{
+		const auto& resource = m_resources[i];
+		if (!resource.imported && resource.texture && resource.lastUse == position)
+		{
+			resourceFrameBuffer(i).invalidate();
+		}
+	}
+}
+
+void RenderGraph::resolveResources()
+{
+	for (auto& resource : m_resources)
+	{
+		resource.writers.clear();
+		resource.readers.clear();
+	}
+
+	for (std::size_t i = 0; i < m_passes.size(); ++i)
+	{
+		auto& pass = m_passes[i];
+		pass.reads.clear();
+		pass.writes.clear();
+
+		for (const auto& name : pass.readNames)
+		{
+			pass.reads.push_back(resourceIndex(name));
+			m_resources[pass.reads.back()].readers.push_back(i);
+		}
+		for (const auto& name : pass.writeNames)
+		{
+			const auto index = resourceIndex(name);
+			// a texture can't be sampled while it is attached to the framebuffer being drawn
+			if (std::find(pass.reads.begin(), pass.reads.end(), index) != pass.reads.end())
+			{
+				throw std::invalid_argument("pass " + pass.name + " reads and writes " + name);
+			}
+			pass.writes.push_back(index);
+			m_resources[index].writers.push_back(i);
+		}
+
+		if (pass.backBuffer && !pass.writes.empty())
+		{
+			throw std::invalid_argument("pass " + pass.name + " writes both the back buffer and render targets");
+		}
+	}
+}
+
+void RenderGraph::sortPasses()
+{
+	std::vector<std::set<std::size_t>> successors(m_passes.size());
+	const auto addProducer = [&](std::size_t producer, std::size_t consumer)
+	{
+		m_passes[consumer].producers.push_back(producer);
+		successors[producer].insert(consumer);
+	};
+
+	// declaration order decides which content of a target a pass sees
+	std::vector<std::size_t> lastWriters(m_resources.size(), m_passes.size());
+	std::vector<std::vector<std::size_t>> readersSinceWrite(m_resources.size());
+	for (std::size_t i = 0; i < m_passes.size(); ++i)
+	{
+		auto& pass = m_passes[i];
+		pass.producers.clear();
+
+		for (const auto index : pass.reads)
+		{
+			if (lastWriters[index] != m_passes.size())
+			{
+				addProducer(lastWriters[index], i);
+			}
+			else if (!m_resources[index].writers.empty())
+			{
+				// a consumer declared ahead of its producer
+				addProducer(m_resources[index].writers.front(), i);
+			}
+			else if (!m_resources[index].imported)
+			{
+				throw std::invalid_argument("render target " + m_resources[index].name + " is read but never written");
+			}
+			readersSinceWrite[index].push_back(i);
+		}
+
+		for (const auto index : pass.writes)
+		{
+			if (lastWriters[index] != m_passes.size())
+			{
+				// drawing on top of a target needs whatever was drawn into it before
+				addProducer(lastWriters[index], i);
+				// and must not overwrite it under the passes still reading it
+				for (const auto reader : readersSinceWrite[index])
+				{
+					successors[reader].insert(i);
+				}
+			}
+			lastWriters[index] = i;
+			readersSinceWrite[index].clear();
+		}
+	}
+
+	std::vector<std::size_t> predecessorsCount(m_passes.size(), 0);
+	for (const auto& passSuccessors : successors)
+	{
+		for (const auto successor : passSuccessors)
+		{
+			++predecessorsCount[successor];
+		}
+	}
+
+	// independent passes keep their declaration order
+	std::priority_queue<std::size_t, std::vector<std::size_t>, std::greater<std::size_t>> ready;
+	for (std::size_t i = 0; i < m_passes.size(); ++i)
+	{
+		if (predecessorsCount[i] == 0)
+		{
+			ready.push(i);
+		}
+	}
+
+	m_order.clear();
+	while (!ready.empty())
+	{
+		const auto pass = ready.top();
+		ready.pop();
+		m_order.push_back(pass);
+
+		for (const auto successor : successors[pass])
+		{
+			if (--predecessorsCount[successor] == 0)
+			{
+				ready.push(successor);
+			}
+		}
+	}
+
+	if (m_order.size() != m_passes.size())
+	{
+		throw std::runtime_error("render graph has a dependency cycle");
+	}
+}
+
+void RenderGraph::cullPasses()
+{
+	for (auto& pass : m_passes)
+	{
+		pass.alive = pass.backBuffer || pass.sideEffects || std::any_of(pass.writes.begin(), pass.writes.end(), [this](std::size_t index)
+		{
+			return m_resources[index].imported;
+		});
+	}
+
+	// producers always precede their consumers, so one backward sweep reaches every pass a root depends on
+	for (auto it = m_order.rbegin(); it != m_order.rend(); ++it)
+	{
+		const auto& pass = m_passes[*it];
+		if (pass.alive)
+		{
+			for (const auto producer : pass.producers)
+			{
+				m_passes[producer].alive = true;
+			}
+		}
+	}
+
+	m_order.erase(std::remove_if(m_order.begin(), m_order.end(), [this](std::size_t pass)
+	{
+		return !m_passes[pass].alive;
+	}), m_order.end());
+}
+
+void RenderGraph::assignTextures()
+{
+	std::vector<std::size_t> transients;
+	for (std::size_t i = 0; i < m_resources.size(); ++i)
+	{
+		auto& resource = m_resources[i];
+		if (resource.imported)
+		{
+			continue;
+		}
+		resource.texture.reset();
+
+		bool used = false;
+		for (std::size_t position = 0; position < m_order.size(); ++position)
+		{
+			const auto& pass = m_passes[m_order[position]];
+			if (std::find(pass.reads.begin(), pass.reads.end(), i) != pass.reads.end() ||
+				std::find(pass.writes.begin(), pass.writes.end(), i) != pass.writes.end())
+			{
+				resource.firstUse = used ? resource.firstUse : position;
+				resource.lastUse = position;
+				used = true;
+			}
+		}
+
+		if (used)
+		{
+			transients.push_back(i);
+		}
+	}
+
+	std::stable_sort(transients.begin(), transients.end(), [this](std::size_t left, std::size_t right)
+	{
+		return m_resources[left].firstUse < m_resources[right].firstUse;
+	});
+
+	m_physicalTargets.clear();
+	for (const auto index : transients)
+	{
+		auto& resource = m_resources[index];
+
+		// a texture becomes free once the last pass using its previous owner has run
+		auto target = std::find_if(m_physicalTargets.begin(), m_physicalTargets.end(), [&](const PhysicalTarget& candidate)
+		{
+			return candidate.desc == resource.desc && candidate.busyUntil < resource.firstUse;
+		});
+
+		if (target == m_physicalTargets.end())
+		{
+			m_physicalTargets.push_back({ resource.desc, m_pool->acquire(resource.desc) });
+			target = std::prev(m_physicalTargets.end());
+		}
+
+		target->busyUntil = resource.lastUse;
+		resource.texture = target->texture;
+	}
+}
+
+}
@@ -0,0 +1,75 @@
+#include <RenderTargetPool.hpp>
+
+#include <algorithm>
+
+namespace libgl
+{
+
+RenderTargetPool::RenderTargetPool(std::uint32_t maxUnusedFrames) :
+	m_maxUnusedFrames(maxUnusedFrames)
+{
+}
+
+std::shared_ptr<TextureBase> RenderTargetPool::acquire(const RenderTargetDesc& desc)
+{
+	if (desc.width <= 0 || desc.height <= 0)
+	{
+		throw std::invalid_argument("empty render target");
+	}
+
+	auto entry = std::find_if(m_entries.begin(), m_entries.end(), [&](const Entry& candidate)
+	{
+		return candidate.desc == desc && candidate.texture.use_count() == 1;
+	});
+
+	if (entry == m_entries.end())
+	{
+		auto texture = std::make_shared<MutableTexture>(desc.samples > 0
+			? MutableTexture::make2DMultisample(desc.width, desc.height, desc.samples, desc.format)
+			: MutableTexture::make2D(desc.width, desc.height, desc.format));
+		texture->bind(kAllocationUnit);
+		texture->allocate();
+
+		m_entries.push_back({ desc, std::move(texture) });
+		entry = std::prev(m_entries.end());
+	}
+
+	entry->lastUsedFrame = m_frame;
+	return entry->texture;
+}
+
+void RenderTargetPool::nextFrame()
+{
+	++m_frame;
+
+	// textures still held elsewhere count as used
+	for (auto& entry : m_entries)
+	{
+		if (entry.texture.use_count() > 1)
+		{
+			entry.lastUsedFrame = m_frame;
+		}
+	}
+
+	m_entries.erase(std::remove_if(m_entries.begin(), m_entries.end(), [this](const Entry& entry)
+	{
+		return m_frame - entry.lastUsedFrame > m_maxUnusedFrames;
+	}), m_entries.end());
+}
+
+void RenderTargetPool::clear() noexcept
+{
+	m_entries.clear();
+}
+
+std::size_t RenderTargetPool::memoryUsage() const noexcept
+{
+	std::size_t result = 0;
+	for (const auto& entry : m_entries)
+	{
+		result += entry.texture->memoryUsage();
+	}
+	return result;
+}
+
+}
@@ -0,0 +1,160 @@
+#include <Sampler.hpp>
+
+namespace libgl
+{
+
+static GLenum getMinFilter(TextureFilter filter, MipmapMode mipmapMode)
+{
+	switch (mipmapMode)
+	{
+	case MipmapMode::NONE:
+		return static_cast<GLenum>(filter);
+	case MipmapMode::NEAREST:
+		return filter == TextureFilter::LINEAR ? GL_LINEAR_MIPMAP_NEAREST : GL_NEAREST_MIPMAP_NEAREST;
+	case MipmapMode::LINEAR:
+		return filter == TextureFilter::LINEAR ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST_MIPMAP_LINEAR;
+	}
+	std::terminate();
+}
+
+static void hashCombine(std::size_t& seed, std::size_t value) noexcept
+{
+	seed ^= value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2);
+}
+
+bool SamplerDesc::operator==(const SamplerDesc& other) const noexcept
+{
+	return magFilter == other.magFilter
+		&& minFilter == other.minFilter
+		&& mipmapMode == other.mipmapMode
+		&& wrapS == other.wrapS
+		&& wrapT == other.wrapT
+		&& wrapR == other.wrapR
+		&& maxAnisotropy == other.maxAnisotropy
+		&& lodBias == other.lodBias
+		&& depthCompare == other.depthCompare;
+}
+
+std::size_t SamplerDescHash::operator()(const SamplerDesc& desc) const noexcept
+{
+	std::size_t result = 0;
+	hashCombine(result, static_cast<std::size_t>(desc.magFilter));
+	hashCombine(result, static_cast<std::size_t>(desc.minFilter));
+	hashCombine(result, static_cast<std::size_t>(desc.mipmapMode));
+	hashCombine(result, static_cast<std::size_t>(desc.wrapS));
+	hashCombine(result, static_cast<std::size_t>(desc.wrapT));
+	hashCombine(result, static_cast<std::size_t>(desc.wrapR));
+	hashCombine(result, std::hash<float>()(desc.maxAnisotropy));
+	hashCombine(result, std::hash<float>()(desc.lodBias));
+	hashCombine(result, static_cast<std::size_t>(desc.depthCompare));
+	return result;
+}
+
+Sampler::Sampler(const SamplerDesc& desc) :
+	m_desc(desc)
+{
+	glGenSamplers(1, &m_sampler);
+	checkGl();
+
+	glSamplerParameteri(m_sampler, GL_TEXTURE_MAG_FILTER, static_cast<GLint>(desc.magFilter));
+	glSamplerParameteri(m_sampler, GL_TEXTURE_MIN_FILTER, static_cast<GLint>(getMinFilter(desc.minFilter, desc.mipmapMode)));
+	glSamplerParameteri(m_sampler, GL_TEXTURE_WRAP_S, static_cast<GLint>(desc.wrapS));
+	glSamplerParameteri(m_sampler, GL_TEXTURE_WRAP_T, static_cast<GLint>(desc.wrapT));
+	glSamplerParameteri(m_sampler, GL_TEXTURE_WRAP_R, static_cast<GLint>(desc.wrapR));
+	glSamplerParameterf(m_sampler, GL_TEXTURE_LOD_BIAS, desc.lodBias);
+	checkGl();
+
+	if (desc.depthCompare)
+	{
+		glSamplerParameteri(m_sampler, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+		glSamplerParameteri(m_sampler, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+		checkGl();
+	}
+
+	if (desc.maxAnisotropy > 1.0f && (GLEW_ARB_texture_filter_anisotropic || GLEW_EXT_texture_filter_anisotropic))
+	{
+		GLfloat deviceMaxAnisotropy = 1.0f;
+		glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY, &deviceMaxAnisotropy);
+		checkGl();
+
+		glSamplerParameterf(m_sampler, GL_TEXTURE_MAX_ANISOTROPY, (std::min)(desc.maxAnisotropy, deviceMaxAnisotropy));
+		checkGl();
+	}
+}
+
+Sampler::Sampler(Sampler&& o) noexcept
+{
+	std::swap(o.m_desc, m_desc);
+	std::swap(o.m_sampler, m_sampler);
+}
+
+Sampler::~Sampler() noexcept
+{
+	if (m_sampler != kEmptyHandle)
+	{
+		glDeleteSamplers(1, &m_sampler);
+		checkGl();
+	}
+}
+
+Sampler& Sampler::operator=(Sampler&& o) noexcept
+{
+	if (&o != this)
+	{
+		std::swap(o.m_desc, m_desc);
+		std::swap(o.m_sampler, m_sampler);
+	}
+	return *this;
+}
+
+void Sampler::bind(GLuint unit) const
+{
+	glBindSampler(unit, m_sampler);
+	checkGl();
+}
+
+void Sampler::unbind(GLuint unit)
+{
+	glBindSampler(unit, 0);
+	checkGl();
+}
+
+std::shared_ptr<Sampler> SamplerCache::get(const SamplerDesc& desc)
+{
+	auto& sampler = m_samplers[desc];
+	if (!sampler)
+	{
+		sampler = std::make_shared<Sampler>(desc);
+	}
+	return sampler;
+}
+
+void SamplerCache::bind(GLuint unit, const SamplerDesc& desc)
+{
+	bind(unit, *get(desc));
+}
+
+void SamplerCache::bind(GLuint unit, const Sampler& sampler)
+{
+	if (unit >= m_boundSamplers.size())
+	{
+		m_boundSamplers.resize(unit + 1, 0);
+	}
+
+	if (m_boundSamplers[unit] != sampler.nativeHandle())
+	{
+		sampler.bind(unit);
+		m_boundSamplers[unit] = sampler.nativeHandle();
+	}
+}
+
+void SamplerCache::unbind(GLuint unit)
+{
+	if (unit < m_boundSamplers.size() && m_boundSamplers[unit] != 0)
+	{
+		Sampler::unbind(unit);
+		m_boundSamplers[unit] = 0;
+	}
+}
+
+}
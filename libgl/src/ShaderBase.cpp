@@ -39,6 +39,12 @@ ShaderBase& ShaderBase::operator=(ShaderBase&& o) noexcept
 }
 
 bool ShaderBase::compile(const std::string& src)
+{
+	submitCompile(src);
+	return finishCompile();
+}
+
+void ShaderBase::submitCompile(const std::string& src)
 {
 	assert(!src.empty());
 
@@ -48,7 +54,24 @@ bool ShaderBase::compile(const std::string& src)
 
 	glCompileShader(m_shaderId);
 	checkGl();
+}
+
+bool ShaderBase::isCompileComplete() const
+{
+	if (!parallelCompileSupported())
+	{
+		return true;
+	}
+
+	GLint completionStatus;
+	glGetShaderiv(m_shaderId, GL_COMPLETION_STATUS_KHR, &completionStatus);
+	checkGl();
+
+	return completionStatus == GL_TRUE;
+}
 
+bool ShaderBase::finishCompile()
+{
 	GLint logSize;
 	glGetShaderiv(m_shaderId, GL_INFO_LOG_LENGTH, &logSize);
 	checkGl();
@@ -67,4 +90,9 @@ bool ShaderBase::compile(const std::string& src)
 	return compileStatus == GL_TRUE;
 }
 
+bool ShaderBase::parallelCompileSupported() noexcept
+{
+	return GLEW_KHR_parallel_shader_compile || GLEW_ARB_parallel_shader_compile;
+}
+
 }
@@ -0,0 +1,520 @@
+#include <ShaderCache.hpp>
+#include <ShaderProgram.hpp>
+#include <glstring.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <future>
+
+namespace libgl
+{
+
+// version 2 added the flags word, version 1 entries are rejected and replaced as they are met
+static constexpr char kBinaryMagic[4] = { 'G', 'L', 'S', '2' };
+static constexpr std::uint32_t kSeparableFlag = 1;
+static constexpr std::string_view kIndexHeader = "glsc-index 1";
+static constexpr std::string_view kIndexName = "index";
+static constexpr std::string_view kBinaryExtension = ".bin";
+static constexpr std::string_view kTemporaryExtension = ".tmp";
+
+static std::uint64_t rotl64(std::uint64_t x, int r)
+{
+	return (x << r) | (x >> (64 - r));
+}
+
+static std::uint64_t fmix64(std::uint64_t k)
+{
+	k ^= k >> 33;
+	k *= 0xff51afd7ed558ccdull;
+	k ^= k >> 33;
+	k *= 0xc4ceb9fe1a85ec53ull;
+	k ^= k >> 33;
+	return k;
+}
+
+static std::uint64_t readU64(const std::uint8_t* p)
+{
+	std::uint64_t result = 0;
+	for (int i = 7; i >= 0; --i)
+	{
+		result = (result << 8) | p[i];
+	}
+	return result;
+}
+
+//
+// MurmurHash3_x64_128 by Austin Appleby, public domain.
+// Not cryptographic, 128 bits make accidental collisions between cache entries practically impossible.
+//
+static ShaderCacheKey murmurHash3(const std::vector<std::uint8_t>& data, std::uint64_t seed)
+{
+	constexpr std::uint64_t c1 = 0x87c37b91114253d5ull;
+	constexpr std::uint64_t c2 = 0x4cf5ad432745937full;
+
+	const auto* bytes = data.data();
+	const auto blocksCount = data.size() / 16;
+
+	std::uint64_t h1 = seed;
+	std::uint64_t h2 = seed;
+
+	for (std::size_t i = 0; i < blocksCount; ++i)
+	{
+		auto k1 = readU64(bytes + i * 16);
+		auto k2 = readU64(bytes + i * 16 + 8);
+
+		k1 *= c1; k1 = rotl64(k1, 31); k1 *= c2; h1 ^= k1;
+		h1 = rotl64(h1, 27); h1 += h2; h1 = h1 * 5 + 0x52dce729;
+
+		k2 *= c2; k2 = rotl64(k2, 33); k2 *= c1; h2 ^= k2;
+		h2 = rotl64(h2, 31); h2 += h1; h2 = h2 * 5 + 0x38495ab5;
+	}
+
+	const auto* tail = bytes + blocksCount * 16;
+	const auto tailSize = data.size() & 15;
+
+	std::uint64_t k1 = 0;
+	std::uint64_t k2 = 0;
+	for (auto i = tailSize; i > 8; --i)
+	{
+		k2 = (k2 << 8) | tail[i - 1];
+	}
+	for (auto i = (std::min)(tailSize, std::size_t(8)); i > 0; --i)
+	{
+		k1 = (k1 << 8) | tail[i - 1];
+	}
+
+	if (tailSize > 8)
+	{
+		k2 *= c2; k2 = rotl64(k2, 33); k2 *= c1; h2 ^= k2;
+	}
+	if (tailSize > 0)
+	{
+		k1 *= c1; k1 = rotl64(k1, 31); k1 *= c2; h1 ^= k1;
+	}
+
+	h1 ^= data.size();
+	h2 ^= data.size();
+
+	h1 += h2;
+	h2 += h1;
+
+	h1 = fmix64(h1);
+	h2 = fmix64(h2);
+
+	h1 += h2;
+	h2 += h1;
+
+	return { h1, h2 };
+}
+
+static void appendPart(std::vector<std::uint8_t>& out, std::string_view part)
+{
+	auto length = static_cast<std::uint64_t>(part.size());
+	for (int i = 0; i < 8; ++i)
+	{
+		out.push_back(static_cast<std::uint8_t>(length >> (i * 8)));
+	}
+	out.insert(out.end(), part.begin(), part.end());
+}
+
+static void writeAtomically(const std::filesystem::path& path, const void* data, std::size_t size)
+{
+	auto temporaryPath = path;
+	temporaryPath += kTemporaryExtension;
+
+	{
+		std::ofstream stream(temporaryPath, std::ios_base::binary | std::ios_base::trunc);
+		stream.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+		if (stream.flush().fail())
+		{
+			throw std::system_error(std::make_error_code(std::errc::io_error), temporaryPath.string());
+		}
+	}
+
+	// rename is atomic on POSIX, Windows refuses to replace an existing file
+	std::error_code error;
+	std::filesystem::rename(temporaryPath, path, error);
+	if (error)
+	{
+		std::filesystem::remove(path, error);
+		std::filesystem::rename(temporaryPath, path);
+	}
+}
+
+std::string ShaderCacheKey::toString() const
+{
+	std::ostringstream stream;
+	stream << std::hex << std::setfill('0') << std::setw(16) << high << std::setw(16) << low;
+	return stream.str();
+}
+
+ShaderCache::ShaderCache(std::filesystem::path directory, std::uintmax_t maxBytes) :
+	m_directory(std::move(directory)),
+	m_maxBytes(maxBytes)
+{
+	std::filesystem::create_directories(m_directory);
+	loadIndex();
+}
+
+ShaderCache::~ShaderCache()
+{
+	if (m_prewarmThread.joinable())
+	{
+		m_prewarmThread.join();
+	}
+
+	try
+	{
+		flush();
+	}
+	catch (const std::exception& e)
+	{
+		std::cout << "shader cache index was not saved: " << e.what() << '\n';
+	}
+}
+
+ShaderCacheKey ShaderCache::makeKey(const std::vector<std::string_view>& parts) const
+{
+	{
+		std::lock_guard lock(m_mutex);
+		if (m_driverFingerprint.empty())
+		{
+			std::vector<std::uint8_t> fingerprint;
+			appendPart(fingerprint, detail::getGlString(GL_VENDOR));
+			appendPart(fingerprint, detail::getGlString(GL_RENDERER));
+			appendPart(fingerprint, detail::getGlString(GL_VERSION));
+			appendPart(fingerprint, detail::getGlString(GL_SHADING_LANGUAGE_VERSION));
+			m_driverFingerprint.assign(fingerprint.begin(), fingerprint.end());
+		}
+	}
+
+	std::vector<std::uint8_t> data(m_driverFingerprint.begin(), m_driverFingerprint.end());
+	for (const auto& part : parts)
+	{
+		appendPart(data, part);
+	}
+
+	return murmurHash3(data, 0);
+}
+
+std::shared_ptr<ShaderProgram> ShaderCache::load(const ShaderCacheKey& key)
+{
+	std::lock_guard lock(m_mutex);
+
+	const auto name = key.toString();
+	auto it = m_index.find(name);
+	if (it == m_index.end())
+	{
+		++m_stats.misses;
+		return {};
+	}
+
+	std::shared_ptr<ShaderProgram> program;
+	if (auto prewarmed = m_prewarmed.find(name); prewarmed != m_prewarmed.end())
+	{
+		program = std::move(prewarmed->second);
+		m_prewarmed.erase(prewarmed);
+	}
+	else
+	{
+		program = std::make_shared<ShaderProgram>();
+		if (!setBinary(*program, readEntry(entryPath(name))))
+		{
+			remove(name);
+			++m_stats.rejected;
+			++m_stats.misses;
+			return {};
+		}
+	}
+
+	it->second.lastUsed = ++m_tick;
+	m_indexDirty = true;
+	++m_stats.hits;
+	return program;
+}
+
+void ShaderCache::beginPrewarm(GLFWwindow* mainWindow)
+{
+	assert(!m_prewarmThread.joinable());
+
+	std::vector<std::filesystem::path> paths;
+	{
+		std::lock_guard lock(m_mutex);
+		for (const auto& [name, entry] : m_index)
+		{
+			paths.push_back(entryPath(name));
+		}
+	}
+
+	// GLFW creates windows on the main thread only, the context itself may be used from any thread
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	m_prewarmWindow = glfwCreateWindow(1, 1, "shader prewarm", nullptr, mainWindow);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+	if (m_prewarmWindow == nullptr)
+	{
+		throw std::runtime_error("glfw failed to create a shared context");
+	}
+
+	m_prewarmThread = std::thread([this, paths = std::move(paths)]()
+	{
+		try
+		{
+			prewarm(paths);
+		}
+		catch (...)
+		{
+			m_prewarmError = std::current_exception();
+		}
+	});
+}
+
+std::size_t ShaderCache::finishPrewarm()
+{
+	if (m_prewarmThread.joinable())
+	{
+		m_prewarmThread.join();
+	}
+
+	if (m_prewarmWindow)
+	{
+		glfwDestroyWindow(m_prewarmWindow);
+		m_prewarmWindow = nullptr;
+	}
+
+	if (m_prewarmError)
+	{
+		std::rethrow_exception(std::exchange(m_prewarmError, nullptr));
+	}
+
+	std::lock_guard lock(m_mutex);
+	return m_prewarmed.size();
+}
+
+void ShaderCache::releasePrewarmed()
+{
+	std::lock_guard lock(m_mutex);
+	m_prewarmed.clear();
+}
+
+void ShaderCache::prewarm(const std::vector<std::filesystem::path>& paths)
+{
+	// reading is spread over a few threads, the GL part stays on this one
+	const auto readersCount = (std::min)(paths.size(), std::size_t((std::max)(1u, std::thread::hardware_concurrency())));
+	std::vector<std::vector<char>> binaries(paths.size());
+	std::vector<std::future<void>> readers;
+	for (std::size_t reader = 0; reader < readersCount; ++reader)
+	{
+		readers.push_back(std::async(std::launch::async, [&, reader]()
+		{
+			for (auto i = reader; i < paths.size(); i += readersCount)
+			{
+				binaries[i] = readEntry(paths[i]);
+			}
+		}));
+	}
+	for (auto& reader : readers)
+	{
+		reader.get();
+	}
+
+	glfwMakeContextCurrent(m_prewarmWindow);
+
+	// released on every exit, finishPrewarm() destroys the window once the thread is joined
+	struct ContextRelease
+	{
+		~ContextRelease()
+		{
+			// the programs are used from the main context right after the join
+			glFinish();
+			glfwMakeContextCurrent(nullptr);
+		}
+	} contextRelease;
+
+	for (std::size_t i = 0; i < paths.size(); ++i)
+	{
+		auto program = std::make_shared<ShaderProgram>();
+		const auto accepted = setBinary(*program, binaries[i]);
+
+		const auto name = paths[i].stem().string();
+		std::lock_guard lock(m_mutex);
+		if (accepted)
+		{
+			m_prewarmed[name] = std::move(program);
+		}
+		else
+		{
+			remove(name);
+			++m_stats.rejected;
+		}
+	}
+}
+
+void ShaderCache::store(const ShaderCacheKey& key, const ShaderProgram& program)
+{
+	auto binary = program.binary();
+	if (binary.empty())
+	{
+		return;
+	}
+
+	// the separable flag must be set before glProgramBinary, so it is kept next to the binary
+	const std::uint32_t flags = program.separable() ? kSeparableFlag : 0;
+	char header[sizeof(kBinaryMagic) + sizeof(flags)];
+	std::memcpy(header, kBinaryMagic, sizeof(kBinaryMagic));
+	std::memcpy(header + sizeof(kBinaryMagic), &flags, sizeof(flags));
+	binary.insert(binary.begin(), std::begin(header), std::end(header));
+
+	std::lock_guard lock(m_mutex);
+
+	const auto name = key.toString();
+	writeAtomically(entryPath(name), binary.data(), binary.size());
+
+	auto& entry = m_index[name];
+	m_stats.totalBytes -= entry.bytes;
+	entry.bytes = binary.size();
+	entry.lastUsed = ++m_tick;
+	m_stats.totalBytes += entry.bytes;
+	++m_stats.stores;
+
+	evict();
+	saveIndex();
+}
+
+void ShaderCache::flush()
+{
+	std::lock_guard lock(m_mutex);
+	if (m_indexDirty)
+	{
+		saveIndex();
+	}
+}
+
+ShaderCacheStats ShaderCache::stats() const
+{
+	std::lock_guard lock(m_mutex);
+	return m_stats;
+}
+
+ShaderCache& ShaderCache::instance()
+{
+	static ShaderCache cache(std::filesystem::current_path() / "shader_cache");
+	return cache;
+}
+
+std::vector<char> ShaderCache::readEntry(const std::filesystem::path& path)
+{
+	std::ifstream stream(path, std::ios_base::binary | std::ios_base::ate);
+	if (stream.fail())
+	{
+		return {};
+	}
+
+	std::vector<char> result(static_cast<std::size_t>(stream.tellg()));
+	stream.seekg(0);
+	if (!stream.read(result.data(), static_cast<std::streamsize>(result.size())))
+	{
+		return {};
+	}
+	return result;
+}
+
+bool ShaderCache::setBinary(ShaderProgram& program, const std::vector<char>& binary)
+{
+	// truncated or foreign files are rejected before reaching the driver
+	std::uint32_t flags;
+	const auto headerSize = sizeof(kBinaryMagic) + sizeof(flags) + sizeof(GLenum);
+	if (binary.size() <= headerSize || std::memcmp(binary.data(), kBinaryMagic, sizeof(kBinaryMagic)) != 0)
+	{
+		return false;
+	}
+
+	std::memcpy(&flags, binary.data() + sizeof(kBinaryMagic), sizeof(flags));
+	if (flags & kSeparableFlag)
+	{
+		program.makeSeparable();
+	}
+
+	GLenum format;
+	std::memcpy(&format, binary.data() + sizeof(kBinaryMagic) + sizeof(flags), sizeof(GLenum));
+	return program.trySetBinary(format, binary.data() + headerSize, binary.size() - headerSize);
+}
+
+std::filesystem::path ShaderCache::entryPath(const std::string& name) const
+{
+	auto result = m_directory / name;
+	result += kBinaryExtension;
+	return result;
+}
+
+void ShaderCache::loadIndex()
+{
+	std::ifstream stream(m_directory / kIndexName);
+
+	std::string header;
+	if (!std::getline(stream, header) || header != kIndexHeader || !(stream >> m_tick))
+	{
+		m_tick = 0;
+		return;
+	}
+
+	std::string name;
+	IndexEntry entry;
+	while (stream >> name >> entry.bytes >> entry.lastUsed)
+	{
+		// binaries deleted behind our back or left from a crash before the index was saved
+		std::error_code error;
+		if (std::filesystem::file_size(entryPath(name), error) != entry.bytes || error)
+		{
+			continue;
+		}
+
+		m_index[name] = entry;
+		m_stats.totalBytes += entry.bytes;
+	}
+}
+
+void ShaderCache::saveIndex()
+{
+	std::ostringstream stream;
+	stream << kIndexHeader << '\n' << m_tick << '\n';
+	for (const auto& [name, entry] : m_index)
+	{
+		stream << name << ' ' << entry.bytes << ' ' << entry.lastUsed << '\n';
+	}
+
+	const auto content = stream.str();
+	writeAtomically(m_directory / kIndexName, content.data(), content.size());
+	m_indexDirty = false;
+}
+
+void ShaderCache::evict()
+{
+	while (m_stats.totalBytes > m_maxBytes && !m_index.empty())
+	{
+		const auto lru = std::min_element(m_index.begin(), m_index.end(), [](const auto& a, const auto& b)
+		{
+			return a.second.lastUsed < b.second.lastUsed;
+		});
+
+		remove(lru->first);
+		++m_stats.evictions;
+	}
+}
+
+void ShaderCache::remove(const std::string& name)
+{
+	if (auto it = m_index.find(name); it != m_index.end())
+	{
+		m_stats.totalBytes -= it->second.bytes;
+		m_index.erase(it);
+		m_indexDirty = true;
+	}
+
+	std::error_code error;
+	std::filesystem::remove(entryPath(name), error);
+}
+
+}
@@ -0,0 +1,216 @@
+#include <ShaderCompileQueue.hpp>
+#include <ShaderPreprocessor.hpp>
+#include <ShaderVariants.hpp>
+
+#include <algorithm>
+
+namespace libgl
+{
+
+static std::string_view stageKeyName(GLenum stage)
+{
+	switch (stage)
+	{
+	case GL_VERTEX_SHADER: return "vs";
+	case GL_TESS_CONTROL_SHADER: return "tcs";
+	case GL_TESS_EVALUATION_SHADER: return "tes";
+	case GL_GEOMETRY_SHADER: return "gs";
+	case GL_FRAGMENT_SHADER: return "fs";
+	case GL_COMPUTE_SHADER: return "cs";
+	default: throw std::invalid_argument("unknown shader stage");
+	}
+}
+
+ProgramBuild::ProgramBuild(std::string vertexSource, std::string fragmentSource)
+{
+	auto& cache = ShaderCache::instance();
+
+	m_key = cache.makeKey({ "vs", vertexSource, "fs", fragmentSource });
+	m_program = cache.load(m_key);
+	if (m_program)
+	{
+		m_program->m_stats.fromCache = true;
+		m_state = State::DONE;
+		return;
+	}
+
+	m_submitTime = Clock::now();
+
+	m_program = std::make_shared<ShaderProgram>();
+	submitCompile(GL_VERTEX_SHADER, vertexSource);
+	submitCompile(GL_FRAGMENT_SHADER, fragmentSource);
+}
+
+ProgramBuild::ProgramBuild(GLenum stage, std::string source, bool separable)
+{
+	auto& cache = ShaderCache::instance();
+
+	// a different key prefix, the same vertex source linked separably yields a different binary
+	m_key = cache.makeKey({ separable ? "separable" : "stage", stageKeyName(stage), source });
+	m_program = cache.load(m_key);
+	if (m_program)
+	{
+		m_program->m_stats.fromCache = true;
+		m_state = State::DONE;
+		return;
+	}
+
+	m_submitTime = Clock::now();
+
+	m_program = std::make_shared<ShaderProgram>();
+	if (separable)
+	{
+		m_program->makeSeparable();
+	}
+	submitCompile(stage, source);
+}
+
+void ProgramBuild::submitCompile(GLenum stage, const std::string& source)
+{
+	auto shader = std::make_unique<ShaderBase>(stage);
+	shader->submitCompile(source);
+	m_shaders.push_back(std::move(shader));
+}
+
+bool ProgramBuild::poll(bool wait)
+{
+	if (m_state == State::COMPILING)
+	{
+		if (!wait && !std::all_of(m_shaders.begin(), m_shaders.end(), [](const auto& shader) { return shader->isCompileComplete(); }))
+		{
+			return false;
+		}
+
+		for (const auto& shader : m_shaders)
+		{
+			if (!shader->finishCompile())
+			{
+				fail(shader->compilationLog());
+				return true;
+			}
+			m_program->attach(*shader);
+		}
+
+		const auto now = Clock::now();
+		m_program->m_stats.compileMilliseconds = std::chrono::duration<double, std::milli>(now - m_submitTime).count();
+		m_submitTime = now;
+
+		m_program->submitLink();
+		m_state = State::LINKING;
+	}
+
+	if (m_state == State::LINKING)
+	{
+		if (!wait && !m_program->isLinkComplete())
+		{
+			return false;
+		}
+
+		if (!m_program->finishLink())
+		{
+			fail(m_program->linkLog());
+			return true;
+		}
+		m_program->m_stats.linkMilliseconds = std::chrono::duration<double, std::milli>(Clock::now() - m_submitTime).count();
+
+		ShaderCache::instance().store(m_key, *m_program);
+
+		m_shaders.clear();
+		m_state = State::DONE;
+	}
+
+	return true;
+}
+
+std::shared_ptr<ShaderProgram> ProgramBuild::program() const
+{
+	assert(finished());
+	if (m_state == State::FAILED)
+	{
+		throw std::invalid_argument(m_error);
+	}
+
+	return m_program;
+}
+
+void ProgramBuild::fail(const std::string& log)
+{
+	m_error = log;
+	m_program.reset();
+	m_shaders.clear();
+	m_state = State::FAILED;
+}
+
+bool ProgramHandle::ready() const
+{
+	assert(valid());
+	return m_build->poll(false);
+}
+
+std::shared_ptr<ShaderProgram> ProgramHandle::get() const
+{
+	assert(valid());
+	m_build->poll(true);
+	return m_build->program();
+}
+
+ShaderCompileQueue::ShaderCompileQueue()
+{
+	if (GLEW_KHR_parallel_shader_compile)
+	{
+		glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+		checkGl();
+	}
+	else if (GLEW_ARB_parallel_shader_compile)
+	{
+		glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+		checkGl();
+	}
+}
+
+ProgramHandle ShaderCompileQueue::submit(const std::filesystem::path& vertexPath, const std::filesystem::path& fragmentPath)
+{
+	auto& preprocessor = ShaderPreprocessor::instance();
+	return submitSources(preprocessor.load(vertexPath).text, preprocessor.load(fragmentPath).text);
+}
+
+ProgramHandle ShaderCompileQueue::submitSources(std::string vertexSource, std::string fragmentSource)
+{
+	auto build = std::make_shared<ProgramBuild>(std::move(vertexSource), std::move(fragmentSource));
+	if (!build->finished())
+	{
+		m_pending.push_back(build);
+	}
+
+	return ProgramHandle(std::move(build));
+}
+
+ProgramHandle ShaderCompileQueue::submitStage(GLenum stage, const std::filesystem::path& path, const std::vector<std::string>& defines)
+{
+	auto build = std::make_shared<ProgramBuild>(stage, ShaderVariants::injectDefines(ShaderPreprocessor::instance().load(path).text, defines));
+	if (!build->finished())
+	{
+		m_pending.push_back(build);
+	}
+
+	return ProgramHandle(std::move(build));
+}
+
+void ShaderCompileQueue::poll()
+{
+	m_pending.erase(std::remove_if(m_pending.begin(), m_pending.end(), [](const auto& build)
+	{
+		return build->poll(false);
+	}), m_pending.end());
+}
+
+void ShaderCompileQueue::finish()
+{
+	for (const auto& build : m_pending)
+	{
+		build->poll(true);
+	}
+	m_pending.clear();
+}
+
+}
@@ -0,0 +1,207 @@
+#include <ShaderHotReload.hpp>
+#include <ShaderCache.hpp>
+#include <ShaderPreprocessor.hpp>
+#include <ShaderVariants.hpp>
+
+#include <algorithm>
+#include <iostream>
+
+namespace libgl
+{
+
+ShaderHotReload::ShaderHotReload(GLFWwindow* mainWindow, const std::filesystem::path& watchedDirectory) :
+	m_watcher(watchedDirectory)
+{
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	m_window = glfwCreateWindow(1, 1, "shader hot reload", nullptr, mainWindow);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+	if (m_window == nullptr)
+	{
+		throw std::runtime_error("glfw failed to create a shared context");
+	}
+
+	m_thread = std::thread(&ShaderHotReload::run, this);
+}
+
+ShaderHotReload::~ShaderHotReload()
+{
+	{
+		std::lock_guard lock(m_mutex);
+		m_stop = true;
+	}
+	m_wakeUp.notify_all();
+	m_thread.join();
+
+	glfwDestroyWindow(m_window);
+}
+
+void ShaderHotReload::track(std::shared_ptr<ShaderProgram> program, std::filesystem::path vertexPath, std::filesystem::path fragmentPath, std::vector<std::string> defines)
+{
+	auto& preprocessor = ShaderPreprocessor::instance();
+
+	TrackedProgram tracked;
+	tracked.dependencies = preprocessor.load(vertexPath).dependencies;
+	for (const auto& dependency : preprocessor.load(fragmentPath).dependencies)
+	{
+		tracked.dependencies.push_back(dependency);
+	}
+	tracked.attribLocations = program->activeAttribLocations();
+	tracked.program = std::move(program);
+	tracked.vertexPath = std::move(vertexPath);
+	tracked.fragmentPath = std::move(fragmentPath);
+	tracked.defines = std::move(defines);
+
+	std::lock_guard lock(m_mutex);
+	m_tracked.emplace_back(std::move(tracked));
+}
+
+bool ShaderHotReload::update()
+{
+	std::vector<ReadyProgram> ready;
+	{
+		std::lock_guard lock(m_mutex);
+		if (m_error)
+		{
+			std::rethrow_exception(std::exchange(m_error, nullptr));
+		}
+		std::swap(ready, m_ready);
+	}
+
+	// the replacement objects take the old GL programs with them
+	for (auto& program : ready)
+	{
+		program.target->swapProgram(*program.replacement);
+	}
+
+	return !ready.empty();
+}
+
+void ShaderHotReload::run()
+{
+	try
+	{
+		glfwMakeContextCurrent(m_window);
+
+		while (true)
+		{
+			{
+				std::unique_lock lock(m_mutex);
+				if (m_wakeUp.wait_for(lock, FileWatcher::kPollInterval, [this]() { return m_stop; }))
+				{
+					break;
+				}
+			}
+
+			const auto changes = m_watcher.takeChanges();
+			if (changes.empty())
+			{
+				continue;
+			}
+
+			auto& preprocessor = ShaderPreprocessor::instance();
+			for (const auto& change : changes)
+			{
+				preprocessor.invalidate(change);
+			}
+
+			// copies, so the main thread never waits for a compilation in update()
+			std::vector<TrackedProgram> affected;
+			{
+				std::lock_guard lock(m_mutex);
+				std::copy_if(m_tracked.begin(), m_tracked.end(), std::back_inserter(affected), [&](const TrackedProgram& tracked)
+				{
+					return std::any_of(changes.begin(), changes.end(), [&](const std::filesystem::path& change)
+					{
+						return std::find(tracked.dependencies.begin(), tracked.dependencies.end(), change) != tracked.dependencies.end();
+					});
+				});
+			}
+
+			for (auto& tracked : affected)
+			{
+				rebuild(tracked);
+			}
+		}
+
+		glfwMakeContextCurrent(nullptr);
+	}
+	catch (...)
+	{
+		std::lock_guard lock(m_mutex);
+		m_error = std::current_exception();
+	}
+}
+
+void ShaderHotReload::rebuild(TrackedProgram& tracked)
+{
+	std::cout << "Reloading " << tracked.vertexPath.filename() << ' ' << tracked.fragmentPath.filename() << '\n';
+
+	std::string vertexSource;
+	std::string fragmentSource;
+	std::vector<std::filesystem::path> dependencies;
+	try
+	{
+		auto& preprocessor = ShaderPreprocessor::instance();
+		auto vertex = preprocessor.load(tracked.vertexPath);
+		auto fragment = preprocessor.load(tracked.fragmentPath);
+
+		vertexSource = ShaderVariants::injectDefines(vertex.text, tracked.defines);
+		fragmentSource = ShaderVariants::injectDefines(fragment.text, tracked.defines);
+		dependencies = std::move(vertex.dependencies);
+		dependencies.insert(dependencies.end(), fragment.dependencies.begin(), fragment.dependencies.end());
+	}
+	catch (const std::exception& e)
+	{
+		// e.g. an include added before the file itself was saved
+		std::cout << e.what() << '\n';
+		return;
+	}
+
+	{
+		// a new include has to be watched even when this build fails
+		std::lock_guard lock(m_mutex);
+		for (auto& entry : m_tracked)
+		{
+			if (entry.program == tracked.program)
+			{
+				entry.dependencies = dependencies;
+			}
+		}
+	}
+
+	ShaderBase vertexShader(GL_VERTEX_SHADER);
+	vertexShader.submitCompile(vertexSource);
+	ShaderBase fragmentShader(GL_FRAGMENT_SHADER);
+	fragmentShader.submitCompile(fragmentSource);
+
+	if (!vertexShader.finishCompile())
+	{
+		std::cout << tracked.vertexPath.filename() << ": " << vertexShader.compilationLog() << '\n';
+		return;
+	}
+	if (!fragmentShader.finishCompile())
+	{
+		std::cout << tracked.fragmentPath.filename() << ": " << fragmentShader.compilationLog() << '\n';
+		return;
+	}
+
+	auto replacement = std::make_shared<ShaderProgram>();
+	replacement->bindAttribLocations(tracked.attribLocations);
+	replacement->submitLink(vertexShader, fragmentShader);
+	if (!replacement->finishLink())
+	{
+		std::cout << "link failed: " << replacement->linkLog() << '\n';
+		return;
+	}
+
+	auto& cache = ShaderCache::instance();
+	cache.store(cache.makeKey({ "vs", vertexSource, "fs", fragmentSource }), *replacement);
+
+	// the program is used from the main context as soon as it is handed over
+	glFinish();
+
+	std::lock_guard lock(m_mutex);
+	m_ready.push_back({ tracked.program, std::move(replacement) });
+}
+
+}
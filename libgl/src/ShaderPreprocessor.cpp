@@ -0,0 +1,206 @@
+#include <ShaderPreprocessor.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <system_error>
+
+namespace libgl
+{
+
+static std::string_view trimLeft(std::string_view line)
+{
+	const auto first = line.find_first_not_of(" \t");
+	return first == std::string_view::npos ? std::string_view() : line.substr(first);
+}
+
+static bool startsWithDirective(std::string_view line, std::string_view directive)
+{
+	if (line.empty() || line.front() != '#')
+	{
+		return false;
+	}
+
+	// "# include" is as valid as "#include"
+	line = trimLeft(line.substr(1));
+	return line.compare(0, directive.size(), directive) == 0
+		&& (line.size() == directive.size() || line[directive.size()] == ' ' || line[directive.size()] == '\t' || line[directive.size()] == '"' || line[directive.size()] == '<');
+}
+
+static std::string parseIncludeName(std::string_view line, const std::filesystem::path& file, std::size_t lineNumber)
+{
+	const auto open = line.find_first_of("\"<");
+	const auto close = open == std::string_view::npos ? open : line.find(line[open] == '"' ? '"' : '>', open + 1);
+	if (close == std::string_view::npos)
+	{
+		throw std::invalid_argument(file.string() + ':' + std::to_string(lineNumber) + ": malformed #include");
+	}
+
+	return std::string(line.substr(open + 1, close - open - 1));
+}
+
+void ShaderPreprocessor::addIncludeDirectory(std::filesystem::path directory)
+{
+	std::lock_guard lock(m_mutex);
+	m_includeDirectories.emplace_back(std::filesystem::weakly_canonical(directory));
+}
+
+ShaderSource ShaderPreprocessor::load(const std::filesystem::path& path)
+{
+	const auto canonicalPath = std::filesystem::weakly_canonical(path);
+
+	std::lock_guard lock(m_mutex);
+	if (auto it = m_cache.find(canonicalPath); it != m_cache.end() && isUpToDate(it->second))
+	{
+		return it->second.source;
+	}
+
+	ExpansionState state;
+	expand(canonicalPath, state);
+
+	CacheEntry entry;
+	entry.source = std::move(state.result);
+	for (const auto& dependency : entry.source.dependencies)
+	{
+		entry.timestamps.push_back(std::filesystem::last_write_time(dependency));
+	}
+
+	return (m_cache[canonicalPath] = std::move(entry)).source;
+}
+
+std::vector<std::filesystem::path> ShaderPreprocessor::dependents(const std::filesystem::path& file) const
+{
+	const auto canonicalFile = std::filesystem::weakly_canonical(file);
+
+	std::lock_guard lock(m_mutex);
+	std::vector<std::filesystem::path> result;
+	for (const auto& [root, entry] : m_cache)
+	{
+		const auto& dependencies = entry.source.dependencies;
+		if (std::find(dependencies.begin(), dependencies.end(), canonicalFile) != dependencies.end())
+		{
+			result.push_back(root);
+		}
+	}
+	return result;
+}
+
+void ShaderPreprocessor::invalidate(const std::filesystem::path& file)
+{
+	const auto canonicalFile = std::filesystem::weakly_canonical(file);
+
+	std::lock_guard lock(m_mutex);
+	for (auto it = m_cache.begin(); it != m_cache.end();)
+	{
+		const auto& dependencies = it->second.source.dependencies;
+		if (std::find(dependencies.begin(), dependencies.end(), canonicalFile) != dependencies.end())
+		{
+			it = m_cache.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+}
+
+ShaderPreprocessor& ShaderPreprocessor::instance()
+{
+	static ShaderPreprocessor preprocessor;
+	return preprocessor;
+}
+
+std::filesystem::path ShaderPreprocessor::resolve(const std::string& name, const std::filesystem::path& includingFile) const
+{
+	if (auto candidate = includingFile.parent_path() / name; std::filesystem::exists(candidate))
+	{
+		return std::filesystem::weakly_canonical(candidate);
+	}
+
+	for (const auto& directory : m_includeDirectories)
+	{
+		if (auto candidate = directory / name; std::filesystem::exists(candidate))
+		{
+			return std::filesystem::weakly_canonical(candidate);
+		}
+	}
+
+	throw std::invalid_argument(includingFile.string() + ": cannot resolve #include \"" + name + '"');
+}
+
+void ShaderPreprocessor::expand(const std::filesystem::path& path, ExpansionState& state) const
+{
+	if (std::find(state.stack.begin(), state.stack.end(), path) != state.stack.end())
+	{
+		throw std::invalid_argument(path.string() + ": #include cycle");
+	}
+
+	if (std::find(state.onceFiles.begin(), state.onceFiles.end(), path) != state.onceFiles.end())
+	{
+		return;
+	}
+
+	auto& dependencies = state.result.dependencies;
+	auto dependency = std::find(dependencies.begin(), dependencies.end(), path);
+	const auto sourceIndex = static_cast<std::size_t>(dependency - dependencies.begin());
+	if (dependency == dependencies.end())
+	{
+		dependencies.push_back(path);
+	}
+
+	std::ifstream stream(path);
+	if (stream.fail())
+	{
+		throw std::system_error(std::make_error_code(std::errc::no_such_file_or_directory), path.string());
+	}
+
+	auto& text = state.result.text;
+	if (!state.stack.empty())
+	{
+		text += "#line 1 " + std::to_string(sourceIndex) + '\n';
+	}
+	state.stack.push_back(path);
+
+	std::string line;
+	for (std::size_t lineNumber = 1; std::getline(stream, line); ++lineNumber)
+	{
+		if (!line.empty() && line.back() == '\r')
+		{
+			line.pop_back();
+		}
+
+		const auto directive = trimLeft(line);
+		if (startsWithDirective(directive, "include"))
+		{
+			expand(resolve(parseIncludeName(directive, path, lineNumber), path), state);
+			text += "#line " + std::to_string(lineNumber + 1) + ' ' + std::to_string(sourceIndex) + '\n';
+		}
+		else if (startsWithDirective(directive, "pragma") && directive.find("once") != std::string_view::npos)
+		{
+			state.onceFiles.push_back(path);
+			text += '\n';
+		}
+		else
+		{
+			text += line;
+			text += '\n';
+		}
+	}
+
+	state.stack.pop_back();
+}
+
+bool ShaderPreprocessor::isUpToDate(const CacheEntry& entry) const
+{
+	for (std::size_t i = 0; i < entry.source.dependencies.size(); ++i)
+	{
+		std::error_code error;
+		if (std::filesystem::last_write_time(entry.source.dependencies[i], error) != entry.timestamps[i] || error)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+}
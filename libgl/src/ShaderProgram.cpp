@@ -1,4 +1,7 @@
 #include <ShaderProgram.hpp>
+#include <ShaderCompileQueue.hpp>
+#include <ShaderPreprocessor.hpp>
+#include <ShaderVariants.hpp>
 
 #include <fstream>
 #include <filesystem>
@@ -6,44 +9,6 @@
 namespace libgl
 {
 
-static std::string fetchString(const std::filesystem::path& path)
-{
-	std::ifstream stream(path);
-	assert(!stream.fail());
-	if (stream.fail())
-	{
-		throw std::system_error(std::make_error_code(std::errc::no_such_file_or_directory));
-	}
-
-	return { std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>() };
-}
-
-static std::vector<char> fetchBinary(const std::filesystem::path& path)
-{
-	std::ifstream stream(path, std::ios_base::binary);
-	assert(!stream.fail());
-	if (stream.fail())
-	{
-		throw std::system_error(std::make_error_code(std::errc::no_such_file_or_directory));
-	}
-
-	return { std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>() };
-}
-
-template<typename Iterator>
-static void writeBinary(std::filesystem::path path, Iterator begin, Iterator end)
-{
-	std::filesystem::create_directory(path.parent_path());
-	std::ofstream writeStream(path, std::ios_base::binary);
-	assert(!writeStream.fail());
-	if (writeStream.fail())
-	{
-		throw std::system_error(std::make_error_code(std::errc::permission_denied));
-	}
-	
-	std::copy(begin, end, std::ostreambuf_iterator<char>(writeStream));
-}
-
 ShaderProgram::ShaderProgram()
 {
 	m_program = glCreateProgram();
@@ -108,45 +73,45 @@ GLint ShaderProgram::attribLoc(const std::string_view& name) const noexcept
 void ShaderProgram::setUniform(const std::string_view& name, GLint scalar)
 {
 	const auto loc = uniformLoc(name);
-	glUniform1i(loc, scalar);
+	glProgramUniform1i(m_program, loc, scalar);
 	checkGl();
 }
 void ShaderProgram::setUniform(const std::string_view& name, GLfloat scalar)
 {
 	const auto loc = uniformLoc(name);
-	glUniform1f(loc, scalar);
+	glProgramUniform1f(m_program, loc, scalar);
 	checkGl();
 }
 void ShaderProgram::setUniform(const std::string_view& name, GLboolean scalar)
 {
 	const auto loc = uniformLoc(name);
-	glUniform1i(loc, static_cast<GLint>(scalar));
+	glProgramUniform1i(m_program, loc, static_cast<GLint>(scalar));
 	checkGl();
 }
 void ShaderProgram::setUniform(const std::string_view& name, bool scalar)
 {
 	const auto loc = uniformLoc(name);
-	glUniform1i(loc, static_cast<GLint>(scalar));
+	glProgramUniform1i(m_program, loc, static_cast<GLint>(scalar));
 	checkGl();
 }
 void ShaderProgram::setUniform(const std::string_view& name, GLfloat x, GLfloat y)
 {
 	const auto loc = uniformLoc(name);
-	glUniform2f(loc, x, y);
+	glProgramUniform2f(m_program, loc, x, y);
 	checkGl();
 }
 
 void ShaderProgram::setUniform(const std::string_view& name, GLfloat x, GLfloat y, GLfloat z)
 {
 	const auto loc = uniformLoc(name);
-	glUniform3f(loc, x, y, z);
+	glProgramUniform3f(m_program, loc, x, y, z);
 	checkGl();
 }
 
 void ShaderProgram::setUniform(const std::string_view& name, GLfloat x, GLfloat y, GLfloat z, GLfloat w)
 {
 	const auto loc = uniformLoc(name);
-	glUniform4f(loc, x, y, z, w);
+	glProgramUniform4f(m_program, loc, x, y, z, w);
 	checkGl();
 }
 
@@ -165,6 +130,11 @@ void ShaderProgram::setUniform(const std::string_view& name, const glm::ivec2& v
 	setUniformIVec2(name, glm::value_ptr(vec));
 }
 
+void ShaderProgram::setUniform(const std::string_view& name, const glm::ivec3& vec)
+{
+	setUniformIVec3(name, glm::value_ptr(vec));
+}
+
 void ShaderProgram::setUniform(const std::string_view& name, const glm::vec2& vec)
 {
 	setUniformVec2(name, glm::value_ptr(vec));
@@ -183,48 +153,62 @@ void ShaderProgram::setUniform(const std::string_view& name, const glm::vec4& ve
 void ShaderProgram::setUniformVec2(const std::string_view& name, const GLfloat* vec2)
 {
 	const auto loc = uniformLoc(name);
-	glUniform2fv(loc, 1, vec2);
+	glProgramUniform2fv(m_program, loc, 1, vec2);
 	checkGl();
 }
 
 void ShaderProgram::setUniformIVec2(const std::string_view& name, const GLint* ivec2)
 {
 	const auto loc = uniformLoc(name);
-	glUniform2iv(loc, 1, ivec2);
+	glProgramUniform2iv(m_program, loc, 1, ivec2);
+	checkGl();
+}
+
+void ShaderProgram::setUniformIVec3(const std::string_view& name, const GLint* ivec3)
+{
+	const auto loc = uniformLoc(name);
+	glProgramUniform3iv(m_program, loc, 1, ivec3);
 	checkGl();
 }
 
 void ShaderProgram::setUniformVec3(const std::string_view& name, const GLfloat* vec3)
 {
 	const auto loc = uniformLoc(name);
-	glUniform3fv(loc, 1, vec3);
+	glProgramUniform3fv(m_program, loc, 1, vec3);
 	checkGl();
 }
 
 void ShaderProgram::setUniformVec4(const std::string_view& name, const GLfloat* vec4)
 {
 	const auto loc = uniformLoc(name);
-	glUniform4fv(loc, 1, vec4);
+	glProgramUniform4fv(m_program, loc, 1, vec4);
 	checkGl();
 }
 
 void ShaderProgram::setUniformMat3(const std::string_view& name, const GLfloat* mat3x3)
 {
 	const auto loc = uniformLoc(name);
-	glUniformMatrix3fv(loc, 1, GL_FALSE, mat3x3);
+	glProgramUniformMatrix3fv(m_program, loc, 1, GL_FALSE, mat3x3);
 	checkGl();
 }
 
 void ShaderProgram::setUniformMat4(const std::string_view& name, const GLfloat* mat4x4)
 {
 	const auto loc = uniformLoc(name);
-	glUniformMatrix4fv(loc, 1, GL_FALSE, mat4x4);
+	glProgramUniformMatrix4fv(m_program, loc, 1, GL_FALSE, mat4x4);
 	checkGl();
 }
 void ShaderProgram::setUniform1Array(const std::string_view& name, const GLfloat* array, GLsizei count)
 {
 	const auto loc = uniformLoc(name);
-	glUniform1fv(loc, count, array);
+	glProgramUniform1fv(m_program, loc, count, array);
+	checkGl();
+}
+
+void ShaderProgram::setUniformVec4Array(const std::string_view& name, const GLfloat* array, GLsizei count)
+{
+	const auto loc = uniformLoc(name);
+	glProgramUniform4fv(m_program, loc, count, array);
 	checkGl();
 }
 
@@ -240,18 +224,124 @@ void ShaderProgram::unbind() noexcept
 	checkGl();
 }
 
-bool ShaderProgram::attachAndCompile(std::shared_ptr<VertexShader> vs, std::shared_ptr<FragmentShader> fs)
+void ShaderProgram::setLabel(std::string label)
 {
-	std::vector<GLchar> rawLog;
+	m_label = std::move(label);
+	applyLabel();
+}
 
-	glAttachShader(m_program, vs->nativeHandle());
+void ShaderProgram::applyLabel() noexcept
+{
+	if (glObjectLabel && !m_label.empty())
+	{
+		glObjectLabel(GL_PROGRAM, m_program, static_cast<GLsizei>(m_label.size()), m_label.data());
+		checkGl();
+	}
+}
+
+void ShaderProgram::swapProgram(ShaderProgram& other) noexcept
+{
+	std::swap(m_program, other.m_program);
+	std::swap(m_linkLog, other.m_linkLog);
+	std::swap(m_stats, other.m_stats);
+	std::swap(m_separable, other.m_separable);
+	std::swap(m_uniformLocations, other.m_uniformLocations);
+	std::swap(m_attributeLocations, other.m_attributeLocations);
+
+	// the label stays with this object
+	applyLabel();
+}
+
+std::vector<std::pair<std::string, GLint>> ShaderProgram::activeAttribLocations() const
+{
+	GLint attributesCount;
+	glGetProgramiv(m_program, GL_ACTIVE_ATTRIBUTES, &attributesCount);
 	checkGl();
 
-	glAttachShader(m_program, fs->nativeHandle());
+	GLint maxNameLength;
+	glGetProgramiv(m_program, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxNameLength);
 	checkGl();
 
+	std::vector<std::pair<std::string, GLint>> result;
+	std::vector<GLchar> name(static_cast<std::size_t>(maxNameLength) + 1);
+	for (GLint i = 0; i < attributesCount; ++i)
+	{
+		GLint size;
+		GLenum type;
+		glGetActiveAttrib(m_program, static_cast<GLuint>(i), static_cast<GLsizei>(name.size()), nullptr, &size, &type, name.data());
+		checkGl();
+
+		const auto location = glGetAttribLocation(m_program, name.data());
+		checkGl();
+
+		// built-ins like gl_VertexID have no location
+		if (location >= 0)
+		{
+			result.emplace_back(name.data(), location);
+		}
+	}
+	return result;
+}
+
+void ShaderProgram::bindAttribLocations(const std::vector<std::pair<std::string, GLint>>& locations)
+{
+	for (const auto& [name, location] : locations)
+	{
+		glBindAttribLocation(m_program, static_cast<GLuint>(location), name.c_str());
+		checkGl();
+	}
+}
+
+bool ShaderProgram::attachAndCompile(std::shared_ptr<VertexShader> vs, std::shared_ptr<FragmentShader> fs)
+{
+	submitLink(*vs, *fs);
+	return finishLink();
+}
+
+void ShaderProgram::submitLink(const ShaderBase& vs, const ShaderBase& fs)
+{
+	attach(vs);
+	attach(fs);
+	submitLink();
+}
+
+void ShaderProgram::attach(const ShaderBase& shader)
+{
+	glAttachShader(m_program, shader.nativeHandle());
+	checkGl();
+}
+
+void ShaderProgram::submitLink()
+{
 	glLinkProgram(m_program);
 	checkGl();
+}
+
+void ShaderProgram::makeSeparable()
+{
+	glProgramParameteri(m_program, GL_PROGRAM_SEPARABLE, GL_TRUE);
+	checkGl();
+
+	m_separable = true;
+}
+
+bool ShaderProgram::isLinkComplete() const
+{
+	if (!ShaderBase::parallelCompileSupported())
+	{
+		return true;
+	}
+
+	GLint completionStatus;
+	glGetProgramiv(m_program, GL_COMPLETION_STATUS_KHR, &completionStatus);
+	checkGl();
+
+	return completionStatus == GL_TRUE;
+}
+
+bool ShaderProgram::finishLink()
+{
+	std::vector<GLchar> rawLog;
 
 	GLint linkInfoLog;
 	glGetProgramiv(m_program, GL_INFO_LOG_LENGTH, &linkInfoLog);
@@ -331,53 +421,43 @@ bool ShaderProgram::trySetBinary(GLenum format, const void* binary, size_t lengt
 	glProgramBinary(m_program, format, binary, static_cast<GLsizei>(length));
 
 	auto status = glGetError();
-	if (status == GL_NO_ERROR)
+	if (status == GL_INVALID_ENUM)
 	{
-		return true;
+		return false;
 	}
 
-	if (status == GL_INVALID_ENUM)
+	if (status != GL_NO_ERROR)
 	{
-		return false;
+		detail::checkGLStatus(status, __FUNCTION__, __FILE__, __LINE__);
+		std::terminate();
 	}
 
-	detail::checkGLStatus(status, __FUNCTION__, __FILE__, __LINE__);
-	std::terminate();
+	// drivers reject outdated binaries by failing the link rather than with an error
+	GLint linkStatus;
+	glGetProgramiv(m_program, GL_LINK_STATUS, &linkStatus);
+	checkGl();
+
+	return linkStatus;
 }
 
 std::shared_ptr<ShaderProgram> ShaderProgram::make(const std::filesystem::path& vertexPath, const std::filesystem::path& fragmentPath)
 {
-	const auto shaderCacheDir = std::filesystem::current_path() / "shader_cache";
-
-	auto vertexSource = fetchString(vertexPath);
-	auto fragmentSource = fetchString(fragmentPath);
+	auto& preprocessor = ShaderPreprocessor::instance();
+	ProgramBuild build(preprocessor.load(vertexPath).text, preprocessor.load(fragmentPath).text);
+	build.poll(true);
 
-	auto programHash = std::hash<std::string>{}(vertexSource) ^ std::hash<std::string>{}(fragmentSource);
-	auto fileName = shaderCacheDir / std::to_string(programHash);
-
-	auto program = std::make_shared<ShaderProgram>();
-
-	if (std::filesystem::exists(fileName))
-	{
-		auto binary = fetchBinary(fileName);
-		if (program->trySetBinary(*reinterpret_cast<GLenum*>(binary.data()), binary.data() + sizeof(GLenum), binary.size() - sizeof(GLenum)))
-		{
-			return program;
-		}
-	}
-
-	auto vs = std::make_shared<VertexShader>(vertexSource);
-	auto fs = std::make_shared<FragmentShader>(fragmentSource);
-	if (!program->attachAndCompile(std::move(vs), std::move(fs)))
-	{
-		throw std::invalid_argument(program->linkLog());
-	}
+	auto program = build.program();
+	program->setLabel(vertexPath.filename().string() + " + " + fragmentPath.filename().string());
+	return program;
+}
 
-	if (auto binary = program->binary(); !binary.empty())
-	{
-		writeBinary(fileName, binary.cbegin(), binary.cend());
-	}
+std::shared_ptr<ShaderProgram> ShaderProgram::makeStage(GLenum stage, const std::filesystem::path& path, const std::vector<std::string>& defines)
+{
+	ProgramBuild build(stage, ShaderVariants::injectDefines(ShaderPreprocessor::instance().load(path).text, defines));
+	build.poll(true);
 
+	auto program = build.program();
+	program->setLabel(ShaderVariants::labelOf(path.filename().string(), defines));
 	return program;
 }
 
@@ -0,0 +1,145 @@
+#include <ShaderVariants.hpp>
+#include <ShaderPreprocessor.hpp>
+
+#include <algorithm>
+
+namespace libgl
+{
+
+ShaderVariants::ShaderVariants(const std::filesystem::path& vertexPath, const std::filesystem::path& fragmentPath, std::vector<std::string> keywords) :
+	m_vertexSource(ShaderPreprocessor::instance().load(vertexPath).text),
+	m_fragmentSource(ShaderPreprocessor::instance().load(fragmentPath).text),
+	m_keywords(std::move(keywords))
+{
+	if (m_keywords.size() > kMaxKeywords)
+	{
+		throw std::invalid_argument("too many shader keywords");
+	}
+}
+
+VariantKey ShaderVariants::key(const std::vector<std::string_view>& enabledKeywords) const
+{
+	VariantKey result = 0;
+	for (const auto& keyword : enabledKeywords)
+	{
+		const auto it = std::find(m_keywords.begin(), m_keywords.end(), keyword);
+		if (it == m_keywords.end())
+		{
+			throw std::invalid_argument("unknown shader keyword: " + std::string(keyword));
+		}
+
+		result |= VariantKey(1) << (it - m_keywords.begin());
+	}
+	return result;
+}
+
+std::shared_ptr<ShaderProgram> ShaderVariants::get(VariantKey key)
+{
+	auto& handle = m_programs[key];
+	if (!handle.valid())
+	{
+		const auto defines = definesOf(key);
+		handle = ProgramHandle(std::make_shared<ProgramBuild>(injectDefines(m_vertexSource, defines), injectDefines(m_fragmentSource, defines)));
+	}
+
+	return handle.get();
+}
+
+ProgramHandle ShaderVariants::request(VariantKey key, ShaderCompileQueue& queue)
+{
+	auto& handle = m_programs[key];
+	if (!handle.valid())
+	{
+		const auto defines = definesOf(key);
+		handle = queue.submitSources(injectDefines(m_vertexSource, defines), injectDefines(m_fragmentSource, defines));
+	}
+
+	return handle;
+}
+
+void ShaderVariants::precompile(const std::vector<VariantKey>& keys, ShaderCompileQueue& queue)
+{
+	for (const auto key : keys)
+	{
+		request(key, queue);
+	}
+}
+
+std::vector<VariantKey> ShaderVariants::usedKeys() const
+{
+	std::vector<VariantKey> result;
+	for (const auto& [key, handle] : m_programs)
+	{
+		result.push_back(key);
+	}
+
+	std::sort(result.begin(), result.end());
+	return result;
+}
+
+std::string ShaderVariants::injectDefines(const std::string& source, const std::vector<std::string>& defines)
+{
+	if (defines.empty())
+	{
+		return source;
+	}
+
+	// #version has to stay the first directive, so the defines go right after it
+	std::size_t insertAt = 0;
+	std::size_t nextLine = 1;
+	for (std::size_t lineStart = 0, line = 1; lineStart < source.size(); ++line)
+	{
+		const auto lineEnd = (std::min)(source.find('\n', lineStart), source.size());
+		const auto first = source.find_first_not_of(" \t", lineStart);
+		if (first < lineEnd && source.compare(first, 8, "#version") == 0)
+		{
+			insertAt = (std::min)(lineEnd + 1, source.size());
+			nextLine = line + 1;
+			break;
+		}
+		lineStart = lineEnd + 1;
+	}
+
+	std::string block;
+	if (insertAt == source.size() && (source.empty() || source.back() != '\n'))
+	{
+		block += '\n';
+	}
+	for (const auto& define : defines)
+	{
+		block += "#define " + define + " 1\n";
+	}
+	block += "#line " + std::to_string(nextLine) + '\n';
+
+	auto result = source;
+	result.insert(insertAt, block);
+	return result;
+}
+
+std::string ShaderVariants::labelOf(std::string name, const std::vector<std::string>& defines)
+{
+	for (std::size_t i = 0; i < defines.size(); ++i)
+	{
+		name += (i == 0 ? " [" : " ") + defines[i];
+	}
+	if (!defines.empty())
+	{
+		name += ']';
+	}
+	return name;
+}
+
+std::vector<std::string> ShaderVariants::definesOf(VariantKey key) const
+{
+	std::vector<std::string> result;
+	for (std::size_t i = 0; i < m_keywords.size(); ++i)
+	{
+		if (key & (VariantKey(1) << i))
+		{
+			result.push_back(m_keywords[i]);
+		}
+	}
+	return result;
+}
+
+}
@@ -0,0 +1,103 @@
+#include <TextureArrayPacker.hpp>
+
+#include <cstring>
+
+namespace libgl
+{
+
+static std::size_t channelsCount(TextureHostFormat format)
+{
+	switch (format)
+	{
+	case TextureHostFormat::RED: return 1;
+	case TextureHostFormat::RG: return 2;
+	case TextureHostFormat::RGB: return 3;
+	case TextureHostFormat::RGBA: return 4;
+	default:
+		throw std::invalid_argument("unsupported host format");
+	}
+}
+
+static std::size_t channelBytes(TextureHostType type)
+{
+	switch (type)
+	{
+	case TextureHostType::UNSIGNED_BYTE: return sizeof(GLubyte);
+	case TextureHostType::FLOAT: return sizeof(GLfloat);
+	default:
+		throw std::invalid_argument("unsupported host type");
+	}
+}
+
+TextureArrayPacker::ImageId TextureArrayPacker::add(TextureDeviceFormat format, GLsizei width, GLsizei height, const TextureData& data)
+{
+	if (width <= 0 || height <= 0 || data.data == nullptr)
+	{
+		throw std::invalid_argument("empty image can't be packed");
+	}
+
+	const auto alignment = static_cast<std::size_t>(data.rowAlignment);
+	const auto rowBytes = std::size_t(width) * channelsCount(data.format) * channelBytes(data.type);
+	const auto rowPitch = (rowBytes + alignment - 1) / alignment * alignment;
+
+	// every layer keeps the source row alignment, so the whole group is uploaded with one unpack state
+	const auto key = GroupKey{ format, data.format, data.type, data.rowAlignment, width, height };
+	auto& group = m_groups[key];
+	group.layerBytes = rowPitch * height;
+
+	const auto* src = static_cast<const std::uint8_t*>(data.data);
+	group.pixels.insert(group.pixels.end(), src, src + group.layerBytes);
+
+	const auto id = m_imagesCount++;
+	group.images.push_back(id);
+	return id;
+}
+
+std::vector<TextureArraySlot> TextureArrayPacker::build(bool generateMipmaps)
+{
+	GLint maxLayers = 0;
+	glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+	checkGl();
+
+	std::vector<TextureArraySlot> result(m_imagesCount);
+
+	for (const auto& [key, group] : m_groups)
+	{
+		const auto& [deviceFormat, hostFormat, hostType, rowAlignment, width, height] = key;
+		const auto imagesCount = static_cast<GLint>(group.images.size());
+
+		for (GLint first = 0; first < imagesCount; first += maxLayers)
+		{
+			const auto layers = (std::min)(maxLayers, imagesCount - first);
+
+			auto texture = std::make_shared<MutableTexture>(MutableTexture::make2DArray(width, height, layers, deviceFormat));
+			texture->bind(kUploadUnit);
+
+			TextureData data;
+			data.format = hostFormat;
+			data.type = hostType;
+			data.rowAlignment = rowAlignment;
+			data.data = group.pixels.data() + group.layerBytes * first;
+			texture->load(data, 0);
+
+			if (generateMipmaps)
+			{
+				texture->generateMipmap();
+			}
+
+			texture->unbind(kUploadUnit);
+
+			for (GLint layer = 0; layer < layers; ++layer)
+			{
+				result[group.images[first + layer]] = { texture, layer };
+			}
+		}
+	}
+
+	m_groups.clear();
+	m_imagesCount = 0;
+
+	return result;
+}
+
+}
@@ -1,8 +1,37 @@
 #include <TextureBase.hpp>
+#include <FrameBufferCache.hpp>
 
 namespace libgl
 {
 
+bool isDepthFormat(TextureDeviceFormat format) noexcept
+{
+	switch (format)
+	{
+	case TextureDeviceFormat::DEPTH_COMPONENT16:
+	case TextureDeviceFormat::DEPTH_COMPONENT24:
+	case TextureDeviceFormat::DEPTH_COMPONENT32F:
+	case TextureDeviceFormat::DEPTH24_STENCIL8:
+	case TextureDeviceFormat::DEPTH32F_STENCIL8:
+		return true;
+	default:
+		return false;
+	}
+}
+
+bool isStencilFormat(TextureDeviceFormat format) noexcept
+{
+	switch (format)
+	{
+	case TextureDeviceFormat::DEPTH24_STENCIL8:
+	case TextureDeviceFormat::DEPTH32F_STENCIL8:
+	case TextureDeviceFormat::STENCIL_INDEX8:
+		return true;
+	default:
+		return false;
+	}
+}
+
 TextureBase::TextureBase(TextureTarget target, TextureDeviceFormat deviceFormat, GLsizei width, GLsizei height) :
 	TextureBase(kEmptyHandle, target, deviceFormat, width, height, 1)
 {
@@ -35,6 +64,7 @@ TextureBase::TextureBase(TextureBase&& o) noexcept
 	std::swap(o.m_width, m_width);
 	std::swap(o.m_height, m_height);
 	std::swap(o.m_depth, m_depth);
+	std::swap(o.m_samples, m_samples);
 	std::swap(o.m_texture, m_texture);
 	std::swap(o.m_hasMipMaps, m_hasMipMaps);
 }
@@ -43,6 +73,7 @@ TextureBase::~TextureBase() noexcept
 {
 	if (m_texture != kEmptyHandle)
 	{
+		FrameBufferCache::notifyDestroyed(GL_TEXTURE, m_texture);
 		glDeleteTextures(1, &m_texture);
 		checkGl();
 	}
@@ -57,6 +88,7 @@ TextureBase& TextureBase::operator=(TextureBase&& o) noexcept
 		std::swap(o.m_width, m_width);
 		std::swap(o.m_height, m_height);
 		std::swap(o.m_depth, m_depth);
+		std::swap(o.m_samples, m_samples);
 		std::swap(o.m_texture, m_texture);
 		std::swap(o.m_hasMipMaps, m_hasMipMaps);
 	}
@@ -83,6 +115,38 @@ void TextureBase::unbind(GLuint slot)
 	checkGl();
 }
 
+void TextureBase::bindImage(GLuint unit, ImageAccess access, GLint level)
+{
+	switch (m_deviceFormat)
+	{
+	case TextureDeviceFormat::R8:
+	case TextureDeviceFormat::RG8:
+	case TextureDeviceFormat::RGBA8:
+	case TextureDeviceFormat::R16F:
+	case TextureDeviceFormat::RG16F:
+	case TextureDeviceFormat::RGBA16F:
+	case TextureDeviceFormat::R11F_G11F_B10F:
+	case TextureDeviceFormat::R32F:
+	case TextureDeviceFormat::RG32F:
+	case TextureDeviceFormat::RGBA32F:
+	case TextureDeviceFormat::R32UI:
+	case TextureDeviceFormat::RG32UI:
+		break;
+	default:
+		throw std::invalid_argument("texture format can't be bound as an image");
+	}
+
+	const auto layered = m_target == TextureTarget::TEXTURE_2D_ARRAY || m_target == TextureTarget::TEXTURE_3D;
+	glBindImageTexture(unit, m_texture, level, layered ? GL_TRUE : GL_FALSE, 0, static_cast<GLenum>(access), static_cast<GLenum>(m_deviceFormat));
+	checkGl();
+}
+
+void TextureBase::unbindImage(GLuint unit)
+{
+	glBindImageTexture(unit, 0, 0, GL_FALSE, 0, GL_READ_ONLY, GL_R8);
+	checkGl();
+}
+
 void TextureBase::generateMipmap()
 {
 	if (m_hasMipMaps) return;
@@ -93,4 +157,77 @@ void TextureBase::generateMipmap()
 	m_hasMipMaps = true;
 }
 
+GLint TextureBase::levelsCount() const noexcept
+{
+	if (!m_hasMipMaps)
+	{
+		return 1;
+	}
+
+	auto size = (std::max)(m_width, m_height);
+	if (m_target == TextureTarget::TEXTURE_3D)
+	{
+		size = (std::max)(size, m_depth);
+	}
+
+	GLint result = 1;
+	while (size > 1)
+	{
+		size /= 2;
+		++result;
+	}
+	return result;
+}
+
+std::size_t TextureBase::memoryUsage() const noexcept
+{
+	std::size_t result = 0;
+	for (GLint level = 0; level < levelsCount(); ++level)
+	{
+		const auto levelDepth = m_target == TextureTarget::TEXTURE_3D ? (std::max)(1, m_depth >> level) : m_depth;
+		result += levelBytes(m_deviceFormat, (std::max)(1, m_width >> level), (std::max)(1, m_height >> level), levelDepth);
+	}
+	return result * (std::max)(1, m_samples);
+}
+
+std::size_t TextureBase::levelBytes(TextureDeviceFormat format, GLsizei width, GLsizei height, GLsizei depth) noexcept
+{
+	const auto texels = std::size_t(width) * height * depth;
+	const auto blocks = std::size_t((width + 3) / 4) * ((height + 3) / 4) * depth;
+
+	switch (format)
+	{
+	case TextureDeviceFormat::R8: return texels;
+	case TextureDeviceFormat::RG8: return texels * 2;
+	// 3-channel formats are padded to 4 bytes per texel by every driver we know of
+	case TextureDeviceFormat::SRGB8:
+	case TextureDeviceFormat::RGB8:
+	case TextureDeviceFormat::SRGB8_ALPHA8:
+	case TextureDeviceFormat::RGBA8: return texels * 4;
+	case TextureDeviceFormat::R16F: return texels * 2;
+	case TextureDeviceFormat::RG16F: return texels * 4;
+	case TextureDeviceFormat::RGB16F:
+	case TextureDeviceFormat::RGBA16F: return texels * 8;
+	case TextureDeviceFormat::R11F_G11F_B10F: return texels * 4;
+	case TextureDeviceFormat::R32F: return texels * 4;
+	case TextureDeviceFormat::RG32F: return texels * 8;
+	case TextureDeviceFormat::RGB32F:
+	case TextureDeviceFormat::RGBA32F: return texels * 16;
+	case TextureDeviceFormat::R32UI: return texels * 4;
+	case TextureDeviceFormat::RG32UI: return texels * 8;
+	case TextureDeviceFormat::BC1_RGBA:
+	case TextureDeviceFormat::BC1_SRGB8_ALPHA: return blocks * 8;
+	case TextureDeviceFormat::BC7_RGBA:
+	case TextureDeviceFormat::BC7_SRGB8_ALPHA: return blocks * 16;
+	case TextureDeviceFormat::DEPTH_COMPONENT16: return texels * 2;
+	// 24-bit depth is stored in 32 bits
+	case TextureDeviceFormat::DEPTH_COMPONENT24:
+	case TextureDeviceFormat::DEPTH_COMPONENT32F:
+	case TextureDeviceFormat::DEPTH24_STENCIL8: return texels * 4;
+	case TextureDeviceFormat::DEPTH32F_STENCIL8: return texels * 8;
+	case TextureDeviceFormat::STENCIL_INDEX8: return texels;
+	}
+	return texels * 4;
+}
+
 }
@@ -0,0 +1,212 @@
+#include <TextureLoader.hpp>
+#include <Application.hpp>
+#include <ImageKernels.hpp>
+#include <Ktx2.hpp>
+
+#include <stb/stb_image.h>
+
+#include <fstream>
+
+namespace libgl
+{
+
+static bool isDeviceFormatSupported(TextureDeviceFormat format)
+{
+	switch (format)
+	{
+	case TextureDeviceFormat::BC1_RGBA:
+		return GLEW_EXT_texture_compression_s3tc;
+	case TextureDeviceFormat::BC1_SRGB8_ALPHA:
+		return GLEW_EXT_texture_compression_s3tc && GLEW_EXT_texture_sRGB;
+	case TextureDeviceFormat::BC7_RGBA:
+	case TextureDeviceFormat::BC7_SRGB8_ALPHA:
+		return GLEW_VERSION_4_2 || GLEW_ARB_texture_compression_bptc;
+	default:
+		return true;
+	}
+}
+
+static TextureDeviceFormat getDeviceFormat(Ktx2Format format)
+{
+	switch (format)
+	{
+	case Ktx2Format::R8G8B8A8_UNORM: return TextureDeviceFormat::RGBA8;
+	case Ktx2Format::R8G8B8A8_SRGB: return TextureDeviceFormat::SRGB8_ALPHA8;
+	case Ktx2Format::BC1_RGBA_UNORM: return TextureDeviceFormat::BC1_RGBA;
+	case Ktx2Format::BC1_RGBA_SRGB: return TextureDeviceFormat::BC1_SRGB8_ALPHA;
+	case Ktx2Format::BC7_UNORM: return TextureDeviceFormat::BC7_RGBA;
+	case Ktx2Format::BC7_SRGB: return TextureDeviceFormat::BC7_SRGB8_ALPHA;
+	}
+	std::terminate();
+}
+
+static TextureImage decodeKtx2(const std::filesystem::path& path, const TextureLoadOptions& options)
+{
+	auto container = Ktx2Container::parse(Application::fetchContent(path));
+	const auto levelsCount = static_cast<GLint>(container.levelsCount());
+	const auto skip = std::clamp(options.skipLevels, 0, levelsCount - 1);
+
+	TextureImage result;
+	result.format = getDeviceFormat(container.format());
+	result.compressed = Ktx2Container::isCompressed(container.format());
+	result.width = (std::max)(1, static_cast<GLsizei>(container.width()) >> skip);
+	result.height = (std::max)(1, static_cast<GLsizei>(container.height()) >> skip);
+	result.skippedLevels = skip;
+	for (GLint level = skip; level < levelsCount; ++level)
+	{
+		result.levels.push_back(container.level(level));
+	}
+
+	return result;
+}
+
+static TextureImage decodeImage(const std::filesystem::path& path, const TextureLoadOptions& options)
+{
+	const auto rawData = Application::fetchContent(path);
+
+	int width;
+	int height;
+	int channels;
+	auto data = stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(rawData.data()), static_cast<int>(rawData.size()), &width, &height, &channels, 4);
+
+	if (data == nullptr)
+	{
+		throw std::system_error(std::make_error_code(std::errc::no_such_file_or_directory), path.string());
+	}
+
+	std::unique_ptr<stbi_uc, decltype(&stbi_image_free)> pixels(data, &stbi_image_free);
+
+	TextureImage result;
+	result.format = options.srgb ? TextureDeviceFormat::SRGB8_ALPHA8 : TextureDeviceFormat::RGBA8;
+	result.compressed = false;
+
+	GLint lastLevel = 0;
+	while (((std::max)(width, height) >> lastLevel) > 1)
+	{
+		++lastLevel;
+	}
+	const auto skip = std::clamp(options.skipLevels, 0, lastLevel);
+
+	auto levelWidth = static_cast<std::uint32_t>(width);
+	auto levelHeight = static_cast<std::uint32_t>(height);
+	if (skip == 0)
+	{
+		result.levels.emplace_back(pixels.get(), pixels.get() + std::size_t(width) * height * 4);
+	}
+
+	// every level is filtered from the float copy of the previous one, so 8-bit rounding never accumulates
+	std::vector<float> current(std::size_t(width) * height * 4);
+	std::vector<float> next;
+	unpackRGBA8(pixels.get(), current.data(), std::size_t(width) * height, options.srgb);
+	pixels.reset();
+
+	for (GLint level = 1; levelWidth > 1 || levelHeight > 1; ++level)
+	{
+		const auto nextWidth = (std::max)(1u, levelWidth / 2);
+		const auto nextHeight = (std::max)(1u, levelHeight / 2);
+		const auto pixelsCount = std::size_t(nextWidth) * nextHeight;
+
+		next.resize(pixelsCount * 4);
+		downsampleRGBA32F(current.data(), levelWidth, levelHeight, next.data());
+
+		std::swap(current, next);
+		levelWidth = nextWidth;
+		levelHeight = nextHeight;
+
+		if (level >= skip)
+		{
+			std::vector<std::uint8_t> packed(pixelsCount * 4);
+			packRGBA8(current.data(), packed.data(), pixelsCount, options.srgb);
+			result.levels.emplace_back(std::move(packed));
+		}
+	}
+
+	result.width = (std::max)(1, width >> skip);
+	result.height = (std::max)(1, height >> skip);
+	result.skippedLevels = skip;
+
+	return result;
+}
+
+TextureImage TextureLoader::decode(const std::filesystem::path& path, const TextureLoadOptions& options)
+{
+	if (path.extension() == ".ktx2")
+	{
+		return decodeKtx2(path, options);
+	}
+
+	return decodeImage(path, options);
+}
+
+std::future<TextureImage> TextureLoader::decodeAsync(std::filesystem::path path, TextureLoadOptions options)
+{
+	return std::async(std::launch::async, [path = std::move(path), options]()
+	{
+		return decode(path, options);
+	});
+}
+
+bool TextureLoader::isSupported(const std::filesystem::path& path)
+{
+	if (path.extension() != ".ktx2")
+	{
+		return true;
+	}
+
+	// vkFormat follows the 12-byte identifier
+	std::ifstream stream(path, std::ios_base::binary);
+	std::uint8_t header[16];
+	if (!stream.read(reinterpret_cast<char*>(header), sizeof(header)))
+	{
+		return false;
+	}
+
+	const auto vkFormat = std::uint32_t(header[12]) | std::uint32_t(header[13]) << 8 | std::uint32_t(header[14]) << 16 | std::uint32_t(header[15]) << 24;
+	switch (static_cast<Ktx2Format>(vkFormat))
+	{
+	case Ktx2Format::R8G8B8A8_UNORM:
+	case Ktx2Format::R8G8B8A8_SRGB:
+	case Ktx2Format::BC1_RGBA_UNORM:
+	case Ktx2Format::BC1_RGBA_SRGB:
+	case Ktx2Format::BC7_UNORM:
+	case Ktx2Format::BC7_SRGB:
+		return isDeviceFormatSupported(getDeviceFormat(static_cast<Ktx2Format>(vkFormat)));
+	}
+	return false;
+}
+
+std::shared_ptr<MutableTexture> TextureLoader::upload(const TextureImage& image)
+{
+	if (!isDeviceFormatSupported(image.format))
+	{
+		return {};
+	}
+
+	auto texture = std::make_shared<MutableTexture>(MutableTexture::make2D(image.width, image.height, image.format));
+
+	texture->bind(0);
+	for (std::size_t level = 0; level < image.levels.size(); ++level)
+	{
+		const auto& bytes = image.levels[level];
+		if (image.compressed)
+		{
+			texture->loadCompressed({ static_cast<GLsizei>(bytes.size()), bytes.data() }, static_cast<GLint>(level));
+		}
+		else
+		{
+			TextureData hostData;
+			hostData.format = TextureHostFormat::RGBA;
+			hostData.type = TextureHostType::UNSIGNED_BYTE;
+			hostData.data = bytes.data();
+			texture->load(hostData, static_cast<GLint>(level));
+		}
+	}
+
+	glTexParameteri(static_cast<GLenum>(texture->target()), GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(image.levels.size() - 1));
+	checkGl();
+
+	texture->setHasMipmaps(image.levels.size() > 1);
+	return texture;
+}
+
+}
@@ -0,0 +1,205 @@
+#include <TextureManager.hpp>
+
+#include <algorithm>
+#include <chrono>
+
+namespace libgl
+{
+
+static bool isCompressed(TextureDeviceFormat format)
+{
+	switch (format)
+	{
+	case TextureDeviceFormat::BC1_RGBA:
+	case TextureDeviceFormat::BC1_SRGB8_ALPHA:
+	case TextureDeviceFormat::BC7_RGBA:
+	case TextureDeviceFormat::BC7_SRGB8_ALPHA:
+		return true;
+	default:
+		return false;
+	}
+}
+
+TextureManager::TextureManager(std::size_t budgetBytes) :
+	m_budget(budgetBytes)
+{
+}
+
+TextureManager::TextureId TextureManager::add(std::filesystem::path path, TextureLoadOptions options)
+{
+	Entry entry;
+	entry.path = std::move(path);
+	entry.options = options;
+
+	m_entries.emplace_back(std::move(entry));
+	return m_entries.size() - 1;
+}
+
+std::shared_ptr<MutableTexture> TextureManager::acquire(TextureId id)
+{
+	auto& entry = m_entries.at(id);
+	entry.lastUsedFrame = m_frame;
+
+	if (!entry.pending.valid())
+	{
+		if (!entry.texture)
+		{
+			requestLoad(entry, 0);
+		}
+		else if (entry.droppedLevels > 0 && m_residentBytes + entry.bytes * 4 <= m_budget)
+		{
+			// one level at a time, the restored texture is ~4 times bigger and both copies live until the swap
+			requestLoad(entry, entry.droppedLevels - 1);
+		}
+	}
+
+	return entry.texture;
+}
+
+void TextureManager::update()
+{
+	for (auto& entry : m_entries)
+	{
+		if (!entry.pending.valid() || entry.pending.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+		{
+			continue;
+		}
+
+		const auto image = entry.pending.get();
+		auto texture = TextureLoader::upload(image);
+		if (!texture)
+		{
+			throw std::runtime_error(entry.path.string() + ": the texture format is not supported by the device");
+		}
+
+		// skippedLevels counts the levels options.skipLevels asked for as well, only the ones below them are restorable
+		setTexture(entry, std::move(texture), (std::max)(0, image.skippedLevels - entry.options.skipLevels));
+	}
+
+	enforceBudget();
+	++m_frame;
+}
+
+void TextureManager::requestLoad(Entry& entry, GLint skipLevels)
+{
+	auto options = entry.options;
+	options.skipLevels += skipLevels;
+	entry.pending = TextureLoader::decodeAsync(entry.path, options);
+}
+
+void TextureManager::setTexture(Entry& entry, std::shared_ptr<MutableTexture> texture, GLint droppedLevels)
+{
+	m_residentBytes -= entry.bytes;
+
+	entry.bytes = texture ? texture->memoryUsage() : 0;
+	entry.texture = std::move(texture);
+	entry.droppedLevels = droppedLevels;
+
+	m_residentBytes += entry.bytes;
+}
+
+bool TextureManager::dropTopLevel(Entry& entry)
+{
+	const auto& texture = *entry.texture;
+	if (!(GLEW_VERSION_4_3 || GLEW_ARB_copy_image) || texture.target() != TextureTarget::TEXTURE_2D || !texture.hasMipmaps())
+	{
+		return false;
+	}
+
+	const auto width = (std::max)(1, texture.width() / 2);
+	const auto height = (std::max)(1, texture.height() / 2);
+	if ((std::max)(width, height) < kMinResidentSize)
+	{
+		return false;
+	}
+
+	// loaded chains may stop before 1x1, GL_TEXTURE_MAX_LEVEL tells where
+	entry.texture->bind(kScratchUnit);
+	GLint maxLevel = 0;
+	glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, &maxLevel);
+	checkGl();
+
+	const auto levelsCount = (std::min)(texture.levelsCount(), maxLevel + 1);
+	if (levelsCount < 2)
+	{
+		return false;
+	}
+
+	const auto format = texture.deviceFormat();
+
+	auto trimmed = std::make_shared<MutableTexture>(MutableTexture::make2D(width, height, format));
+	trimmed->bind(kScratchUnit);
+
+	for (GLint level = 0; level + 1 < levelsCount; ++level)
+	{
+		const auto levelWidth = (std::max)(1, width >> level);
+		const auto levelHeight = (std::max)(1, height >> level);
+
+		if (isCompressed(format))
+		{
+			trimmed->loadCompressed({ static_cast<GLsizei>(TextureBase::levelBytes(format, levelWidth, levelHeight)), nullptr }, level);
+		}
+		else
+		{
+			TextureData storage;
+			storage.format = TextureHostFormat::RGBA;
+			storage.type = TextureHostType::UNSIGNED_BYTE;
+			storage.data = nullptr;
+			trimmed->load(storage, level);
+		}
+
+		glCopyImageSubData(
+			texture.nativeHandle(), GL_TEXTURE_2D, level + 1, 0, 0, 0,
+			trimmed->nativeHandle(), GL_TEXTURE_2D, level, 0, 0, 0,
+			levelWidth, levelHeight, 1);
+		checkGl();
+	}
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelsCount - 2);
+	checkGl();
+
+	trimmed->setHasMipmaps(levelsCount > 2);
+	// relative to options.skipLevels like the loads, so requestLoad(entry, droppedLevels - 1) restores this level
+	setTexture(entry, std::move(trimmed), entry.droppedLevels + 1);
+	return true;
+}
+
+void TextureManager::enforceBudget()
+{
+	if (m_residentBytes <= m_budget)
+	{
+		return;
+	}
+
+	// textures used in this frame are bound right now, trimming them would only cause reload ping-pong
+	std::vector<Entry*> candidates;
+	for (auto& entry : m_entries)
+	{
+		if (entry.texture && entry.lastUsedFrame < m_frame && !entry.pending.valid())
+		{
+			candidates.push_back(&entry);
+		}
+	}
+
+	std::sort(candidates.begin(), candidates.end(), [](const Entry* a, const Entry* b)
+	{
+		return a->lastUsedFrame < b->lastUsedFrame;
+	});
+
+	// lower resolution for everybody is preferable to missing textures
+	for (bool dropped = true; dropped && m_residentBytes > m_budget;)
+	{
+		dropped = false;
+		for (auto it = candidates.begin(); it != candidates.end() && m_residentBytes > m_budget; ++it)
+		{
+			dropped |= dropTopLevel(**it);
+		}
+	}
+
+	for (auto it = candidates.begin(); it != candidates.end() && m_residentBytes > m_budget; ++it)
+	{
+		setTexture(**it, nullptr, 0);
+	}
+}
+
+}
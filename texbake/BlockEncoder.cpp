@@ -0,0 +1,509 @@
+#include <BlockEncoder.hpp>
+
+#include <glm.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <thread>
+
+namespace texbake
+{
+
+// 16 texels of a 4x4 block, channels are in [0, 255] range
+using Block = std::array<glm::vec4, 16>;
+
+static constexpr int kPowerIterations = 8;
+static constexpr int kRefineIterations = 2;
+static constexpr float kBC1AlphaThreshold = 128.0f;
+
+// https://learn.microsoft.com/en-us/windows/win32/direct3d11/bc7-format-mode-reference
+static constexpr int kBC7Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+struct BC1Candidate
+{
+	std::uint16_t color0;
+	std::uint16_t color1;
+	std::uint32_t indices;
+	float error;
+};
+
+struct BC7Candidate
+{
+	glm::ivec4 endpoint0;
+	glm::ivec4 endpoint1;
+	int pbit0;
+	int pbit1;
+	std::array<int, 16> indices;
+	float error;
+};
+
+static Block fetchBlock(const ImageRGBA8& image, std::uint32_t blockX, std::uint32_t blockY)
+{
+	Block block;
+	for (std::uint32_t y = 0; y < 4; ++y)
+	{
+		const auto srcY = (std::min)(blockY * 4 + y, image.height - 1);
+		for (std::uint32_t x = 0; x < 4; ++x)
+		{
+			const auto srcX = (std::min)(blockX * 4 + x, image.width - 1);
+			const auto* texel = image.pixels.data() + (std::size_t(srcY) * image.width + srcX) * 4;
+			block[y * 4 + x] = glm::vec4(texel[0], texel[1], texel[2], texel[3]);
+		}
+	}
+	return block;
+}
+
+//
+// Dominant eigenvector of the points covariance matrix, zero vector for a constant set.
+//
+template <glm::length_t N>
+static glm::vec<N, float> principalAxis(const glm::vec<N, float>* points, std::size_t count, const glm::vec<N, float>& mean)
+{
+	float covariance[N][N] = {};
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		const auto delta = points[i] - mean;
+		for (glm::length_t r = 0; r < N; ++r)
+		{
+			for (glm::length_t c = 0; c < N; ++c)
+			{
+				covariance[r][c] += delta[r] * delta[c];
+			}
+		}
+	}
+
+	// start from the row with the largest variance, so the iteration never begins orthogonal to the answer
+	glm::length_t start = 0;
+	for (glm::length_t r = 1; r < N; ++r)
+	{
+		if (covariance[r][r] > covariance[start][start])
+		{
+			start = r;
+		}
+	}
+
+	glm::vec<N, float> axis;
+	for (glm::length_t c = 0; c < N; ++c)
+	{
+		axis[c] = covariance[start][c];
+	}
+
+	for (int iteration = 0; iteration < kPowerIterations; ++iteration)
+	{
+		const auto norm = glm::compMax(glm::abs(axis));
+		if (norm == 0.0f)
+		{
+			return glm::vec<N, float>(0.0f);
+		}
+		axis = axis / norm;
+
+		glm::vec<N, float> next(0.0f);
+		for (glm::length_t r = 0; r < N; ++r)
+		{
+			for (glm::length_t c = 0; c < N; ++c)
+			{
+				next[r] += covariance[r][c] * axis[c];
+			}
+		}
+		axis = next;
+	}
+
+	const auto length = glm::length(axis);
+	return length > 0.0f ? axis / length : glm::vec<N, float>(0.0f);
+}
+
+template <glm::length_t N>
+static std::pair<glm::vec<N, float>, glm::vec<N, float>> boundingEndpoints(const glm::vec<N, float>* points, std::size_t count)
+{
+	glm::vec<N, float> mean(0.0f);
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		mean += points[i];
+	}
+	mean /= static_cast<float>(count);
+
+	const auto axis = principalAxis(points, count, mean);
+
+	auto minProjection = (std::numeric_limits<float>::max)();
+	auto maxProjection = std::numeric_limits<float>::lowest();
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		const auto projection = glm::dot(points[i] - mean, axis);
+		minProjection = (std::min)(minProjection, projection);
+		maxProjection = (std::max)(maxProjection, projection);
+	}
+
+	return {
+		glm::clamp(mean + axis * minProjection, 0.0f, 255.0f),
+		glm::clamp(mean + axis * maxProjection, 0.0f, 255.0f)
+	};
+}
+
+//
+// Least squares endpoints for fixed interpolation weights, weights[i] is the share of the second endpoint.
+//
+template <glm::length_t N>
+static bool solveEndpoints(const glm::vec<N, float>* points, const float* weights, std::size_t count, glm::vec<N, float>& first, glm::vec<N, float>& second)
+{
+	float a00 = 0.0f;
+	float a01 = 0.0f;
+	float a11 = 0.0f;
+	glm::vec<N, float> b0(0.0f);
+	glm::vec<N, float> b1(0.0f);
+
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		const auto t = weights[i];
+		const auto s = 1.0f - t;
+		a00 += s * s;
+		a01 += s * t;
+		a11 += t * t;
+		b0 += points[i] * s;
+		b1 += points[i] * t;
+	}
+
+	const auto determinant = a00 * a11 - a01 * a01;
+	if (std::abs(determinant) < 1e-6f)
+	{
+		return false;
+	}
+
+	first = glm::clamp((b0 * a11 - b1 * a01) / determinant, 0.0f, 255.0f);
+	second = glm::clamp((b1 * a00 - b0 * a01) / determinant, 0.0f, 255.0f);
+	return true;
+}
+
+static std::uint16_t pack565(const glm::vec3& color)
+{
+	const auto r = static_cast<std::uint16_t>(std::lround(color.x * 31.0f / 255.0f));
+	const auto g = static_cast<std::uint16_t>(std::lround(color.y * 63.0f / 255.0f));
+	const auto b = static_cast<std::uint16_t>(std::lround(color.z * 31.0f / 255.0f));
+	return static_cast<std::uint16_t>(r << 11 | g << 5 | b);
+}
+
+static glm::vec3 unpack565(std::uint16_t color)
+{
+	const auto r = (color >> 11) & 31;
+	const auto g = (color >> 5) & 63;
+	const auto b = color & 31;
+	return glm::vec3(float(r << 3 | r >> 2), float(g << 2 | g >> 4), float(b << 3 | b >> 2));
+}
+
+static BC1Candidate evaluateBC1(std::uint16_t color0, std::uint16_t color1, const Block& block, bool punchThrough)
+{
+	// color0 > color1 selects the four colors mode, otherwise index 3 means transparent black
+	if (punchThrough ? color0 > color1 : color0 < color1)
+	{
+		std::swap(color0, color1);
+	}
+
+	const auto endpoint0 = unpack565(color0);
+	const auto endpoint1 = unpack565(color1);
+
+	glm::vec3 palette[4];
+	palette[0] = endpoint0;
+	palette[1] = endpoint1;
+	int paletteSize;
+	if (color0 > color1)
+	{
+		palette[2] = (endpoint0 * 2.0f + endpoint1) / 3.0f;
+		palette[3] = (endpoint0 + endpoint1 * 2.0f) / 3.0f;
+		paletteSize = 4;
+	}
+	else
+	{
+		palette[2] = (endpoint0 + endpoint1) * 0.5f;
+		paletteSize = 3;
+	}
+
+	BC1Candidate result{ color0, color1, 0, 0.0f };
+	for (std::uint32_t i = 0; i < 16; ++i)
+	{
+		if (punchThrough && block[i].w < kBC1AlphaThreshold)
+		{
+			result.indices |= 3u << (i * 2);
+			continue;
+		}
+
+		auto bestError = (std::numeric_limits<float>::max)();
+		std::uint32_t bestIndex = 0;
+		for (int k = 0; k < paletteSize; ++k)
+		{
+			const auto delta = palette[k] - block[i].xyz();
+			const auto error = glm::dot(delta, delta);
+			if (error < bestError)
+			{
+				bestError = error;
+				bestIndex = static_cast<std::uint32_t>(k);
+			}
+		}
+
+		result.indices |= bestIndex << (i * 2);
+		result.error += bestError;
+	}
+
+	return result;
+}
+
+static void encodeBC1Block(const Block& block, std::uint8_t* out)
+{
+	std::array<glm::vec3, 16> colors;
+	std::size_t opaqueCount = 0;
+	bool punchThrough = false;
+	for (const auto& texel : block)
+	{
+		if (texel.w < kBC1AlphaThreshold)
+		{
+			punchThrough = true;
+			continue;
+		}
+		colors[opaqueCount++] = texel.xyz();
+	}
+
+	BC1Candidate best{ 0, 0, 0xFFFFFFFFu, 0.0f };
+	if (opaqueCount != 0)
+	{
+		const auto [first, second] = boundingEndpoints(colors.data(), opaqueCount);
+		best = evaluateBC1(pack565(first), pack565(second), block, punchThrough);
+
+		for (int iteration = 0; iteration < kRefineIterations; ++iteration)
+		{
+			const bool fourColors = best.color0 > best.color1;
+
+			std::array<float, 16> weights;
+			std::size_t count = 0;
+			for (std::uint32_t i = 0; i < 16; ++i)
+			{
+				if (punchThrough && block[i].w < kBC1AlphaThreshold)
+				{
+					continue;
+				}
+
+				switch ((best.indices >> (i * 2)) & 3)
+				{
+				case 0: weights[count] = 0.0f; break;
+				case 1: weights[count] = 1.0f; break;
+				case 2: weights[count] = fourColors ? 1.0f / 3.0f : 0.5f; break;
+				default: weights[count] = 2.0f / 3.0f; break;
+				}
+				++count;
+			}
+
+			glm::vec3 refined0;
+			glm::vec3 refined1;
+			if (!solveEndpoints(colors.data(), weights.data(), count, refined0, refined1))
+			{
+				break;
+			}
+
+			const auto candidate = evaluateBC1(pack565(refined0), pack565(refined1), block, punchThrough);
+			if (candidate.error >= best.error)
+			{
+				break;
+			}
+			best = candidate;
+		}
+	}
+
+	out[0] = static_cast<std::uint8_t>(best.color0);
+	out[1] = static_cast<std::uint8_t>(best.color0 >> 8);
+	out[2] = static_cast<std::uint8_t>(best.color1);
+	out[3] = static_cast<std::uint8_t>(best.color1 >> 8);
+	for (int i = 0; i < 4; ++i)
+	{
+		out[4 + i] = static_cast<std::uint8_t>(best.indices >> (i * 8));
+	}
+}
+
+static glm::ivec4 quantizeBC7(const glm::vec4& endpoint, int pbit)
+{
+	glm::ivec4 result;
+	for (int c = 0; c < 4; ++c)
+	{
+		result[c] = std::clamp(static_cast<int>(std::lround((endpoint[c] - pbit) * 0.5f)), 0, 127);
+	}
+	return result;
+}
+
+static glm::ivec4 expandBC7(const glm::ivec4& endpoint, int pbit)
+{
+	return endpoint * 2 + glm::ivec4(pbit);
+}
+
+static BC7Candidate evaluateBC7(const glm::ivec4& endpoint0, int pbit0, const glm::ivec4& endpoint1, int pbit1, const Block& block)
+{
+	const auto color0 = expandBC7(endpoint0, pbit0);
+	const auto color1 = expandBC7(endpoint1, pbit1);
+
+	glm::vec4 palette[16];
+	for (int k = 0; k < 16; ++k)
+	{
+		palette[k] = glm::vec4((color0 * (64 - kBC7Weights[k]) + color1 * kBC7Weights[k] + glm::ivec4(32)) / 64);
+	}
+
+	BC7Candidate result{ endpoint0, endpoint1, pbit0, pbit1, {}, 0.0f };
+	for (std::size_t i = 0; i < 16; ++i)
+	{
+		auto bestError = (std::numeric_limits<float>::max)();
+		for (int k = 0; k < 16; ++k)
+		{
+			const auto delta = palette[k] - block[i];
+			const auto error = glm::dot(delta, delta);
+			if (error < bestError)
+			{
+				bestError = error;
+				result.indices[i] = k;
+			}
+		}
+		result.error += bestError;
+	}
+
+	return result;
+}
+
+static BC7Candidate fitBC7(const glm::vec4& endpoint0, const glm::vec4& endpoint1, const Block& block)
+{
+	BC7Candidate best{};
+	best.error = (std::numeric_limits<float>::max)();
+
+	for (int pbit0 = 0; pbit0 < 2; ++pbit0)
+	{
+		for (int pbit1 = 0; pbit1 < 2; ++pbit1)
+		{
+			auto candidate = evaluateBC7(quantizeBC7(endpoint0, pbit0), pbit0, quantizeBC7(endpoint1, pbit1), pbit1, block);
+			if (candidate.error < best.error)
+			{
+				best = candidate;
+			}
+		}
+	}
+
+	return best;
+}
+
+class BitWriter
+{
+public:
+	explicit BitWriter(std::uint8_t* out) : m_out(out) {}
+
+	void write(std::uint32_t value, int bits)
+	{
+		for (int i = 0; i < bits; ++i, ++m_position)
+		{
+			if ((value >> i) & 1)
+			{
+				m_out[m_position / 8] |= static_cast<std::uint8_t>(1u << (m_position % 8));
+			}
+		}
+	}
+private:
+	std::uint8_t* m_out;
+	int m_position{ 0 };
+};
+
+static void encodeBC7Block(const Block& block, std::uint8_t* out)
+{
+	const auto [first, second] = boundingEndpoints(block.data(), block.size());
+	auto best = fitBC7(first, second, block);
+
+	for (int iteration = 0; iteration < kRefineIterations; ++iteration)
+	{
+		std::array<float, 16> weights;
+		for (std::size_t i = 0; i < 16; ++i)
+		{
+			weights[i] = kBC7Weights[best.indices[i]] / 64.0f;
+		}
+
+		glm::vec4 refined0;
+		glm::vec4 refined1;
+		if (!solveEndpoints(block.data(), weights.data(), block.size(), refined0, refined1))
+		{
+			break;
+		}
+
+		const auto candidate = fitBC7(refined0, refined1, block);
+		if (candidate.error >= best.error)
+		{
+			break;
+		}
+		best = candidate;
+	}
+
+	// the most significant bit of the anchor index is implicit zero
+	if (best.indices[0] & 8)
+	{
+		std::swap(best.endpoint0, best.endpoint1);
+		std::swap(best.pbit0, best.pbit1);
+		for (auto& index : best.indices)
+		{
+			index = 15 - index;
+		}
+	}
+
+	std::fill(out, out + 16, std::uint8_t{ 0 });
+	BitWriter writer(out);
+	writer.write(1u << 6, 7); // mode 6
+	for (int c = 0; c < 4; ++c)
+	{
+		writer.write(static_cast<std::uint32_t>(best.endpoint0[c]), 7);
+		writer.write(static_cast<std::uint32_t>(best.endpoint1[c]), 7);
+	}
+	writer.write(static_cast<std::uint32_t>(best.pbit0), 1);
+	writer.write(static_cast<std::uint32_t>(best.pbit1), 1);
+
+	writer.write(static_cast<std::uint32_t>(best.indices[0]), 3);
+	for (std::size_t i = 1; i < 16; ++i)
+	{
+		writer.write(static_cast<std::uint32_t>(best.indices[i]), 4);
+	}
+}
+
+std::vector<std::uint8_t> encodeBlocks(const ImageRGBA8& image, BlockFormat format, unsigned threadsCount)
+{
+	const auto blocksX = (image.width + 3) / 4;
+	const auto blocksY = (image.height + 3) / 4;
+	const std::size_t blockBytes = format == BlockFormat::BC1 ? 8 : 16;
+
+	std::vector<std::uint8_t> result(std::size_t(blocksX) * blocksY * blockBytes);
+	std::atomic<std::uint32_t> nextRow{ 0 };
+
+	auto worker = [&]()
+	{
+		for (auto row = nextRow++; row < blocksY; row = nextRow++)
+		{
+			for (std::uint32_t column = 0; column < blocksX; ++column)
+			{
+				const auto block = fetchBlock(image, column, row);
+				auto* out = result.data() + (std::size_t(row) * blocksX + column) * blockBytes;
+
+				if (format == BlockFormat::BC1)
+				{
+					encodeBC1Block(block, out);
+				}
+				else
+				{
+					encodeBC7Block(block, out);
+				}
+			}
+		}
+	};
+
+	std::vector<std::thread> workers;
+	for (unsigned i = 1; i < threadsCount; ++i)
+	{
+		workers.emplace_back(worker);
+	}
+	worker();
+
+	for (auto& thread : workers)
+	{
+		thread.join();
+	}
+
+	return result;
+}
+
+}
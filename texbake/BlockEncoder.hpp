@@ -0,0 +1,20 @@
+#pragma once
+
+#include <MipChain.hpp>
+
+namespace texbake
+{
+
+enum class BlockFormat
+{
+	BC1, // RGB + 1 bit alpha, 8 bytes per 4x4 block
+	BC7, // RGBA, 16 bytes per 4x4 block, mode 6 only
+};
+
+//
+// Encodes the image block by block, rows of blocks are distributed between threadsCount workers.
+// Images with dimensions not divisible by 4 are padded by repeating the edge texels.
+//
+std::vector<std::uint8_t> encodeBlocks(const ImageRGBA8& image, BlockFormat format, unsigned threadsCount);
+
+}
@@ -0,0 +1,198 @@
+#include <MipChain.hpp>
+
+#include <ImageKernels.hpp>
+#include <glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace texbake
+{
+
+struct ImageLinear
+{
+	std::uint32_t width;
+	std::uint32_t height;
+	std::vector<glm::vec4> pixels;
+};
+
+struct FilterTap
+{
+	std::uint32_t index;
+	float weight;
+};
+
+static constexpr float kKaiserRadius = 3.0f;
+static constexpr float kKaiserAlpha = 4.0f;
+
+static ImageLinear toLinear(const ImageRGBA8& image, bool srgb)
+{
+	const auto pixelsCount = std::size_t(image.width) * image.height;
+
+	ImageLinear result{ image.width, image.height, std::vector<glm::vec4>(pixelsCount) };
+	libgl::unpackRGBA8(image.pixels.data(), glm::value_ptr(result.pixels[0]), pixelsCount, srgb);
+	libgl::premultiplyAlphaRGBA32F(glm::value_ptr(result.pixels[0]), pixelsCount);
+
+	return result;
+}
+
+static ImageRGBA8 toRGBA8(ImageLinear image, bool srgb)
+{
+	for (auto& pixel : image.pixels)
+	{
+		const auto alpha = std::clamp(pixel.w, 0.0f, 1.0f);
+		pixel = alpha > 0.0f ? glm::vec4(pixel.xyz() / alpha, alpha) : glm::vec4(0.0f);
+	}
+
+	ImageRGBA8 result{ image.width, image.height, std::vector<std::uint8_t>(image.pixels.size() * 4) };
+	libgl::packRGBA8(glm::value_ptr(image.pixels[0]), result.pixels.data(), image.pixels.size(), srgb);
+
+	return result;
+}
+
+static ImageLinear downsampleBox(const ImageLinear& src)
+{
+	const auto width = (std::max)(1u, src.width / 2);
+	const auto height = (std::max)(1u, src.height / 2);
+
+	ImageLinear dst{ width, height, std::vector<glm::vec4>(std::size_t(width) * height) };
+	libgl::downsampleRGBA32F(glm::value_ptr(src.pixels[0]), src.width, src.height, glm::value_ptr(dst.pixels[0]));
+
+	return dst;
+}
+
+static double besselI0(double x)
+{
+	double sum = 1.0;
+	double term = 1.0;
+	for (int k = 1; term > sum * 1e-12; ++k)
+	{
+		const auto half = x / (2.0 * k);
+		term *= half * half;
+		sum += term;
+	}
+	return sum;
+}
+
+static float kaiser(float x)
+{
+	// x is measured in destination texels
+	if (std::abs(x) >= kKaiserRadius)
+	{
+		return 0.0f;
+	}
+
+	const auto t = x / kKaiserRadius;
+	const auto window = besselI0(kKaiserAlpha * std::sqrt(1.0 - t * t)) / besselI0(kKaiserAlpha);
+	const auto sinc = x == 0.0f ? 1.0 : std::sin(glm::pi<double>() * x) / (glm::pi<double>() * x);
+	return static_cast<float>(sinc * window);
+}
+
+static std::vector<std::vector<FilterTap>> makeKaiserTaps(std::uint32_t srcSize, std::uint32_t dstSize)
+{
+	const auto scale = float(srcSize) / float(dstSize);
+
+	std::vector<std::vector<FilterTap>> result(dstSize);
+	for (std::uint32_t i = 0; i < dstSize; ++i)
+	{
+		const auto center = (i + 0.5f) * scale;
+		const auto first = static_cast<std::int64_t>(std::floor(center - kKaiserRadius * scale));
+		const auto last = static_cast<std::int64_t>(std::ceil(center + kKaiserRadius * scale));
+
+		auto& taps = result[i];
+		float sum = 0.0f;
+		for (auto j = first; j <= last; ++j)
+		{
+			const auto weight = kaiser((j + 0.5f - center) / scale);
+			if (weight == 0.0f)
+			{
+				continue;
+			}
+
+			const auto clamped = static_cast<std::uint32_t>(std::clamp<std::int64_t>(j, 0, srcSize - 1));
+			if (!taps.empty() && taps.back().index == clamped)
+			{
+				taps.back().weight += weight;
+			}
+			else
+			{
+				taps.push_back({ clamped, weight });
+			}
+			sum += weight;
+		}
+
+		for (auto& tap : taps)
+		{
+			tap.weight /= sum;
+		}
+	}
+
+	return result;
+}
+
+static ImageLinear transpose(const ImageLinear& src)
+{
+	ImageLinear dst{ src.height, src.width, std::vector<glm::vec4>(src.pixels.size()) };
+	for (std::uint32_t y = 0; y < src.height; ++y)
+	{
+		for (std::uint32_t x = 0; x < src.width; ++x)
+		{
+			dst.pixels[std::size_t(x) * src.height + y] = src.pixels[std::size_t(y) * src.width + x];
+		}
+	}
+	return dst;
+}
+
+static ImageLinear resampleColumns(const ImageLinear& src, std::uint32_t height)
+{
+	// every tap weighs a whole source row, so the SIMD kernel runs along contiguous memory
+	const auto taps = makeKaiserTaps(src.height, height);
+	const auto* srcPixels = glm::value_ptr(src.pixels[0]);
+
+	ImageLinear dst{ src.width, height, std::vector<glm::vec4>(std::size_t(src.width) * height, glm::vec4(0.0f)) };
+	for (std::uint32_t y = 0; y < height; ++y)
+	{
+		auto* dstRow = glm::value_ptr(dst.pixels[std::size_t(y) * src.width]);
+		for (const auto& tap : taps[y])
+		{
+			libgl::accumulateRGBA32F(srcPixels + std::size_t(tap.index) * src.width * 4, tap.weight, dstRow, src.width);
+		}
+	}
+
+	return dst;
+}
+
+static ImageLinear downsampleKaiser(const ImageLinear& src)
+{
+	const auto width = (std::max)(1u, src.width / 2);
+	const auto height = (std::max)(1u, src.height / 2);
+
+	// the horizontal pass runs on the transposed image, the same row kernel serves both passes
+	auto dst = transpose(resampleColumns(transpose(resampleColumns(src, height)), width));
+	for (auto& pixel : dst.pixels)
+	{
+		// negative lobes may overshoot, keep premultiplied values consistent
+		pixel.w = std::clamp(pixel.w, 0.0f, 1.0f);
+		pixel = glm::clamp(pixel, glm::vec4(0.0f), glm::vec4(pixel.w));
+	}
+
+	return dst;
+}
+
+std::vector<ImageRGBA8> buildMipChain(ImageRGBA8 image, bool srgb, MipFilter filter)
+{
+	auto linear = toLinear(image, srgb);
+
+	std::vector<ImageRGBA8> result;
+	result.emplace_back(std::move(image));
+
+	while (linear.width > 1 || linear.height > 1)
+	{
+		linear = filter == MipFilter::KAISER ? downsampleKaiser(linear) : downsampleBox(linear);
+		result.emplace_back(toRGBA8(linear, srgb));
+	}
+
+	return result;
+}
+
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace texbake
+{
+
+struct ImageRGBA8
+{
+	std::uint32_t width;
+	std::uint32_t height;
+	std::vector<std::uint8_t> pixels;
+};
+
+enum class MipFilter
+{
+	BOX,
+	KAISER,
+};
+
+//
+// Builds the full mip chain down to 1x1, result[0] is the source image.
+// Filtering happens on premultiplied linear values, so sRGB images do not darken
+// and transparent texels do not bleed their color into the neighbours.
+//
+std::vector<ImageRGBA8> buildMipChain(ImageRGBA8 image, bool srgb, MipFilter filter);
+
+}
@@ -0,0 +1,168 @@
+#include <BlockEncoder.hpp>
+#include <Ktx2.hpp>
+#include <MipChain.hpp>
+
+#include <stb/stb_image.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string_view>
+#include <thread>
+
+struct Options
+{
+	libgl::Ktx2Format format{ libgl::Ktx2Format::BC7_SRGB };
+	texbake::MipFilter filter{ texbake::MipFilter::BOX };
+	bool srgb{ true };
+	bool mipmaps{ true };
+	unsigned threadsCount{ (std::max)(1u, std::thread::hardware_concurrency()) };
+	std::filesystem::path outputDir;
+	std::vector<std::filesystem::path> inputs;
+};
+
+static void printUsage()
+{
+	std::cout
+		<< "usage: texbake [options] <input.png>...\n"
+		<< "  --bc7          BC7 (mode 6) blocks, default\n"
+		<< "  --bc1          BC1 blocks with 1 bit alpha\n"
+		<< "  --rgba8        uncompressed RGBA8\n"
+		<< "  --linear       treat color channels as linear data instead of sRGB\n"
+		<< "  --box          2x2 box mip filter, default\n"
+		<< "  --kaiser       Kaiser windowed sinc mip filter\n"
+		<< "  --no-mips      store the base level only\n"
+		<< "  --threads <n>  encoder threads, defaults to the hardware concurrency\n"
+		<< "  -o <dir>       output directory, defaults to the input file directory\n";
+}
+
+static Options parseOptions(int argc, char** argv)
+{
+	Options options;
+	bool compressed = true;
+	bool bc1 = false;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string_view arg(argv[i]);
+		if (arg == "--bc7") { compressed = true; bc1 = false; }
+		else if (arg == "--bc1") { compressed = true; bc1 = true; }
+		else if (arg == "--rgba8") { compressed = false; }
+		else if (arg == "--linear") { options.srgb = false; }
+		else if (arg == "--box") { options.filter = texbake::MipFilter::BOX; }
+		else if (arg == "--kaiser") { options.filter = texbake::MipFilter::KAISER; }
+		else if (arg == "--no-mips") { options.mipmaps = false; }
+		else if (arg == "--threads" && i + 1 < argc) { options.threadsCount = (std::max)(1, std::stoi(argv[++i])); }
+		else if (arg == "-o" && i + 1 < argc) { options.outputDir = argv[++i]; }
+		else if (!arg.empty() && arg[0] == '-') { throw std::invalid_argument("unknown option " + std::string(arg)); }
+		else { options.inputs.emplace_back(arg); }
+	}
+
+	if (!compressed)
+	{
+		options.format = options.srgb ? libgl::Ktx2Format::R8G8B8A8_SRGB : libgl::Ktx2Format::R8G8B8A8_UNORM;
+	}
+	else if (bc1)
+	{
+		options.format = options.srgb ? libgl::Ktx2Format::BC1_RGBA_SRGB : libgl::Ktx2Format::BC1_RGBA_UNORM;
+	}
+	else
+	{
+		options.format = options.srgb ? libgl::Ktx2Format::BC7_SRGB : libgl::Ktx2Format::BC7_UNORM;
+	}
+
+	return options;
+}
+
+static texbake::ImageRGBA8 loadPng(const std::filesystem::path& path)
+{
+	int width;
+	int height;
+	int channels;
+	auto data = stbi_load(path.string().c_str(), &width, &height, &channels, 4);
+	if (data == nullptr)
+	{
+		throw std::system_error(std::make_error_code(std::errc::no_such_file_or_directory), path.string());
+	}
+
+	texbake::ImageRGBA8 image{ static_cast<std::uint32_t>(width), static_cast<std::uint32_t>(height), {} };
+	image.pixels.assign(data, data + std::size_t(width) * height * 4);
+	stbi_image_free(data);
+
+	return image;
+}
+
+static void bake(const std::filesystem::path& input, const Options& options)
+{
+	const auto startTime = std::chrono::high_resolution_clock::now();
+
+	auto image = loadPng(input);
+	libgl::Ktx2Container container(options.format, image.width, image.height);
+
+	auto levels = options.mipmaps
+		? texbake::buildMipChain(std::move(image), options.srgb, options.filter)
+		: std::vector<texbake::ImageRGBA8>{ std::move(image) };
+
+	for (auto& level : levels)
+	{
+		switch (options.format)
+		{
+		case libgl::Ktx2Format::BC1_RGBA_UNORM:
+		case libgl::Ktx2Format::BC1_RGBA_SRGB:
+			container.addLevel(texbake::encodeBlocks(level, texbake::BlockFormat::BC1, options.threadsCount));
+			break;
+		case libgl::Ktx2Format::BC7_UNORM:
+		case libgl::Ktx2Format::BC7_SRGB:
+			container.addLevel(texbake::encodeBlocks(level, texbake::BlockFormat::BC7, options.threadsCount));
+			break;
+		default:
+			container.addLevel(std::move(level.pixels));
+		}
+	}
+
+	const auto outputDir = options.outputDir.empty() ? input.parent_path() : options.outputDir;
+	if (!outputDir.empty())
+	{
+		std::filesystem::create_directories(outputDir);
+	}
+
+	const auto outputPath = outputDir / input.filename().replace_extension(".ktx2");
+	const auto bytes = container.serialize();
+
+	std::ofstream stream(outputPath, std::ios_base::binary);
+	if (stream.fail())
+	{
+		throw std::system_error(std::make_error_code(std::errc::permission_denied), outputPath.string());
+	}
+	stream.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+
+	const auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - startTime).count();
+	std::cout << input.string() << " -> " << outputPath.string()
+		<< " (" << container.levelsCount() << " levels, " << bytes.size() << " bytes, " << elapsedMs << " ms)\n";
+}
+
+int main(int argc, char** argv)
+{
+	try
+	{
+		const auto options = parseOptions(argc, argv);
+		if (options.inputs.empty())
+		{
+			printUsage();
+			return 1;
+		}
+
+		for (const auto& input : options.inputs)
+		{
+			bake(input, options);
+		}
+	}
+	catch (const std::exception& ex)
+	{
+		std::cout << ex.what() << '\n';
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+// texbake's own directory comes first on the include path, so libgl's pch.hpp can't be pulled in by name,
+// the standard library and glm headers the tool uses are listed instead
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <glm.hpp>